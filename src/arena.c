@@ -0,0 +1,104 @@
+/**
+ * Arena Allocator Module
+ * File: arena.c
+ * Author: Liam M. Murphy
+ */
+
+#include "arena.h"
+
+#include "error.h"
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+arena_t *arena_new(void) {
+    arena_t *retval = (arena_t *)calloc(1, sizeof(arena_t));
+
+    if (retval == NULL) {
+        log_error("Unable to allocate new arena");
+    }
+
+    return retval;
+}
+
+void arena_free(arena_t *arena) {
+    if (arena != NULL) {
+        // The list of mappings lives in the blocks, so it goes first
+        for (arena_mapping_t *mapping = arena->mappings; mapping != NULL; mapping = mapping->next) {
+            munmap(mapping->addr, mapping->length);
+        }
+
+        arena_block_t *block = arena->blocks;
+
+        while (block != NULL) {
+            arena_block_t *next = block->next;
+
+            free(block);
+            block = next;
+        }
+
+        free(arena);
+    }
+}
+
+// Adds a block with room for at least size bytes to the front of the arena
+static arena_block_t *arena_grow(arena_t *arena, size_t size) {
+    const size_t block_size = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+
+    // calloc() hands back zeroed memory, often straight from fresh pages, so nothing handed out
+    // from the block needs clearing
+    arena_block_t *block = (arena_block_t *)calloc(1, sizeof(arena_block_t) + block_size);
+    if (block == NULL) {
+        log_error("Unable to grow arena by %zu bytes", block_size);
+    }
+
+    block->size = block_size;
+    block->used = 0;
+
+    // Requests too large for a standard block go behind the current one, so that the rest of the
+    // current block is not wasted
+    if (size > ARENA_BLOCK_SIZE && arena->blocks != NULL) {
+        block->next         = arena->blocks->next;
+        arena->blocks->next = block;
+    } else {
+        block->next   = arena->blocks;
+        arena->blocks = block;
+    }
+
+    arena->reserved += block_size;
+    arena->num_blocks++;
+
+    return block;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    if (arena == NULL) {
+        log_error("Cannot allocate from NULL arena");
+    }
+
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    arena_block_t *block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+        block = arena_grow(arena, size);
+    }
+
+    void *retval = (char *)block->data + block->used;
+    block->used += size;
+
+    arena->allocated += size;
+    arena->count++;
+
+    return retval;
+}
+
+void arena_adopt_mapping(arena_t *arena, void *addr, size_t length) {
+    arena_mapping_t *mapping = (arena_mapping_t *)arena_alloc(arena, sizeof(arena_mapping_t));
+
+    mapping->addr   = addr;
+    mapping->length = length;
+    mapping->next   = arena->mappings;
+    arena->mappings = mapping;
+}
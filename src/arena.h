@@ -0,0 +1,58 @@
+/**
+ * Arena Allocator Public Definitions
+ * File: arena.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Size of each block the arena takes from the heap. Larger requests get a block of their own.
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct arena_block_s {
+    struct arena_block_s *next;
+    size_t size; // Bytes of data in the block
+    size_t used;
+    max_align_t data[];
+} arena_block_t;
+
+// A file mapped into memory on behalf of an arena
+typedef struct arena_mapping_s {
+    struct arena_mapping_s *next;
+    void *addr;
+    size_t length;
+} arena_mapping_t;
+
+/* Arena
+ *
+ *  Owns everything allocated during the compilation of one program: the AST's nodes and the
+ *  vectors that hold them. Allocating is a pointer bump within the current block, and nothing is
+ *  freed on its own. arena_free() releases the lot, a block at a time.
+ *
+ *  An arena may also own mappings, such as an AST loaded from the cache (astcache.h), which are
+ *  unmapped along with its blocks. */
+typedef struct arena_s {
+    arena_block_t *blocks;     // Most recent first
+    arena_mapping_t *mappings; // Unmapped when the arena is freed
+    size_t allocated;          // Bytes handed out
+    size_t reserved;           // Bytes taken from the heap
+    unsigned int count;        // Number of allocations
+    unsigned int num_blocks;
+} arena_t;
+
+// Allocate a new, empty arena
+arena_t *arena_new(void);
+
+// Free an arena and everything allocated from it
+void arena_free(arena_t *arena);
+
+// Allocate size bytes of zeroed memory from an arena, aligned for any type
+void *arena_alloc(arena_t *arena, size_t size);
+
+// Hands the mapping of length bytes at addr over to arena, which unmaps it when it is freed
+void arena_adopt_mapping(arena_t *arena, void *addr, size_t length);
+
+#endif // ARENA_H
@@ -114,7 +114,7 @@ char *binop_to_str(token_type t) {
 
 static void print_indent(int indent) {
     for (int i = 0; i < indent; i++) {
-        printf(" ");
+        diag_printf(" ");
     }
 }
 
@@ -126,420 +126,406 @@ void print_node(node *n, int indent) {
     print_indent(indent);
     switch (n->type) {
         case N_PROGRAM:
-            printf("Program (\n");
+            diag_printf("Program (\n");
             break;
         case N_BLOCK_STMT:
-            printf("BlockStmt (\n");
+            diag_printf("BlockStmt (\n");
 
             indent += INDENT_WIDTH;
-            vecnode *bn = n->data.block_stmt.statements->head;
-            while (bn != NULL) {
-                node *n = bn->data;
-                print_node(n, indent);
-
-                bn = bn->next;
+            for (int idx = 0; idx < vector_length(n->data.block_stmt.statements); idx++) {
+                print_node(vector_get(n->data.block_stmt.statements, idx), indent);
             }
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_VAR_DECL:
-            printf("VarDecl (\n");
+            diag_printf("VarDecl (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.var_decl.name);
+            diag_printf("Name: %s\n", n->data.var_decl.name);
             print_indent(indent + INDENT_WIDTH);
-            printf("IsStruct: %s\n", (n->data.var_decl.is_struct ? "true" : "false"));
+            diag_printf("IsStruct: %s\n", (n->data.var_decl.is_struct ? "true" : "false"));
             print_indent(indent + INDENT_WIDTH);
-            printf("IsArray: %s\n", (n->data.var_decl.is_array ? "true" : "false"));
+            diag_printf("IsArray: %s\n", (n->data.var_decl.is_array ? "true" : "false"));
             print_indent(indent + INDENT_WIDTH);
-            printf("Dimensions: %d\n", n->data.var_decl.num_dimensions);
+            diag_printf("Dimensions: %d\n", n->data.var_decl.num_dimensions);
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.var_decl.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.var_decl.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("StructType: %s\n", n->data.var_decl.struct_type);
+            diag_printf("StructType: %s\n", n->data.var_decl.struct_type);
             print_indent(indent + INDENT_WIDTH);
-            printf("Value: ");
+            diag_printf("Value: ");
 
             indent += INDENT_WIDTH;
             node *v = n->data.var_decl.value;
             if (v != NULL) {
-                printf("\n");
+                diag_printf("\n");
                 print_node(v, indent + INDENT_WIDTH);
             } else {
-                printf("None\n");
+                diag_printf("None\n");
             }
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_LABEL_DECL:
-            printf("LabelDecl (\n");
+            diag_printf("LabelDecl (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.label_decl.name);
+            diag_printf("Name: %s\n", n->data.label_decl.name);
             print_indent(indent);
-            printf("), \n");
+            diag_printf("), \n");
             break;
         case N_GOTO_STMT:
-            printf("GotoStmt (\n");
+            diag_printf("GotoStmt (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Label: %s\n", n->data.goto_stmt.label);
+            diag_printf("Label: %s\n", n->data.goto_stmt.label);
             print_indent(indent);
-            printf("), \n");
+            diag_printf("), \n");
             break;
         case N_FUNC_DECL:
-            printf("FuncDecl (\n");
+            diag_printf("FuncDecl (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.function_decl.name);
+            diag_printf("Name: %s\n", n->data.function_decl.name);
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.function_decl.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.function_decl.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("StructType: %s\n", n->data.function_decl.struct_type);
+            diag_printf("StructType: %s\n", n->data.function_decl.struct_type);
             print_indent(indent + INDENT_WIDTH);
-            printf("IsStruct: %s\n", (n->data.function_decl.is_struct ? "true" : "false"));
+            diag_printf("IsStruct: %s\n", (n->data.function_decl.is_struct ? "true" : "false"));
             print_indent(indent + INDENT_WIDTH);
-            printf("IsArray: %s\n", (n->data.function_decl.is_array ? "true" : "false"));
+            diag_printf("IsArray: %s\n", (n->data.function_decl.is_array ? "true" : "false"));
             print_indent(indent + INDENT_WIDTH);
-            printf("Dimensions: %d\n", n->data.function_decl.num_dimensions);
+            diag_printf("Dimensions: %d\n", n->data.function_decl.num_dimensions);
             print_indent(indent + INDENT_WIDTH);
-            printf("Formals ( ");
+            diag_printf("Formals ( ");
             indent += INDENT_WIDTH;
             if (n->data.function_decl.formals == NULL) {
-                printf("None )\n");
+                diag_printf("None )\n");
             } else {
-                printf("\n");
-                vecnode *fn = n->data.function_decl.formals->head;
+                diag_printf("\n");
+                vector *formals = n->data.function_decl.formals;
 
-                while (fn != NULL) {
-                    node *n = fn->data;
-                    print_node(n, indent + INDENT_WIDTH);
-                    fn = fn->next;
+                for (int idx = 0; idx < vector_length(formals); idx++) {
+                    print_node(vector_get(formals, idx), indent + INDENT_WIDTH);
                 }
 
                 print_indent(indent);
-                printf(")\n");
+                diag_printf(")\n");
             }
             // Print FuncDecl body
             print_indent(indent);
-            printf("Body:\n");
+            diag_printf("Body:\n");
 
             print_node(n->data.function_decl.body, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_RETURN_STMT:
-            printf("ReturnStmt (\n");
+            diag_printf("ReturnStmt (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Expression: \n");
+            diag_printf("Expression: \n");
             indent += INDENT_WIDTH;
             if (n->data.return_stmt.expr == NULL) {
                 print_indent(indent);
-                printf("None\n");
+                diag_printf("None\n");
             } else {
                 print_node(n->data.return_stmt.expr, indent + INDENT_WIDTH);
             }
             indent -= INDENT_WIDTH;
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_CALL_EXPR:
-            printf("CallExpr (\n");
+            diag_printf("CallExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Function name: %s\n", n->data.call_expr.func_name);
+            diag_printf("Function name: %s\n", n->data.call_expr.func_name);
             print_indent(indent + INDENT_WIDTH);
-            printf("Args: ");
+            diag_printf("Args: ");
             if (n->data.call_expr.args == NULL) {
-                printf("None\n");
+                diag_printf("None\n");
             } else {
                 indent += INDENT_WIDTH;
-                printf("\n");
-                vecnode *an = n->data.call_expr.args->head;
-
-                while (an != NULL) {
-                    node *n = an->data;
-                    print_node(n, indent + INDENT_WIDTH);
-                    an = an->next;
+                diag_printf("\n");
+                for (int idx = 0; idx < vector_length(n->data.call_expr.args); idx++) {
+                    print_node(vector_get(n->data.call_expr.args, idx), indent + INDENT_WIDTH);
                 }
                 indent -= INDENT_WIDTH;
             }
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_STRUCT_DECL:
-            printf("StructDecl (\n");
+            diag_printf("StructDecl (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.struct_decl.name);
+            diag_printf("Name: %s\n", n->data.struct_decl.name);
             print_indent(indent + INDENT_WIDTH);
-            printf("Members: ");
+            diag_printf("Members: ");
 
             indent += INDENT_WIDTH;
-            vecnode *m = n->data.struct_decl.members->head;
-            if (m != NULL) {
-                printf("\n");
-                while (m != NULL) {
-                    print_node(m->data, indent + INDENT_WIDTH);
-                    m = m->next;
+            if (vector_length(n->data.struct_decl.members) > 0) {
+                diag_printf("\n");
+                for (int idx = 0; idx < vector_length(n->data.struct_decl.members); idx++) {
+                    print_node(vector_get(n->data.struct_decl.members, idx), indent + INDENT_WIDTH);
                 }
             } else {
-                printf("None\n");
+                diag_printf("None\n");
             }
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_STRUCT_ACCESS_EXPR:
-            printf("StructAccessExpr (\n");
+            diag_printf("StructAccessExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.struct_access.name);
+            diag_printf("Name: %s\n", n->data.struct_access.name);
             print_indent(indent + INDENT_WIDTH);
-            printf("Member Name: %s\n", n->data.struct_access.member_name);
+            diag_printf("Member Name: %s\n", n->data.struct_access.member_name);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_ARRAY_INIT_EXPR:
-            printf("ArrayInitExpr (\n");
+            diag_printf("ArrayInitExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Expressions: \n");
+            diag_printf("Expressions: \n");
 
             indent += INDENT_WIDTH;
-            vecnode *e = n->data.array_init_expr.expressions->head;
+            vector *e = n->data.array_init_expr.expressions;
             print_indent(indent + INDENT_WIDTH);
-            printf("NumElements: %d\n", n->data.array_init_expr.expressions->count);
+            diag_printf("NumElements: %d\n", e->count);
 
-            if (e != NULL) {
-                printf("\n");
-                while (e != NULL) {
-                    print_node(e->data, indent + INDENT_WIDTH);
-                    e = e->next;
+            if (e->count > 0) {
+                diag_printf("\n");
+                for (int idx = 0; idx < e->count; idx++) {
+                    print_node(vector_get(e, idx), indent + INDENT_WIDTH);
                 }
             }
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("), \n");
+            diag_printf("), \n");
             break;
         case N_ARRAY_ACCESS_EXPR:
-            printf("ArrayAccessExpr (\n");
+            diag_printf("ArrayAccessExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Expressions: \n");
+            diag_printf("Expressions: \n");
 
             indent += INDENT_WIDTH;
-            vecnode *el = n->data.array_access_expr.expressions->head;
+            vector *el = n->data.array_access_expr.expressions;
             print_indent(indent + INDENT_WIDTH);
-            printf("NumElements: %d\n", n->data.array_access_expr.expressions->count);
+            diag_printf("NumElements: %d\n", el->count);
 
-            if (el != NULL) {
-                printf("\n");
-                while (el != NULL) {
-                    print_node(el->data, indent + INDENT_WIDTH);
-                    el = el->next;
+            if (el->count > 0) {
+                diag_printf("\n");
+                for (int idx = 0; idx < el->count; idx++) {
+                    print_node(vector_get(el, idx), indent + INDENT_WIDTH);
                 }
             }
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("), \n");
+            diag_printf("), \n");
             break;
         case N_FORMAL:
-            printf("Formal (\n");
+            diag_printf("Formal (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.formal.name);
+            diag_printf("Name: %s\n", n->data.formal.name);
             print_indent(indent + INDENT_WIDTH);
-            printf("IsStruct: %s\n", (n->data.formal.is_struct ? "true" : "false"));
+            diag_printf("IsStruct: %s\n", (n->data.formal.is_struct ? "true" : "false"));
             print_indent(indent + INDENT_WIDTH);
-            printf("IsArray: %s\n", (n->data.formal.is_array ? "true" : "false"));
+            diag_printf("IsArray: %s\n", (n->data.formal.is_array ? "true" : "false"));
             print_indent(indent + INDENT_WIDTH);
-            printf("Dimensions: %d\n", n->data.formal.num_dimensions);
+            diag_printf("Dimensions: %d\n", n->data.formal.num_dimensions);
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.formal.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.formal.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("StructType: %s\n", n->data.formal.struct_type);
+            diag_printf("StructType: %s\n", n->data.formal.struct_type);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_MEMBER_DECL:
-            printf("MemberDecl (\n");
+            diag_printf("MemberDecl (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.member_decl.name);
+            diag_printf("Name: %s\n", n->data.member_decl.name);
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.member_decl.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.member_decl.type));
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_INTEGER_LITERAL:
-            printf("IntegerLiteral (\n");
+            diag_printf("IntegerLiteral (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.integer_literal.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.integer_literal.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("Value: %d\n", n->data.integer_literal.value);
+            diag_printf("Value: %d\n", n->data.integer_literal.value);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_FLOAT_LITERAL:
-            printf("FloatLiteral (\n");
+            diag_printf("FloatLiteral (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.float_literal.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.float_literal.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("Value: %f\n", n->data.float_literal.value);
+            diag_printf("Value: %f\n", n->data.float_literal.value);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_STRING_LITERAL:
-            printf("StringLiteral (\n");
+            diag_printf("StringLiteral (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.string_literal.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.string_literal.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("Value: %s\n", n->data.string_literal.value);
+            diag_printf("Value: %s\n", n->data.string_literal.value);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_BOOL_LITERAL:
-            printf("BoolLiteral (\n");
+            diag_printf("BoolLiteral (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Type: %s\n", type_to_str((data_type)n->data.bool_literal.type));
+            diag_printf("Type: %s\n", type_to_str((data_type)n->data.bool_literal.type));
             print_indent(indent + INDENT_WIDTH);
-            printf("Value: %d\n", n->data.bool_literal.value);
+            diag_printf("Value: %d\n", n->data.bool_literal.value);
             print_indent(indent + INDENT_WIDTH);
-            printf("StringValue: %s\n", n->data.bool_literal.str_val);
+            diag_printf("StringValue: %s\n", n->data.bool_literal.str_val);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_NIL:
-            printf("Nil (\n");
+            diag_printf("Nil (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Value: %d\n", n->data.nil.value);
+            diag_printf("Value: %d\n", n->data.nil.value);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_IDENT:
-            printf("Identifier (\n");
+            diag_printf("Identifier (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Name: %s\n", n->data.identifier.name);
+            diag_printf("Name: %s\n", n->data.identifier.name);
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_IF_STMT:
-            printf("IfStmt (\n");
+            diag_printf("IfStmt (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Test: \n");
+            diag_printf("Test: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.if_stmt.test, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent + INDENT_WIDTH);
-            printf("Body: \n");
+            diag_printf("Body: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.if_stmt.body, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent + INDENT_WIDTH);
-            printf("Else: ");
+            diag_printf("Else: ");
 
             if (n->data.if_stmt.else_stmt == NULL) {
-                printf("None \n");
+                diag_printf("None \n");
             } else {
-                printf("\n");
+                diag_printf("\n");
                 indent += INDENT_WIDTH;
                 print_node(n->data.if_stmt.else_stmt, indent + INDENT_WIDTH);
                 indent -= INDENT_WIDTH;
             }
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_WHILE_STMT:
-            printf("WhileStmt (\n");
+            diag_printf("WhileStmt (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Test: \n");
+            diag_printf("Test: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.while_stmt.test, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent + INDENT_WIDTH);
-            printf("Body: \n");
+            diag_printf("Body: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.while_stmt.body, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_EMPTY_EXPR:
-            printf("EmptyExpr (),\n");
+            diag_printf("EmptyExpr (),\n");
             break;
         case N_NEG_EXPR:
-            printf("NegExpr (\n");
+            diag_printf("NegExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Expr: \n");
+            diag_printf("Expr: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.neg_expr.expr, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf(")\n");
+            diag_printf(")\n");
             break;
         case N_NOT_EXPR:
-            printf("NotExpr (\n");
+            diag_printf("NotExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("Expr: \n");
+            diag_printf("Expr: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.not_expr.expr, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf(")\n");
+            diag_printf(")\n");
             break;
         case N_BINOP_EXPR:
-            printf("BinOpExpr (\n");
+            diag_printf("BinOpExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("LHS: \n");
+            diag_printf("LHS: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.bin_op_expr.lhs, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent + INDENT_WIDTH);
-            printf("Operator: %s\n", binop_to_str(n->data.bin_op_expr.operator));
+            diag_printf("Operator: %s\n", binop_to_str(n->data.bin_op_expr.operator));
 
             print_indent(indent + INDENT_WIDTH);
-            printf("RHS: \n");
+            diag_printf("RHS: \n");
             indent += INDENT_WIDTH;
             print_node(n->data.bin_op_expr.rhs, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         case N_ASSIGN_EXPR:
-            printf("AssignExpr (\n");
+            diag_printf("AssignExpr (\n");
             print_indent(indent + INDENT_WIDTH);
-            printf("LHS: \n");
+            diag_printf("LHS: \n");
 
             indent += INDENT_WIDTH;
             print_node(n->data.assign_expr.lhs, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent + INDENT_WIDTH);
-            printf("RHS: \n");
+            diag_printf("RHS: \n");
             indent += INDENT_WIDTH;
             print_node(n->data.assign_expr.rhs, indent + INDENT_WIDTH);
             indent -= INDENT_WIDTH;
 
             print_indent(indent);
-            printf("),\n");
+            diag_printf("),\n");
             break;
         default:
-            printf("Unknown node type: %d\n", n->type);
+            diag_printf("Unknown node type: %d\n", n->type);
     }
 }
 
@@ -553,27 +539,23 @@ void print_ast(node *ast) {
 
         // Print children
         print_indent(indent);
-        printf("Statements (");
-        if (ast->data.program.statements->head != NULL) {
-            printf("\n");
+        diag_printf("Statements (");
+        if (vector_length(ast->data.program.statements) > 0) {
+            diag_printf("\n");
             indent += INDENT_WIDTH;
-            vecnode *vn = ast->data.program.statements->head;
-            while (vn != NULL) {
-                node *n = vn->data;
-                print_node(n, indent);
-
-                vn = vn->next;
+            for (int idx = 0; idx < vector_length(ast->data.program.statements); idx++) {
+                print_node(vector_get(ast->data.program.statements, idx), indent);
             }
 
             indent -= INDENT_WIDTH;
             print_indent(indent);
         } else {
-            printf("None");
+            diag_printf("None");
         }
-        printf(")\n");
+        diag_printf(")\n");
     }
 
     indent -= INDENT_WIDTH;
-    printf(")\n");
+    diag_printf(")\n");
     return;
 }
@@ -7,6 +7,8 @@
 #ifndef AST_H
 #define AST_H
 
+#include "arena.h"
+#include "strtab.h"
 #include "token.h"
 #include "vector.h"
 #include <stdbool.h>
@@ -71,16 +73,19 @@ typedef enum data_type {
     D_UNKNOWN = 7
 } data_type;
 
-typedef struct type_s {
-    data_type datatype;
-    bool is_function;
-    bool is_array;
-    char struct_type[MAX_LITERAL];
-} type_t;
+// Id of a type in the program's type table (typetab.h). Expressions are annotated with one once
+// the typechecker has resolved their type, and TYPE_NONE until then.
+typedef unsigned int type_id_t;
+
+#define TYPE_NONE 0
 
 // Node types
+//
+// Names, type names and string literals are interned in the program's string table (strtab.h), so
+// two of them are equal exactly when their pointers are. Unset ones point to strtab_empty.
 typedef struct program_s {
     vector *statements; // All child nodes within a program will be within this vector
+    strtab_t *names;    // The string table everything below is interned in
 } program_t;
 
 // Multi-use block of statements (function body, if-else body, etc.)
@@ -89,7 +94,7 @@ typedef struct block_stmt_s {
 } block_stmt_t;
 
 typedef struct identifier_s {
-    char name[MAX_LITERAL];
+    const char *name;
 } identifier_t;
 
 typedef struct neg_expr_s {
@@ -107,21 +112,21 @@ typedef struct bin_op_expr_s {
 } bin_op_expr_t;
 
 typedef struct label_decl_s {
-    char name[MAX_LITERAL];
+    const char *name;
 } label_decl_t;
 
 typedef struct goto_stmt_s {
-    char label[MAX_LITERAL];
+    const char *label;
 } goto_stmt_t;
 
 typedef struct call_expr_s {
-    char func_name[MAX_LITERAL];
+    const char *func_name;
     vector *args; // arguments
 } call_expr_t;
 
 typedef struct struct_access_s {
-    char name[MAX_LITERAL];
-    char member_name[MAX_LITERAL];
+    const char *name;
+    const char *member_name;
 } struct_access_t;
 
 typedef struct assign_expr_s {
@@ -131,33 +136,33 @@ typedef struct assign_expr_s {
 
 typedef struct formal_s {
     data_type type;
-    char struct_type[MAX_LITERAL];
+    const char *struct_type;
     bool is_struct;
     bool is_array;
     int num_dimensions;
-    char name[MAX_LITERAL];
+    const char *name;
 } formal_t;
 
 // Todo, expand member decls to include arrays or other structs
 typedef struct member_decl_s {
     data_type type;
-    char name[MAX_LITERAL];
+    const char *name;
 } member_decl_t;
 
 typedef struct var_decl_s {
     data_type type;
-    char struct_type[MAX_LITERAL];
+    const char *struct_type;
     bool is_struct;
     bool is_array;
     int num_dimensions; // keep track of the number of array dimensions
-    char name[MAX_LITERAL];
+    const char *name;
     struct node *value; // should be an expression node
 } var_decl_t;
 
 typedef struct function_decl_s {
-    char name[MAX_LITERAL];
+    const char *name;
     data_type type;
-    char struct_type[MAX_LITERAL];
+    const char *struct_type;
     vector *formals;   // formal arguments
     struct node *body; // (block) statements make up the body of a function
     bool is_void;
@@ -167,7 +172,7 @@ typedef struct function_decl_s {
 } function_decl_t;
 
 typedef struct struct_decl_s {
-    char name[MAX_LITERAL];
+    const char *name;
     data_type type;  // always D_STRUCT
     vector *members; // member_decl_t's
 } struct_decl_t;
@@ -195,7 +200,7 @@ typedef struct array_init_expr_s {
 } array_init_expr_t;
 
 typedef struct array_access_expr_s {
-    char name[MAX_LITERAL];
+    const char *name;
     vector *expressions;
     /* vector holding expressions in order of dimension
      * (i.e. my_array[0][i-1][2][3+j] --> 0, i-1, 2, 3+j,
@@ -219,12 +224,12 @@ typedef struct float_literal_s {
 
 typedef struct string_literal_s {
     data_type type;
-    char value[MAX_LITERAL + 1]; // we'll be nice and make these null-terminated
+    const char *value;
 } string_literal_t;
 
 typedef struct bool_literal_s {
     data_type type;
-    char str_val[MAX_LITERAL + 1];
+    const char *str_val;
     char value; // 0 or 1
 } bool_literal_t;
 
@@ -235,6 +240,7 @@ typedef struct nil_s {
 // AST node
 typedef struct node {
     n_type type;
+    type_id_t type_id; // Resolved type of an expression, set by the typechecker
     union {
         program_t program;
         formal_t formal;
@@ -266,7 +272,9 @@ typedef struct node {
 } node;
 
 // Prototypes
-node *mk_node(n_type type);
+
+// Allocates a zeroed node of type from arena, which must not be NULL
+node *mk_node(arena_t *arena, n_type type);
 
 data_type keyword_to_type(token_type t);
 char *binop_to_str(token_type t);
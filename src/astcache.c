@@ -0,0 +1,729 @@
+/**
+ * AST Cache Module
+ * File: astcache.c
+ * Author: Liam M. Murphy
+ */
+
+#include "astcache.h"
+
+#include "error.h"
+#include "strtab.h"
+#include "version.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define AST_CACHE_MAGIC "LBASTC"
+
+// Sections of a file start on a boundary suitable for any type
+#define SECTION_ALIGN ((uint64_t)_Alignof(max_align_t))
+
+// FNV-1a, as source_hash() uses
+#define FNV64_PRIME 1099511628211ULL
+
+const char *ast_cache_dir = NULL;
+
+// Start of a cache file. Offsets are from the start of the file.
+typedef struct cache_header_s {
+    char magic[8];
+    uint32_t format;         // AST_CACHE_FORMAT
+    uint32_t node_size;      // sizeof(node), in case a layout changed without the format
+    uint64_t key;            // See ast_cache_key()
+    uint64_t source_length;  // Of the program, which tells apart most programs whose keys collide
+    uint64_t file_size;      // Of the whole file
+    uint64_t nodes_offset;   // num_nodes nodes. The first is the program.
+    uint64_t vectors_offset; // num_vectors vectors
+    uint64_t items_offset;   // num_items offsets of nodes, which the vectors' items point into
+    uint64_t strings_offset; // The string table's entries in id order, from id 1
+    uint64_t strings_size;
+    uint32_t num_nodes;
+    uint32_t num_vectors;
+    uint32_t num_items;
+    uint32_t num_strings; // Not counting the empty string, which is never stored
+} cache_header_t;
+
+// The pointers a node holds, which are offsets within a cache file. A node holds at most three of
+// any one kind.
+typedef struct node_slots_s {
+    node **nodes[3];
+    vector **vectors[1];
+    const char **strings[3];
+    unsigned int num_nodes;
+    unsigned int num_vectors;
+    unsigned int num_strings;
+    n_type item_type; // What each node in the vector must be, or NUM_TYPES for any
+} node_slots_t;
+
+// Whether the byte at b holds false or true, read without loading it as a bool
+static bool valid_bool(const bool *b) {
+    unsigned char byte;
+    memcpy(&byte, b, sizeof(byte));
+
+    return byte <= 1;
+}
+
+static bool valid_data_type(data_type type) { return (unsigned int)type <= D_UNKNOWN; }
+
+// Finds the pointers n holds. Returns false for a type of node the cache does not know, or a node
+// whose other fields hold values no node of its type can have.
+static bool node_slots(node *n, node_slots_t *slots) {
+    *slots  = (node_slots_t){.item_type = NUM_TYPES};
+    bool ok = true;
+
+#define NODE_SLOT(field) (slots->nodes[slots->num_nodes++] = &n->data.field)
+#define VECTOR_SLOT(field) (slots->vectors[slots->num_vectors++] = &n->data.field)
+#define STRING_SLOT(field) (slots->strings[slots->num_strings++] = &n->data.field)
+
+    switch (n->type) {
+        case N_PROGRAM:
+            VECTOR_SLOT(program.statements);
+            break;
+        case N_BLOCK_STMT:
+            VECTOR_SLOT(block_stmt.statements);
+            break;
+        case N_FUNC_DECL:
+            STRING_SLOT(function_decl.name);
+            STRING_SLOT(function_decl.struct_type);
+            VECTOR_SLOT(function_decl.formals);
+            NODE_SLOT(function_decl.body);
+            slots->item_type = N_FORMAL;
+            ok = valid_data_type(n->data.function_decl.type) &&
+                 valid_bool(&n->data.function_decl.is_void) &&
+                 valid_bool(&n->data.function_decl.is_array) &&
+                 valid_bool(&n->data.function_decl.is_struct);
+            break;
+        case N_LABEL_DECL:
+            STRING_SLOT(label_decl.name);
+            break;
+        case N_VAR_DECL:
+            STRING_SLOT(var_decl.struct_type);
+            STRING_SLOT(var_decl.name);
+            NODE_SLOT(var_decl.value);
+            ok = valid_data_type(n->data.var_decl.type) &&
+                 valid_bool(&n->data.var_decl.is_struct) && valid_bool(&n->data.var_decl.is_array);
+            break;
+        case N_MEMBER_DECL:
+            STRING_SLOT(member_decl.name);
+            ok = valid_data_type(n->data.member_decl.type);
+            break;
+        case N_STRUCT_DECL:
+            STRING_SLOT(struct_decl.name);
+            VECTOR_SLOT(struct_decl.members);
+            slots->item_type = N_MEMBER_DECL;
+            ok               = valid_data_type(n->data.struct_decl.type);
+            break;
+        case N_WHILE_STMT:
+            NODE_SLOT(while_stmt.test);
+            NODE_SLOT(while_stmt.body);
+            break;
+        case N_IF_STMT:
+            NODE_SLOT(if_stmt.test);
+            NODE_SLOT(if_stmt.body);
+            NODE_SLOT(if_stmt.else_stmt);
+            break;
+        case N_RETURN_STMT:
+            NODE_SLOT(return_stmt.expr);
+            break;
+        case N_ARRAY_INIT_EXPR:
+            VECTOR_SLOT(array_init_expr.expressions);
+            break;
+        case N_ARRAY_ACCESS_EXPR:
+            STRING_SLOT(array_access_expr.name);
+            VECTOR_SLOT(array_access_expr.expressions);
+            break;
+        case N_ASSIGN_EXPR:
+            NODE_SLOT(assign_expr.lhs);
+            NODE_SLOT(assign_expr.rhs);
+            break;
+        case N_STRUCT_ACCESS_EXPR:
+            STRING_SLOT(struct_access.name);
+            STRING_SLOT(struct_access.member_name);
+            break;
+        case N_FORMAL:
+            STRING_SLOT(formal.struct_type);
+            STRING_SLOT(formal.name);
+            ok = valid_data_type(n->data.formal.type) && valid_bool(&n->data.formal.is_struct) &&
+                 valid_bool(&n->data.formal.is_array);
+            break;
+        case N_BINOP_EXPR:
+            NODE_SLOT(bin_op_expr.lhs);
+            NODE_SLOT(bin_op_expr.rhs);
+            ok = ((unsigned int)n->data.bin_op_expr.operator < NTOKENS);
+            break;
+        case N_GOTO_STMT:
+            STRING_SLOT(goto_stmt.label);
+            break;
+        case N_CALL_EXPR:
+            STRING_SLOT(call_expr.func_name);
+            VECTOR_SLOT(call_expr.args);
+            break;
+        case N_NEG_EXPR:
+            NODE_SLOT(neg_expr.expr);
+            break;
+        case N_NOT_EXPR:
+            NODE_SLOT(not_expr.expr);
+            break;
+        case N_IDENT:
+            STRING_SLOT(identifier.name);
+            break;
+        case N_STRING_LITERAL:
+            STRING_SLOT(string_literal.value);
+            ok = valid_data_type(n->data.string_literal.type);
+            break;
+        case N_BOOL_LITERAL:
+            STRING_SLOT(bool_literal.str_val);
+            ok = valid_data_type(n->data.bool_literal.type);
+            break;
+        case N_INTEGER_LITERAL:
+            ok = valid_data_type(n->data.integer_literal.type);
+            break;
+        case N_FLOAT_LITERAL:
+            ok = valid_data_type(n->data.float_literal.type);
+            break;
+        case N_EMPTY_EXPR:
+        case N_NIL:
+            // Nothing but values
+            break;
+        default:
+            return false;
+    }
+
+#undef NODE_SLOT
+#undef VECTOR_SLOT
+#undef STRING_SLOT
+
+    return ok;
+}
+
+static uint64_t align_section(uint64_t offset) {
+    return (offset + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+}
+
+// Bytes a string of length bytes takes in the file, which keeps the next one aligned
+static uint64_t string_size(uint32_t length) {
+    const uint64_t align = _Alignof(strtab_entry_t);
+
+    return (sizeof(strtab_entry_t) + length + 1 + align - 1) & ~(align - 1);
+}
+
+static void cache_path(const char *dir, uint64_t key, char *path, size_t len) {
+    snprintf(path, len, "%s/%016" PRIx64 ".ast", dir, key);
+}
+
+uint64_t ast_cache_key(const source_t *src) {
+    // The compiler version and the format go in after the text, so that no two versions share keys
+    char version[64];
+    const int len = snprintf(version, sizeof(version), "%s/%d/%zu", LBASIC_VERSION,
+                             AST_CACHE_FORMAT, sizeof(node));
+    uint64_t key  = source_hash(src);
+
+    for (int idx = 0; idx < len; idx++) {
+        key ^= (unsigned char)version[idx];
+        key *= FNV64_PRIME;
+    }
+
+    return key;
+}
+
+/* Writing
+ *
+ *  The AST is copied into arrays of nodes, vectors and items, in which each pointer to a node or
+ *  vector holds 1 + its index, and each string its id. Once the size of each array is known, those
+ *  are turned into offsets within the file. */
+typedef struct writer_s {
+    node *nodes;
+    vector *vectors;
+    uintptr_t *items;
+    uint32_t num_nodes;
+    uint32_t num_vectors;
+    uint32_t num_items;
+    uint32_t nodes_capacity;
+    uint32_t vectors_capacity;
+    uint32_t items_capacity;
+    bool ok; // Cleared by a node the cache does not know
+} writer_t;
+
+// Makes room for count elements of size bytes in *array, which has room for *capacity
+static void reserve(void *array, uint32_t *capacity, uint32_t count, size_t size) {
+    if (count > *capacity) {
+        uint32_t new_capacity = (*capacity > 0) ? *capacity : 64;
+        while (new_capacity < count) {
+            new_capacity *= 2;
+        }
+
+        void *grown = realloc(*(void **)array, new_capacity * size);
+        if (grown == NULL) {
+            log_error("Unable to allocate memory to cache an AST");
+        }
+
+        *(void **)array = grown;
+        *capacity       = new_capacity;
+    }
+}
+
+static uintptr_t add_vector(writer_t *w, const vector *v);
+
+// Copies n and everything beneath it. Returns its tag: 1 + its index, or 0 for NULL.
+static uintptr_t add_node(writer_t *w, const node *n) {
+    if (n == NULL) {
+        return 0;
+    }
+
+    const uint32_t idx = w->num_nodes++;
+    reserve(&w->nodes, &w->nodes_capacity, w->num_nodes, sizeof(node));
+
+    node copy    = *n;
+    copy.type_id = TYPE_NONE;
+    if (copy.type == N_PROGRAM) {
+        copy.data.program.names = NULL;
+    }
+
+    node_slots_t slots;
+    if (!node_slots(&copy, &slots)) {
+        w->ok = false;
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < slots.num_nodes; i++) {
+        *slots.nodes[i] = (node *)add_node(w, *slots.nodes[i]);
+    }
+    for (unsigned int i = 0; i < slots.num_vectors; i++) {
+        *slots.vectors[i] = (vector *)add_vector(w, *slots.vectors[i]);
+    }
+    for (unsigned int i = 0; i < slots.num_strings; i++) {
+        const char *str   = *slots.strings[i];
+        *slots.strings[i] = (const char *)(uintptr_t)((str != NULL) ? strtab_id(str) : 0);
+    }
+
+    // The array may have moved while the children were added
+    w->nodes[idx] = copy;
+
+    return 1 + idx;
+}
+
+// Copies v and the nodes it holds, whose tags take up consecutive items. Returns its tag.
+static uintptr_t add_vector(writer_t *w, const vector *v) {
+    if (v == NULL) {
+        return 0;
+    }
+
+    const uint32_t idx   = w->num_vectors++;
+    const uint32_t first = w->num_items;
+    reserve(&w->vectors, &w->vectors_capacity, w->num_vectors, sizeof(vector));
+
+    w->num_items += vector_length(v);
+    reserve(&w->items, &w->items_capacity, w->num_items, sizeof(uintptr_t));
+
+    for (int i = 0; i < vector_length(v); i++) {
+        const node *item = vector_get(v, i);
+
+        // The loader turns away a vector with a hole in it, as nothing that reads one expects it
+        if (item == NULL) {
+            w->ok = false;
+        }
+
+        const uintptr_t tag = add_node(w, item);
+        w->items[first + i] = tag;
+    }
+
+    w->vectors[idx] = (vector){.items    = (void **)(uintptr_t)first,
+                               .count    = vector_length(v),
+                               .capacity = vector_length(v),
+                               .arena    = NULL};
+
+    return 1 + idx;
+}
+
+// Offset of the node or vector with the given tag, within a section of elements of size bytes
+static uintptr_t tag_offset(uintptr_t tag, uint64_t section, size_t size) {
+    return (tag == 0) ? 0 : (uintptr_t)(section + (tag - 1) * size);
+}
+
+// Writes the len bytes at buf to path, by way of a temporary file so that no reader ever sees
+// part of it
+static bool write_file(const char *path, const char *buf, size_t len) {
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+
+    const int fd = mkstemp(tmp_path);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok = true;
+    while (ok && (len > 0)) {
+        const ssize_t written = write(fd, buf, len);
+
+        if (written < 0) {
+            ok = (errno == EINTR);
+        } else {
+            buf += written;
+            len -= (size_t)written;
+        }
+    }
+
+    ok = (close(fd) == 0) && ok;
+    ok = ok && (rename(tmp_path, path) == 0);
+
+    if (!ok) {
+        unlink(tmp_path);
+    }
+
+    return ok;
+}
+
+bool ast_cache_store(const char *dir, uint64_t key, size_t source_length, const node *program) {
+    const strtab_t *names = program->data.program.names;
+    writer_t w            = {.ok = true};
+
+    add_node(&w, program);
+
+    if (!w.ok) {
+        debug(TRACE_PARSER, "Not caching an AST holding a node the cache does not know");
+        free(w.nodes);
+        free(w.vectors);
+        free(w.items);
+        return false;
+    }
+
+    // Lay out the file
+    cache_header_t header = {.magic         = AST_CACHE_MAGIC,
+                             .format        = AST_CACHE_FORMAT,
+                             .node_size     = sizeof(node),
+                             .key           = key,
+                             .source_length = source_length,
+                             .num_nodes     = w.num_nodes,
+                             .num_vectors   = w.num_vectors,
+                             .num_items     = w.num_items,
+                             .num_strings   = names->count - 1};
+
+    header.nodes_offset   = align_section(sizeof(cache_header_t));
+    header.vectors_offset = align_section(header.nodes_offset + w.num_nodes * sizeof(node));
+    header.items_offset   = align_section(header.vectors_offset + w.num_vectors * sizeof(vector));
+    header.strings_offset = align_section(header.items_offset + w.num_items * sizeof(uintptr_t));
+
+    uint64_t *string_offsets = (uint64_t *)calloc(names->count, sizeof(uint64_t));
+    if (string_offsets == NULL) {
+        log_error("Unable to allocate memory to cache an AST");
+    }
+
+    for (unsigned int id = 1; id < names->count; id++) {
+        string_offsets[id] = header.strings_offset + header.strings_size +
+                             offsetof(strtab_entry_t, str);
+        header.strings_size += string_size(names->entries[id]->length);
+    }
+
+    header.file_size = header.strings_offset + header.strings_size;
+
+    // Turn tags and ids into offsets
+    for (uint32_t idx = 0; idx < w.num_nodes; idx++) {
+        node_slots_t slots;
+        node_slots(&w.nodes[idx], &slots);
+
+        for (unsigned int i = 0; i < slots.num_nodes; i++) {
+            *slots.nodes[i] = (node *)tag_offset((uintptr_t)*slots.nodes[i], header.nodes_offset,
+                                                 sizeof(node));
+        }
+        for (unsigned int i = 0; i < slots.num_vectors; i++) {
+            *slots.vectors[i] = (vector *)tag_offset((uintptr_t)*slots.vectors[i],
+                                                     header.vectors_offset, sizeof(vector));
+        }
+        for (unsigned int i = 0; i < slots.num_strings; i++) {
+            const uintptr_t id = (uintptr_t)*slots.strings[i];
+            *slots.strings[i]  = (const char *)(uintptr_t)string_offsets[id];
+        }
+    }
+
+    for (uint32_t idx = 0; idx < w.num_vectors; idx++) {
+        const uintptr_t first = (uintptr_t)w.vectors[idx].items;
+        w.vectors[idx].items  = (void **)(header.items_offset + first * sizeof(uintptr_t));
+    }
+
+    for (uint32_t idx = 0; idx < w.num_items; idx++) {
+        w.items[idx] = tag_offset(w.items[idx], header.nodes_offset, sizeof(node));
+    }
+
+    // Then copy it all into place
+    char *buf = (char *)calloc(1, header.file_size);
+    if (buf == NULL) {
+        log_error("Unable to allocate memory to cache an AST");
+    }
+
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + header.nodes_offset, w.nodes, w.num_nodes * sizeof(node));
+    memcpy(buf + header.vectors_offset, w.vectors, w.num_vectors * sizeof(vector));
+    memcpy(buf + header.items_offset, w.items, w.num_items * sizeof(uintptr_t));
+
+    for (unsigned int id = 1; id < names->count; id++) {
+        const strtab_entry_t *entry = names->entries[id];
+
+        memcpy(buf + string_offsets[id] - offsetof(strtab_entry_t, str), entry,
+               sizeof(strtab_entry_t) + entry->length + 1);
+    }
+
+    char path[PATH_MAX];
+    cache_path(dir, key, path, sizeof(path));
+
+    // The directory may well exist already
+    mkdir(dir, 0777);
+
+    const bool ok = write_file(path, buf, header.file_size);
+    debug(TRACE_PARSER, "%s AST of %u nodes to %s", ok ? "Cached" : "Unable to cache", w.num_nodes,
+          path);
+
+    free(buf);
+    free(string_offsets);
+    free(w.nodes);
+    free(w.vectors);
+    free(w.items);
+
+    return ok;
+}
+
+/* Loading
+ *
+ *  Nothing in a file is followed until it has been checked: every offset must land on an element
+ *  of the section it points into, a string's on the text of one of the file's strings, and a
+ *  node's children must come after it, as the writer lays nodes out parents first, so a damaged
+ *  file cannot lead outside itself or into a cycle. Every enum and bool must hold a value its
+ *  field can have. A file that fails any check is turned away. A value that is damaged but still
+ *  allowed, such as a literal's, is loaded as it is. */
+typedef struct loader_s {
+    char *base; // Where the file is mapped
+    const cache_header_t *header;
+    strtab_t *names; // The file's strings, once they have been adopted
+    bool ok;         // Cleared by the first check that fails
+} loader_t;
+
+// Whether count elements of size bytes, from offset on, lie within the file
+static bool section_fits(const cache_header_t *header, uint64_t offset, uint64_t count,
+                         size_t size) {
+    return (offset % SECTION_ALIGN == 0) && (offset <= header->file_size) &&
+           (count <= (header->file_size - offset) / size);
+}
+
+// Turns the offset of an element of a section of count elements of size bytes into a pointer
+static void *relocate(loader_t *l, const void *offset, uint64_t section, uint32_t count,
+                      size_t size) {
+    const uintptr_t value = (uintptr_t)offset;
+
+    if (value == 0) {
+        return NULL;
+    }
+
+    if ((value < section) || ((value - section) % size != 0) ||
+        ((value - section) / size >= count)) {
+        l->ok = false;
+        return NULL;
+    }
+
+    return l->base + value;
+}
+
+// Turns the offset of a child of the node at offset parent into a pointer
+static node *relocate_child(loader_t *l, const node *offset, uint64_t parent) {
+    if ((offset != NULL) && ((uintptr_t)offset <= parent)) {
+        l->ok = false;
+        return NULL;
+    }
+
+    return (node *)relocate(l, offset, l->header->nodes_offset, l->header->num_nodes,
+                            sizeof(node));
+}
+
+// Turns the offset of a string into a pointer to it. Offset 0 is the empty string. Any other must
+// be the text of an entry the string table adopted.
+static const char *relocate_string(loader_t *l, const char *offset) {
+    const uintptr_t value = (uintptr_t)offset;
+    const uint64_t start  = l->header->strings_offset + offsetof(strtab_entry_t, str);
+    const uint64_t end    = l->header->strings_offset + l->header->strings_size;
+
+    if (value == 0) {
+        return strtab_empty;
+    }
+
+    const uint64_t entry_offset = value - offsetof(strtab_entry_t, str);
+
+    if ((value < start) || (value >= end) || (entry_offset % _Alignof(strtab_entry_t) != 0) ||
+        (end - entry_offset < sizeof(strtab_entry_t))) {
+        l->ok = false;
+        return strtab_empty;
+    }
+
+    const strtab_entry_t *entry = (const strtab_entry_t *)(l->base + entry_offset);
+
+    if ((entry->id == 0) || (entry->id >= l->names->count) ||
+        (l->names->entries[entry->id] != entry)) {
+        l->ok = false;
+        return strtab_empty;
+    }
+
+    return entry->str;
+}
+
+// Whether v, not fixed up yet, holds count offsets that lie within the items section
+static bool vector_fits(const loader_t *l, const vector *v) {
+    const cache_header_t *h = l->header;
+    const uintptr_t first   = (uintptr_t)v->items;
+
+    return (first >= h->items_offset) && ((first - h->items_offset) % sizeof(uintptr_t) == 0) &&
+           (v->count >= 0) && (v->count == v->capacity) &&
+           ((first - h->items_offset) / sizeof(uintptr_t) + v->count <= h->num_items);
+}
+
+// Checks that each item of v, a vector the node at offset parent holds, is a node after it, and of
+// item_type unless that is NUM_TYPES. v and its items are fixed up later.
+static void check_items(loader_t *l, const vector *v, uint64_t parent, n_type item_type) {
+    if (!vector_fits(l, v)) {
+        l->ok = false;
+        return;
+    }
+
+    const uintptr_t *items = (const uintptr_t *)(l->base + (uintptr_t)v->items);
+
+    for (int i = 0; l->ok && (i < v->count); i++) {
+        const node *item = relocate_child(l, (const node *)items[i], parent);
+
+        l->ok = l->ok && (item != NULL) && ((item_type == NUM_TYPES) || (item->type == item_type));
+    }
+}
+
+// Adopts each string of the file into l->names, where it lies
+static void load_strings(loader_t *l) {
+    const uint64_t end = l->header->strings_offset + l->header->strings_size;
+    uint64_t pos       = l->header->strings_offset;
+
+    for (uint32_t id = 1; l->ok && (id <= l->header->num_strings); id++) {
+        strtab_entry_t *entry = (strtab_entry_t *)(l->base + pos);
+
+        l->ok = (end - pos >= sizeof(strtab_entry_t)) && (entry->id == id) &&
+                (entry->length < end - pos - sizeof(strtab_entry_t)) &&
+                (entry->str[entry->length] == '\0');
+
+        if (l->ok) {
+            strtab_adopt(l->names, entry);
+            pos += string_size(entry->length);
+        }
+    }
+}
+
+// Checks the header and fixes up every offset in the file. Returns the program, or NULL if the
+// file is not one to load.
+static node *load_program(loader_t *l, uint64_t key, size_t source_length, arena_t *arena) {
+    const cache_header_t *h = l->header;
+
+    l->ok = (memcmp(h->magic, AST_CACHE_MAGIC, sizeof(AST_CACHE_MAGIC)) == 0) &&
+            (h->format == AST_CACHE_FORMAT) && (h->node_size == sizeof(node)) &&
+            (h->key == key) && (h->source_length == source_length) && (h->num_nodes > 0) &&
+            section_fits(h, h->nodes_offset, h->num_nodes, sizeof(node)) &&
+            section_fits(h, h->vectors_offset, h->num_vectors, sizeof(vector)) &&
+            section_fits(h, h->items_offset, h->num_items, sizeof(uintptr_t)) &&
+            section_fits(h, h->strings_offset, h->strings_size, 1);
+
+    if (!l->ok) {
+        return NULL;
+    }
+
+    l->names = strtab_new(arena);
+    load_strings(l);
+
+    // Only the first node is the program
+    node *nodes = (node *)(l->base + h->nodes_offset);
+    for (uint32_t idx = 0; l->ok && (idx < h->num_nodes); idx++) {
+        node *n               = &nodes[idx];
+        const uint64_t offset = h->nodes_offset + idx * sizeof(node);
+        node_slots_t slots;
+
+        l->ok      = node_slots(n, &slots) && ((n->type == N_PROGRAM) == (idx == 0));
+        n->type_id = TYPE_NONE;
+
+        for (unsigned int i = 0; l->ok && (i < slots.num_nodes); i++) {
+            *slots.nodes[i] = relocate_child(l, *slots.nodes[i], offset);
+        }
+        for (unsigned int i = 0; l->ok && (i < slots.num_vectors); i++) {
+            *slots.vectors[i] = (vector *)relocate(l, *slots.vectors[i], h->vectors_offset,
+                                                   h->num_vectors, sizeof(vector));
+            if (l->ok && (*slots.vectors[i] != NULL)) {
+                check_items(l, *slots.vectors[i], offset, slots.item_type);
+            }
+        }
+        for (unsigned int i = 0; l->ok && (i < slots.num_strings); i++) {
+            *slots.strings[i] = relocate_string(l, *slots.strings[i]);
+        }
+    }
+
+    // Items may be added to the vectors as to any others, which grow into the arena
+    vector *vectors = (vector *)(l->base + h->vectors_offset);
+    for (uint32_t idx = 0; l->ok && (idx < h->num_vectors); idx++) {
+        vector *v = &vectors[idx];
+        l->ok     = vector_fits(l, v);
+
+        v->items = (void **)(l->base + (uintptr_t)v->items);
+        v->arena = arena;
+    }
+
+    uintptr_t *items = (uintptr_t *)(l->base + h->items_offset);
+    for (uint32_t idx = 0; l->ok && (idx < h->num_items); idx++) {
+        items[idx] = (uintptr_t)relocate(l, (const void *)items[idx], h->nodes_offset,
+                                         h->num_nodes, sizeof(node));
+    }
+
+    if (!l->ok) {
+        return NULL;
+    }
+
+    nodes[0].data.program.names = l->names;
+
+    return &nodes[0];
+}
+
+node *ast_cache_load(const char *dir, uint64_t key, size_t source_length, arena_t *arena) {
+    char path[PATH_MAX];
+    cache_path(dir, key, path, sizeof(path));
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(cache_header_t))) {
+        close(fd);
+        return NULL;
+    }
+
+    // A private mapping, so the fix-ups never reach the file. Only the pages they touch are copied.
+    const size_t length = (size_t)st.st_size;
+    char *base = (char *)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    loader_t loader = {.base = base, .header = (const cache_header_t *)base};
+    node *program   = NULL;
+
+    if (loader.header->file_size == length) {
+        program = load_program(&loader, key, source_length, arena);
+    }
+
+    if (program == NULL) {
+        debug(TRACE_PARSER, "Ignoring cached AST %s", path);
+        munmap(base, length);
+        return NULL;
+    }
+
+    debug(TRACE_PARSER, "Loaded AST of %u nodes from %s", loader.header->num_nodes, path);
+    arena_adopt_mapping(arena, base, length);
+
+    return program;
+}
@@ -0,0 +1,48 @@
+/**
+ * AST Cache Public Definitions
+ * File: astcache.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef ASTCACHE_H
+#define ASTCACHE_H
+
+#include "arena.h"
+#include "ast.h"
+#include "source.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Version of the file format. Bump it whenever a node's layout changes in ast.h.
+#define AST_CACHE_FORMAT 1
+
+/* AST Cache
+ *
+ *  A directory of parsed programs, so that compiling a program again skips lexing and parsing it.
+ *  Each file holds one program's AST and string table, under a key made from a hash of the
+ *  program's text and the compiler version.
+ *
+ *  The file is the nodes, vectors and strings laid out as they are in memory, with every pointer
+ *  replaced by its offset from the start of the file. Loading maps the file, adds the address of
+ *  the mapping to each offset, and adopts the strings into a new string table where they lie, so
+ *  nothing is copied or hashed again.
+ *
+ *  The driver caches ASTs in ast_cache_dir when it is set. main() sets it from LBASIC_CACHE_DIR and
+ *  any --cache-dir flag, before starting any threads. */
+extern const char *ast_cache_dir;
+
+// Key of the AST of the program src holds
+uint64_t ast_cache_key(const source_t *src);
+
+// Loads the AST cached in dir under key, for a program of source_length bytes. The file stays
+// mapped until arena is freed, and the AST's names are interned in a new string table allocated
+// from arena. Returns NULL if there is no such AST, or it cannot be loaded.
+node *ast_cache_load(const char *dir, uint64_t key, size_t source_length, arena_t *arena);
+
+// Writes program, the AST of a program of source_length bytes, to dir under key, creating dir if
+// need be. Returns false if it was not written. program is left as it was.
+bool ast_cache_store(const char *dir, uint64_t key, size_t source_length, const node *program);
+
+#endif // ASTCACHE_H
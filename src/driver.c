@@ -0,0 +1,367 @@
+/**
+ * LBASIC Compilation Driver
+ * File: driver.c
+ * Author: Liam M. Murphy
+ */
+
+#include "driver.h"
+
+#include "arena.h"
+#include "ast.h"
+#include "astcache.h"
+#include "error.h"
+#include "lexer.h"
+#include "parser.h"
+#include "token.h"
+#include "typechecker.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Work shared by the threads of one compile_files() call
+typedef struct batch_s {
+    compile_result_t *results;
+    unsigned int count;
+    atomic_uint next; // Index of the next program to hand out
+} batch_t;
+
+double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (ts.tv_sec * 1000.0) + (ts.tv_nsec / 1000000.0);
+}
+
+// What a program's compile holds on the heap while it runs. An error trapped partway through
+// leaves it to the caller to free with release_state().
+typedef struct compile_state_s {
+    source_t *source; // The program's text, until the lexer's tokens take it over
+    lexer_t lexer;    // lexer.tokens, once lexing has begun, until the program is parsed
+} compile_state_t;
+
+// Frees whatever a compile that did not finish still held
+static void release_state(compile_state_t *state) {
+    if (state->lexer.tokens != NULL) {
+        // The tokens own the source
+        t_array_free(state->lexer.tokens);
+    } else if (state->source != NULL) {
+        source_free(state->source);
+    }
+
+    state->lexer.tokens = NULL;
+    state->source       = NULL;
+}
+
+// Lexes, parses and typechecks the program at path, or in state->source if it has already been
+// read, with its AST allocated from arena, and returns the AST. Its scopes are left in tc, which
+// the caller frees. With ast_cache_dir set, an AST cached for the same source is loaded in place
+// of lexing and parsing it, and a new one is cached.
+static node *compile_program(const char *path, compile_state_t *state, arena_t *arena,
+                             typechecker_t *tc) {
+    if (state->source == NULL) {
+        state->source = lex_open(path);
+    }
+
+    node *program = NULL;
+    uint64_t key  = 0;
+
+    if (ast_cache_dir != NULL) {
+        key     = ast_cache_key(state->source);
+        program = ast_cache_load(ast_cache_dir, key, state->source->length, arena);
+    }
+
+    if (program != NULL) {
+        source_free(state->source);
+        state->source = NULL;
+    } else {
+        // Lexical analysis. Names are interned in the arena, so they outlive the tokens.
+        lexer_t *lexer             = &state->lexer;
+        const size_t source_length = state->source->length;
+        t_array *token_list        = lex_source(lexer, state->source, strtab_new(arena));
+
+        if (trace_enabled(TRACE_LEXER, TRACE_VERBOSE)) {
+            print_tokens(token_list);
+        }
+
+        // Syntactic analysis
+        parser_t parser;
+        program = parse(&parser, token_list, arena);
+
+        if (program == NULL) {
+            log_error("Unreadable AST generated during parsing.");
+        }
+
+        if (ast_cache_dir != NULL) {
+            ast_cache_store(ast_cache_dir, key, source_length, program);
+        }
+
+        // Cleanup token_list
+        t_array_free(token_list);
+        lexer->tokens = NULL;
+        state->source = NULL;
+    }
+
+    if (trace_enabled(TRACE_PARSER, TRACE_INFO)) {
+        print_ast(program);
+    }
+
+    // Semantic analysis
+    typecheck(tc, program);
+
+    return program;
+}
+
+// Frees the scopes a typecheck left behind, if it got as far as making any
+static void free_scopes(typechecker_t *tc) {
+    if (tc->symbol_table != NULL) {
+        symtab_free(tc->symbol_table);
+        tc->symbol_table = NULL;
+    }
+}
+
+int compile_file(const char *path) {
+    arena_t *arena         = arena_new();
+    typechecker_t tc       = {0};
+    compile_state_t *state = (compile_state_t *)arena_alloc(arena, sizeof(compile_state_t));
+
+    compile_program(path, state, arena, &tc);
+    free_scopes(&tc);
+    arena_free(arena);
+
+    return 0;
+}
+
+// Compiles one program of a batch with its output captured and its errors trapped. If keep is
+// set and the program has no errors, its AST, scopes and types are left in result. source is the
+// program's text if it has already been read, or NULL.
+static void compile_captured(compile_result_t *result, source_t *source, bool keep) {
+    FILE *out = open_memstream(&result->output, &result->output_len);
+    if (out == NULL) {
+        log_error("Unable to capture output for '%s'", result->path);
+    }
+
+    error_trap_t trap;
+    const double start = now_ms();
+
+    // Allocated before the trap is set, so the AST, and the state that points to the tokens and
+    // source, are reachable whether or not the program has errors
+    arena_t *arena         = arena_new();
+    compile_state_t *state = (compile_state_t *)arena_alloc(arena, sizeof(compile_state_t));
+
+    state->source = source;
+    result->tc    = (typechecker_t){0};
+
+    diag_redirect(out);
+
+    if (setjmp(trap.env) == 0) {
+        error_set_trap(&trap);
+        result->program = compile_program(result->path, state, arena, &result->tc);
+        result->status  = 0;
+    } else {
+        result->status = trap.status;
+        release_state(state);
+    }
+
+    error_set_trap(NULL);
+    diag_redirect(NULL);
+
+    if (keep && (result->status == 0)) {
+        result->arena = arena;
+    } else {
+        free_scopes(&result->tc);
+        arena_free(arena);
+        result->arena   = NULL;
+        result->program = NULL;
+    }
+
+    result->ms = now_ms() - start;
+
+    fclose(out);
+}
+
+// Takes programs from the batch until there are none left
+static void *compile_worker(void *arg) {
+    batch_t *batch = (batch_t *)arg;
+
+    for (;;) {
+        const unsigned int idx = atomic_fetch_add(&batch->next, 1);
+        if (idx >= batch->count) {
+            break;
+        }
+
+        compile_captured(&batch->results[idx], NULL, false);
+    }
+
+    return NULL;
+}
+
+int compile_files(char **paths, unsigned int count, unsigned int jobs, FILE *report) {
+    int retval = 0;
+
+    if (jobs == 0) {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs            = (cpus > 0) ? (unsigned int)cpus : 1;
+    }
+
+    // There is no use for more threads than programs
+    if (jobs > count) {
+        jobs = (count > 0) ? count : 1;
+    }
+
+    batch_t batch = {.count = count};
+    atomic_init(&batch.next, 0);
+
+    batch.results      = (compile_result_t *)calloc(count, sizeof(compile_result_t));
+    pthread_t *threads = (pthread_t *)malloc(jobs * sizeof(pthread_t));
+
+    if ((count > 0 && batch.results == NULL) || threads == NULL) {
+        log_error("Unable to allocate memory to compile %u programs", count);
+    }
+
+    for (unsigned int idx = 0; idx < count; idx++) {
+        batch.results[idx].path = paths[idx];
+    }
+
+    const double start = now_ms();
+
+    for (unsigned int idx = 0; idx < jobs; idx++) {
+        if (pthread_create(&threads[idx], NULL, compile_worker, &batch) != 0) {
+            log_error("Unable to start compile thread %u of %u", idx + 1, jobs);
+        }
+    }
+
+    for (unsigned int idx = 0; idx < jobs; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+
+    const double wall_ms = now_ms() - start;
+    double total_ms      = 0.0;
+    unsigned int failed  = 0;
+
+    // Results are reported in the order they were asked for, not the order they finished in
+    for (unsigned int idx = 0; idx < count; idx++) {
+        const compile_result_t *result = &batch.results[idx];
+
+        if (report != NULL && result->output_len > 0) {
+            fprintf(report, "==> %s <==\n", result->path);
+            fwrite(result->output, 1, result->output_len, report);
+        }
+
+        if (result->status != 0) {
+            if (retval == 0) {
+                retval = result->status;
+            }
+            failed++;
+        }
+
+        total_ms += result->ms;
+    }
+
+    if (report != NULL) {
+        for (unsigned int idx = 0; idx < count; idx++) {
+            const compile_result_t *result = &batch.results[idx];
+
+            if (result->status == 0) {
+                fprintf(report, "%10.2f ms  ok         %s\n", result->ms, result->path);
+            } else {
+                fprintf(report, "%10.2f ms  error %-4d %s\n", result->ms, result->status,
+                        result->path);
+            }
+        }
+
+        fprintf(report,
+                "Compiled %u programs (%u failed) in %.2f ms on %u thread%s (%.2f ms total)\n",
+                count, failed, wall_ms, jobs, (jobs == 1) ? "" : "s", total_ms);
+    }
+
+    for (unsigned int idx = 0; idx < count; idx++) {
+        free(batch.results[idx].output);
+    }
+
+    free(batch.results);
+    free(threads);
+
+    return retval;
+}
+
+void compile_kept(const char *path, source_t *source, compile_result_t *result) {
+    *result      = (compile_result_t){0};
+    result->path = path;
+
+    compile_captured(result, source, true);
+}
+
+void compile_result_free(compile_result_t *result) {
+    free_scopes(&result->tc);
+    if (result->arena != NULL) {
+        arena_free(result->arena);
+    }
+    free(result->output);
+
+    *result = (compile_result_t){0};
+}
+
+bool is_directory(const char *path) {
+    struct stat st;
+
+    return (stat(path, &st) == 0) && S_ISDIR(st.st_mode);
+}
+
+static void append_path(char ***paths, unsigned int *count, char *path) {
+    char **new_paths = (char **)realloc(*paths, (*count + 1) * sizeof(char *));
+    if (new_paths == NULL) {
+        log_error("Unable to grow the list of programs to %u", *count + 1);
+    }
+
+    new_paths[(*count)++] = path;
+    *paths                = new_paths;
+}
+
+void collect_sources(const char *path, char ***paths, unsigned int *count) {
+    if (!is_directory(path)) {
+        append_path(paths, count, strdup(path));
+        return;
+    }
+
+    // Sorting by name keeps the order, and so the output, the same from one run to the next
+    struct dirent **entries = NULL;
+    const int n             = scandir(path, &entries, NULL, alphasort);
+
+    if (n < 0) {
+        log_error("Unable to read directory '%s'", path);
+    }
+
+    for (int idx = 0; idx < n; idx++) {
+        const char *name = entries[idx]->d_name;
+
+        if (name[0] != '.') {
+            const size_t len = strlen(path) + strlen(name) + 2;
+            char *child      = (char *)malloc(len);
+
+            if (child == NULL) {
+                log_error("Unable to allocate memory for a path");
+            }
+
+            snprintf(child, len, "%s/%s", path, name);
+
+            if (is_directory(child)) {
+                collect_sources(child, paths, count);
+                free(child);
+            } else if (has_source_extension(name)) {
+                append_path(paths, count, child);
+            } else {
+                free(child);
+            }
+        }
+
+        free(entries[idx]);
+    }
+
+    free(entries);
+}
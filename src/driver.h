@@ -0,0 +1,64 @@
+/**
+ * LBASIC Compilation Driver Public Definitions
+ * File: driver.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include "arena.h"
+#include "ast.h"
+#include "source.h"
+#include "typechecker.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Outcome of compiling one program in a batch
+typedef struct compile_result_s {
+    const char *path;
+    int status;   // 0, or the exit status the first error would have ended the process with
+    double ms;    // Wall time spent compiling the program
+    char *output; // Everything printed while compiling it
+    size_t output_len;
+    arena_t *arena;   // Holds the AST, names and types, if they were kept. Otherwise NULL.
+    node *program;    // The AST, if it was kept
+    typechecker_t tc; // The program's scopes and types, if they were kept
+} compile_result_t;
+
+// Lexes, parses and typechecks the program at path. Returns 0 once it has been checked. Errors end
+// the process, unless the calling thread has set an error trap (see error.h).
+int compile_file(const char *path);
+
+// Compiles the program at path into result, with its output captured and its errors trapped as
+// in a batch. If the program has no errors, its AST, scopes and types are kept in result as well.
+// result->path is set to path, which must outlive result. Free what result holds with
+// compile_result_free().
+//
+// If source is not NULL, it is the program's text, already read from path, and the compile takes
+// it over instead of reading path again. The caller has checked path with has_source_extension()
+// (lexer.h).
+void compile_kept(const char *path, source_t *source, compile_result_t *result);
+
+// Frees the output of a compile_kept() result, and the AST, scopes and types kept with it
+void compile_result_free(compile_result_t *result);
+
+// Compiles count programs on a pool of jobs threads, or one per online CPU if jobs is 0. Errors in
+// one program do not stop the others. Each program's output, then a line with its status and time
+// per program and the total wall time, are printed to report in the order of paths, whatever
+// order the programs finish in. Pass a NULL report to print nothing. Returns the status of the
+// first program in paths that failed, or 0.
+int compile_files(char **paths, unsigned int count, unsigned int jobs, FILE *report);
+
+// Appends path to the list of paths, or if path is a directory, every .lb or .LB file beneath it
+// in name order. The caller frees each path and the list.
+void collect_sources(const char *path, char ***paths, unsigned int *count);
+
+// True if path names a directory
+bool is_directory(const char *path);
+
+// Monotonic wall clock time in milliseconds, for timing compiles
+double now_ms(void);
+
+#endif // DRIVER_H
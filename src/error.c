@@ -9,32 +9,147 @@
 #include <stdlib.h>
 #include <string.h>
 
+// NULL means stdout, which is not a constant expression
+static _Thread_local FILE *diag_out           = NULL;
+static _Thread_local error_trap_t *error_trap = NULL;
+
+trace_level_t trace_levels[NUM_TRACE_CATEGORIES] = {TRACE_OFF};
+unsigned int error_limit                         = DEFAULT_ERROR_LIMIT;
+
+static const char *const trace_categories[NUM_TRACE_CATEGORIES] = {
+    [TRACE_LEXER]     = "lexer",
+    [TRACE_PARSER]    = "parser",
+    [TRACE_SYMTAB]    = "symtab",
+    [TRACE_TYPECHECK] = "typecheck",
+};
+
 void log_error(const char *format, ...) {
-    printf("[ERROR]: ");
+    diag_printf("[ERROR]: ");
+
+    va_list args;
+    va_start(args, format);
+
+    vfprintf(diag_stream(), format, args);
+
+    va_end(args);
+
+    diag_printf("\n");
+
+    error_exit(EXIT_GENERIC_ERROR);
+}
+
+void trace_message(trace_category_t category, const char *format, ...) {
+    diag_printf("[%s]: ", trace_categories[category]);
 
     va_list args;
     va_start(args, format);
 
-    vprintf(format, args);
+    vfprintf(diag_stream(), format, args);
 
     va_end(args);
 
-    printf("\n");
+    diag_printf("\n");
+}
 
-    exit(EXIT_GENERIC_ERROR);
+// Finds the category or level named by the len bytes at name. Levels may also be given as a digit.
+static int trace_lookup(const char *const *names, int count, const char *name, size_t len) {
+    for (int idx = 0; idx < count; idx++) {
+        if ((strlen(names[idx]) == len) && (strncmp(names[idx], name, len) == 0)) {
+            return idx;
+        }
+    }
+
+    return -1;
 }
 
-void debug(const char *format, ...) {
-#if defined(DEBUG)
-    printf("[DEBUG]: ");
+bool trace_configure(const char *spec) {
+    static const char *const levels[] = {"off", "info", "debug", "verbose"};
+    static const char *const digits[] = {"0", "1", "2", "3"};
+    const int num_levels              = sizeof(levels) / sizeof(levels[0]);
+
+    trace_level_t configured[NUM_TRACE_CATEGORIES];
+    memcpy(configured, trace_levels, sizeof(configured));
+
+    if (spec == NULL) {
+        return true;
+    }
+
+    while (*spec != '\0') {
+        const size_t item_len = strcspn(spec, ",");
+        const char *equals    = memchr(spec, '=', item_len);
+        const size_t name_len = (equals != NULL) ? (size_t)(equals - spec) : item_len;
 
+        // A category named without a level is traced at TRACE_DEBUG
+        int level = TRACE_DEBUG;
+        if (equals != NULL) {
+            const size_t level_len = item_len - name_len - 1;
+
+            level = trace_lookup(levels, num_levels, equals + 1, level_len);
+            if (level < 0) {
+                level = trace_lookup(digits, num_levels, equals + 1, level_len);
+            }
+        }
+
+        if (level < 0) {
+            return false;
+        }
+
+        if ((name_len == strlen("all")) && (strncmp(spec, "all", name_len) == 0)) {
+            for (int idx = 0; idx < NUM_TRACE_CATEGORIES; idx++) {
+                configured[idx] = (trace_level_t)level;
+            }
+        } else if (name_len > 0) {
+            const int category =
+                trace_lookup(trace_categories, NUM_TRACE_CATEGORIES, spec, name_len);
+            if (category < 0) {
+                return false;
+            }
+
+            configured[category] = (trace_level_t)level;
+        }
+
+        spec += item_len;
+        if (*spec == ',') {
+            spec++;
+        }
+    }
+
+    memcpy(trace_levels, configured, sizeof(configured));
+
+    return true;
+}
+
+int diag_printf(const char *format, ...) {
     va_list args;
     va_start(args, format);
 
-    vprintf(format, args);
+    const int retval = vfprintf(diag_stream(), format, args);
 
     va_end(args);
 
-    printf("\n");
-#endif
+    return retval;
+}
+
+FILE *diag_stream(void) { return (diag_out != NULL) ? diag_out : stdout; }
+
+void diag_redirect(FILE *stream) { diag_out = stream; }
+
+void error_exit(int status) {
+    if (error_trap != NULL) {
+        error_trap->status = status;
+        longjmp(error_trap->env, 1);
+    }
+
+    exit(status);
+}
+
+void error_set_trap(error_trap_t *trap) { error_trap = trap; }
+
+void error_count(unsigned int *count, int status) {
+    (*count)++;
+
+    if ((error_limit > 0) && (*count >= error_limit)) {
+        diag_printf("Stopping after %u errors\n", *count);
+        error_exit(status);
+    }
 }
@@ -7,7 +7,10 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <setjmp.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
 
 // 2 pages worth of debug message buffer
 #define MAX_DEBUG_LEN 4096 * 2
@@ -23,7 +26,89 @@ enum exit_error_types {
     TYPE_ERROR
 };
 
-void log_error(const char *format, ...);
-void debug(const char *format, ...);
+_Noreturn void log_error(const char *format, ...);
+
+/* Diagnostics
+ *
+ *  Everything the compiler prints about a program goes through diag_printf(), to stdout unless
+ *  the calling thread has redirected it. Each thread has its own stream, so programs compiled on
+ *  different threads do not interleave their messages. */
+int diag_printf(const char *format, ...);
+FILE *diag_stream(void);
+void diag_redirect(FILE *stream);
+
+/* Tracing
+ *
+ *  Messages about what the compiler is doing, each in a category and at a level. A category is
+ *  traced up to its own level and none are traced by default. trace_configure() takes a list such
+ *  as "symtab,parser=verbose" or "all=1"; main() passes it the LBASIC_TRACE environment variable
+ *  and any --trace flag.
+ *
+ *  trace() and debug() check the category's level before anything is formatted, and without DEBUG
+ *  they compile to nothing at all. Set the levels before starting any threads. */
+typedef enum trace_category_e {
+    TRACE_LEXER,
+    TRACE_PARSER,
+    TRACE_SYMTAB,
+    TRACE_TYPECHECK,
+    NUM_TRACE_CATEGORIES
+} trace_category_t;
+
+typedef enum trace_level_e {
+    TRACE_OFF,
+    TRACE_INFO,    // Once or so per program
+    TRACE_DEBUG,   // Once or so per declaration or scope
+    TRACE_VERBOSE, // Every token, lookup and table dump
+} trace_level_t;
+
+extern trace_level_t trace_levels[NUM_TRACE_CATEGORIES];
+
+#if defined(DEBUG)
+#define trace_enabled(category, level) (trace_levels[(category)] >= (level))
+#else
+#define trace_enabled(category, level) false
+#endif
+
+#define trace(category, level, ...)                                                                \
+    do {                                                                                           \
+        if (trace_enabled(category, level)) {                                                      \
+            trace_message(category, __VA_ARGS__);                                                  \
+        }                                                                                          \
+    } while (0)
+
+#define debug(category, ...) trace(category, TRACE_DEBUG, __VA_ARGS__)
+
+// Prints one trace message whatever the levels are set to. Use trace() instead.
+void trace_message(trace_category_t category, const char *format, ...);
+
+// Sets the levels from spec, leaving categories it does not name as they are. Returns false, and
+// changes nothing, if spec is malformed.
+bool trace_configure(const char *spec);
+
+/* Error Traps
+ *
+ *  A compile error ends the process with its exit status, unless the calling thread has set a
+ *  trap. Then error_exit() records the status in the trap and jumps back to it instead, so that
+ *  setjmp(trap->env) returns non-zero. Pass NULL to error_set_trap() to remove the trap. */
+typedef struct error_trap_s {
+    jmp_buf env;
+    int status;
+} error_trap_t;
+
+_Noreturn void error_exit(int status);
+void error_set_trap(error_trap_t *trap);
+
+/* Error Limit
+ *
+ *  The parser and the typechecker carry on past an error, so that one compile reports every
+ *  independent error in a program. Once a program has error_limit errors the compile stops there
+ *  instead; 0 means no limit. main() sets it from any --max-errors flag, before starting any
+ *  threads. */
+#define DEFAULT_ERROR_LIMIT 20
+
+extern unsigned int error_limit;
+
+// Counts one more error in *count, and ends the compile with status once there are error_limit
+void error_count(unsigned int *count, int status);
 
 #endif // ERROR_H
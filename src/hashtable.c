@@ -7,120 +7,173 @@
 
 #include "error.h"
 
+// Grow once more than 7 in 10 slots are in use, so probe sequences stay short
+#define HT_MAX_LOAD_NUM 7
+#define HT_MAX_LOAD_DEN 10
+
 // Allocate a new hash table
 hashtable *ht_new() {
     hashtable *retval = NULL;
 
     retval = (hashtable *)calloc(1, sizeof(hashtable));
 
+    if (retval != NULL) {
+        retval->slots = (ht_entry_t *)calloc(HT_INITIAL_CAPACITY, sizeof(ht_entry_t));
+
+        if (retval->slots == NULL) {
+            free(retval);
+            return NULL;
+        }
+
+        retval->capacity = HT_INITIAL_CAPACITY;
+    }
+
     return retval;
 }
 
 void ht_free(hashtable **ht) {
     if (ht != NULL && *ht != NULL) {
-        for (int slot = 0; slot < MAX_SLOTS; slot++) {
-            if ((*ht)->slots[slot] != NULL) {
-                vector_free(&(*ht)->slots[slot]);
-            }
+        for (unsigned int slot = 0; slot < (*ht)->capacity; slot++) {
+            free((*ht)->slots[slot].data);
         }
+
+        free((*ht)->slots);
         free(*ht);
         *ht = NULL;
     }
 }
 
-// FNV-1a hash algorithm from https://craftinginterpreters.com/hash-tables.html
-static uint32_t ht_hash_FNV_1a(void *key) {
-    const char *const charkey = (char *)key;
+// Places entry in the first empty slot of its probe sequence
+static void ht_place(ht_entry_t *slots, unsigned int capacity, const ht_entry_t *entry) {
+    unsigned int slot = entry->hash & (capacity - 1);
+
+    while (slots[slot].data != NULL) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+
+    slots[slot] = *entry;
+}
 
-    const size_t length = strlen(charkey);
+// Doubles the number of slots and re-places every element using its stored hash. Elements with
+// the same key keep their order, since they are re-placed in the order of their probe sequence.
+static void ht_grow(hashtable *ht) {
+    const unsigned int new_capacity = ht->capacity * 2;
+    ht_entry_t *new_slots           = (ht_entry_t *)calloc(new_capacity, sizeof(ht_entry_t));
 
-    // debug("Length: %d", length);
+    if (new_slots == NULL) {
+        log_error("Unable to grow hashtable to %u slots", new_capacity);
+    }
 
-    uint32_t hash = 2166136261U;
-    for (int i = 0; i < length; i++) {
-        hash ^= (uint8_t)charkey[i];
-        hash *= 16777619;
+    // Start just after an empty slot, so that no probe sequence is visited out of order
+    unsigned int start = 0;
+    while (ht->slots[start].data != NULL) {
+        start++;
     }
 
-    // debug("Hash: %lu", hash);
+    for (unsigned int idx = 1; idx <= ht->capacity; idx++) {
+        const ht_entry_t *entry = &ht->slots[(start + idx) & (ht->capacity - 1)];
 
-    return hash;
+        if (entry->data != NULL) {
+            ht_place(new_slots, new_capacity, entry);
+        }
+    }
+
+    free(ht->slots);
+    ht->slots    = new_slots;
+    ht->capacity = new_capacity;
 }
 
 // Insert an element
-void ht_insert(hashtable *ht, void *key, void *data) {
+void ht_insert(hashtable *ht, uint32_t key, uint32_t hash, void *data) {
     if (ht != NULL) {
-        if (key != NULL) {
-            if (data != NULL) {
-                const unsigned int index = ht_hash_FNV_1a(key) % MAX_SLOTS;
-                // printf("INDEX INSERT: %u (key=%s)\n", index, (char *)key);
-
-                if (ht->slots[index] == NULL) {
-                    ht->slots[index] = mk_vector();
-                    if (ht->slots[index] != NULL) {
-                        vector_add(ht->slots[index], data);
-                        ht->num_values++;
-                    } else {
-                        log_error("Unable to create vector for hashtable insertion at index: %d",
-                                  index);
-                    }
-                } else {
-                    // Hash index collision, so append to vector (buckets 'n chaining)
-                    vector_add(ht->slots[index], data);
-                    ht->num_values++;
-                }
-            } else {
-                log_error("Unable to access data for insertion");
+        if (data != NULL) {
+            const ht_entry_t entry = {.data = data, .key = key, .hash = hash};
+
+            if ((ht->num_values + 1) * HT_MAX_LOAD_DEN > ht->capacity * HT_MAX_LOAD_NUM) {
+                ht_grow(ht);
             }
+
+            ht_place(ht->slots, ht->capacity, &entry);
+            ht->num_values++;
         } else {
-            log_error("Unable to access key for insertion");
+            log_error("Unable to access data for insertion");
         }
     } else {
         log_error("Unable to access hashtable for insertion");
     }
 }
 
+// Returns the slot holding the earliest inserted element with key, or -1 if there is none
+static long ht_find(const hashtable *ht, uint32_t key, uint32_t hash) {
+    unsigned int slot = hash & (ht->capacity - 1);
+
+    // Linear probing. The stored hash rules out most other keys before their key is compared. An
+    // element is only ever returned for its own key, however few elements share its slot.
+    while (ht->slots[slot].data != NULL) {
+        if (ht->slots[slot].hash == hash && ht->slots[slot].key == key) {
+            return slot;
+        }
+
+        slot = (slot + 1) & (ht->capacity - 1);
+    }
+
+    return -1;
+}
+
 // Lookup an element
-void *ht_lookup(hashtable *ht, void *key, bool (*ht_compare)(vecnode *vn, void *key)) {
+void *ht_lookup(hashtable *ht, uint32_t key, uint32_t hash) {
+    void *retval = NULL;
+
+    if (ht != NULL) {
+        const long slot = ht_find(ht, key, hash);
+
+        if (slot >= 0) {
+            retval = ht->slots[slot].data;
+        }
+    } else {
+        log_error("Unable to access hashtable for lookup");
+    }
+
+    return retval;
+}
+
+// Remove an element
+//
+// Rather than leaving a marker behind, the elements after the hole that probed past it are moved
+// back into it, so lookups never have to step over removed slots.
+void *ht_remove(hashtable *ht, uint32_t key, uint32_t hash) {
     void *retval = NULL;
 
     if (ht != NULL) {
-        if (key != NULL) {
-            const unsigned int index = ht_hash_FNV_1a(key) % MAX_SLOTS;
-            // debug("INDEX LOOKUP: %u", index);
-
-            vector *slot_ptr = ht->slots[index];
-            if (slot_ptr != NULL) {
-                if (slot_ptr->count == 1) {
-                    // printf("here!\n");
-                    vecnode *vn = slot_ptr->head;
-                    if (vn != NULL) {
-                        retval = vn->data;
-                    } else {
-                        log_error("Unable to access vecnode at vector head for lookup");
-                    }
-                } else {
-                    // Need to check each node in the vector for a match
-                    vecnode *vn = slot_ptr->head;
-                    if (vn != NULL) {
-                        while (vn != NULL) {
-                            // Use comparison callback to become generic
-                            if ((*ht_compare)(vn, key)) {
-                                retval = vn->data;
-                                break;
-                            }
-                            vn = vn->next;
-                        }
-                    }
+        const long found = ht_find(ht, key, hash);
+
+        if (found >= 0) {
+            const unsigned int mask = ht->capacity - 1;
+            unsigned int hole       = (unsigned int)found;
+            unsigned int slot       = hole;
+
+            retval = ht->slots[hole].data;
+
+            for (;;) {
+                slot = (slot + 1) & mask;
+                if (ht->slots[slot].data == NULL) {
+                    break;
+                }
+
+                // An element may fill the hole if the hole lies between its home slot and where it
+                // is now, i.e. it is at least as far from home as from the hole
+                const unsigned int home = ht->slots[slot].hash & mask;
+                if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                    ht->slots[hole] = ht->slots[slot];
+                    hole            = slot;
                 }
-            } else {
-                // debug("Vector does not exist at index %d\n", index);
             }
-        } else {
-            log_error("Unable to access key for lookup");
+
+            ht->slots[hole].data = NULL;
+            ht->num_values--;
         }
     } else {
-        log_error("Unable to access hashtable for lookup");
+        log_error("Unable to access hashtable for removal");
     }
 
     return retval;
@@ -128,24 +181,13 @@ void *ht_lookup(hashtable *ht, void *key, bool (*ht_compare)(vecnode *vn, void *
 
 void ht_print(hashtable *ht) {
     if (NULL != ht) {
-        for (int slot = 0; slot < MAX_SLOTS; slot++) {
-            if (NULL == ht->slots[slot]) {
-                printf("Slot %d empty.\n", slot);
+        for (unsigned int slot = 0; slot < ht->capacity; slot++) {
+            if (NULL == ht->slots[slot].data) {
+                diag_printf("Slot %u empty.\n", slot);
             } else {
-                printf("Slot %d\t\tData: ", slot);
-                // Walk the linked list
-                vecnode *vn = ht->slots[slot]->head;
-                while (NULL != vn) {
-                    if (NULL != vn->data) {
-                        printf("%s -> ", (char *)vn->data);
-                    }
-                    vn = vn->next;
-                }
-                printf("NULL\n");
+                diag_printf("Slot %u\t\tKey: %u\tData: %s\n", slot, ht->slots[slot].key,
+                            (char *)ht->slots[slot].data);
             }
         }
     }
 }
-
-// Remove an element
-// void ht_remove(hashtable *ht, void *key);
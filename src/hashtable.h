@@ -7,33 +7,46 @@
 #ifndef HASHTABLE_H
 #define HASHTABLE_H
 
-#include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
-#define MAX_SLOTS 1024
+#define HT_INITIAL_CAPACITY 8
+
+// One slot of a hash table
+typedef struct ht_entry_s {
+    void *data;    // NULL where the slot is empty
+    uint32_t key;
+    uint32_t hash; // Stored so that growing the table never needs the key hashed again
+} ht_entry_t;
 
 typedef struct hashtable {
-    vector *slots[MAX_SLOTS];
-    int num_values; // The sum of all elements within the table
+    ht_entry_t *slots;     // Open addressing with linear probing
+    unsigned int capacity; // Always a power of two
+    int num_values;        // The sum of all elements within the table
 } hashtable;
 
-/* Hash Table */
+/* Hash Table
+ *
+ *  Keys are integer ids whose hash the caller already has, such as those of interned strings
+ *  (see strtab.h), so nothing is hashed or compared byte by byte here. The table starts with
+ *  HT_INITIAL_CAPACITY slots and doubles whenever it becomes more than 70% full. */
 // Allocate a new hash table
 hashtable *ht_new(void);
 
-// Free a hash table
+// Free a hash table, along with the data of each of its elements
 void ht_free(hashtable **ht);
 
-// Insert an element
-void ht_insert(hashtable *ht, void *key, void *data);
+// Insert an element. A key may be inserted more than once; lookups find the earliest insertion
+// that has not been removed.
+void ht_insert(hashtable *ht, uint32_t key, uint32_t hash, void *data);
 
-// Lookup an element
-void *ht_lookup(hashtable *ht, void *key, bool (*ht_compare)(vecnode *vn, void *key));
+// Lookup an element. Returns NULL if there is none with key.
+void *ht_lookup(hashtable *ht, uint32_t key, uint32_t hash);
 
-// Remove an element
-void ht_remove(hashtable *ht, void *key);
+// Remove an element and return its data, which the caller frees, or NULL if there is none with key
+void *ht_remove(hashtable *ht, uint32_t key, uint32_t hash);
 
 // Print all elements in the table
 void ht_print(hashtable *ht);
 
-#endif
\ No newline at end of file
+#endif
@@ -4,7 +4,6 @@
  * Author: Liam M. Murphy
  */
 
-#include <ctype.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,8 +11,9 @@
 
 #include "error.h"
 #include "lexer.h"
+#include "scan.h"
+#include "source.h"
 #include "token.h"
-#include "vector.h"
 
 #define N_KEYWORDS 21
 #define MAX_KEYWORD_LEN 20
@@ -21,500 +21,535 @@
 #define REQUIRED_FILE_EXT_UC ".LB"
 
 // Prototypes
-static char *input_file(const char *path);
-static void emit_token(t_list *lst, token_type type, const char *literal);
-static void tokenize(char *prog_buff);
-static bool check_singles(char c);
-static bool is_keyword(char *lexeme, token_type *type);
-
-// Globals
-t_list *token_list;
-vector *line_map;
-static int char_num = -1;
-static int line_num = 1;
-static int col_num  = 1;
+static void emit_token(lexer_t *lexer, token_type type, int start, int length);
+static void intern_token(lexer_t *lexer);
+static void tokenize(lexer_t *lexer, const char *prog_buff);
+static bool is_keyword(const char *lexeme, size_t len, token_type *type);
+
+/* Character classes
+ *
+ *  Every byte of the program is mapped to one of these before being looked up in the transition
+ *  table. Bytes that are not part of the language (including everything above 0x7f) are
+ *  CC_OTHER, which is only valid inside identifiers, string literals and comments. */
+typedef enum {
+    CC_OTHER      = 0,
+    CC_NUL        = 1,  // End of the program buffer
+    CC_SPACE      = 2,  // ' ', which also ends an identifier
+    CC_BLANK      = 3,  // '\t' and '\r', which do not
+    CC_NEWLINE    = 4,  // '\n'
+    CC_ALPHA      = 5,  // [a-zA-Z]
+    CC_DIGIT      = 6,  // [0-9]
+    CC_DOT        = 7,  // .
+    CC_DELIM      = 8,  // ( ) [ ] { } ; ,
+    CC_OPERATOR   = 9,  // + * / %
+    CC_COLON      = 10, // :
+    CC_EQUALS     = 11, // =
+    CC_LT         = 12, // <
+    CC_GT         = 13, // >
+    CC_BANG       = 14, // !
+    CC_MINUS      = 15, // -
+    CC_QUOTE      = 16, // "
+    CC_APOSTROPHE = 17, // ' (comment)
+    CC_BACKSLASH  = 18, // \ (escape within a string literal)
+    NUM_CHAR_CLASSES
+} char_class_t;
+
+// Lexer states. Each one is where the lexer is within a token when it reads the next character.
+typedef enum {
+    S_START        = 0,  // Between tokens
+    S_IDENT        = 1,  // Within an identifier or keyword
+    S_IDENT_COLON  = 2,  // Read the ':' that ended an identifier
+    S_INTEGER      = 3,  // Within the digits of a number
+    S_FRACTION_DOT = 4,  // Read the '.' of a float, which must be followed by a digit
+    S_FRACTION     = 5,  // Within the digits after the '.' of a float
+    S_STRING       = 6,  // Within a string literal
+    S_ESCAPE       = 7,  // Read a '\' within a string literal
+    S_COMMENT      = 8,  // Within a comment, up to the end of the line
+    S_COLON        = 9,  // Read a ':'
+    S_EQUALS       = 10, // Read a '='
+    S_LT           = 11, // Read a '<'
+    S_GT           = 12, // Read a '>'
+    S_BANG         = 13, // Read a '!'
+    S_MINUS        = 14, // Read a '-'
+    NUM_LEXER_STATES
+} lexer_state_t;
+
+// What the lexer does on a transition, before moving to the next state
+typedef enum {
+    A_NONE         = 0,  // Nothing
+    A_COUNT        = 1,  // Advance the column
+    A_NEWLINE      = 2,  // Move to the start of the next line
+    A_BEGIN_WORD   = 3,  // Start an identifier or number at this character and advance the column
+    A_BEGIN_STRING = 4,  // Start a string literal at the next character
+    A_BEGIN_NEG    = 5,  // Start a number at the preceding '-', advancing the column for both
+    A_SINGLE       = 6,  // Emit the single character token for this character
+    A_OP1          = 7,  // Emit the transition's token for the preceding character
+    A_COUNT_OP1    = 8,  // Same as A_OP1, after advancing the column
+    A_OP2          = 9,  // Emit the transition's token for the preceding and this character
+    A_COUNT_OP2    = 10, // Same as A_OP2, after advancing the column
+    A_IDENT        = 11, // Advance the column, then emit the identifier or keyword ending here
+    A_INTEGER      = 12, // Emit the integer literal ending here
+    A_FLOAT        = 13, // Emit the float literal ending here
+    A_STRING       = 14, // Emit the string literal ending here
+    A_EOF          = 15, // Emit the end of file token and stop
+    A_UNKNOWN      = 16, // Report this character as unknown
+    A_UNKNOWN_PREV = 17, // Report the preceding character as unknown
+    A_UNTERMINATED = 18, // Report an unterminated string literal
+    A_BLANKS       = 19, // Skip this and any following blanks, advancing the column for each
+    A_BEGIN_IDENT  = 20, // Start an identifier here and skip to the byte that ends it
+    A_COMMENT      = 21, // Skip to the end of the line, advancing the column for each byte
+    A_STRING_RUN   = 22, // Skip to the next quote or backslash within a string literal
+} lexer_action_t;
+
+typedef struct {
+    unsigned char next;      // lexer_state_t to move to
+    unsigned char action;    // lexer_action_t to perform first
+    unsigned char token;     // token_type emitted by A_OP1, A_OP2 and friends
+    unsigned char reprocess; // Read the same character again in the next state
+} transition_t;
+
+// Transition helpers. AGAIN transitions do not consume the character.
+#define GO(state, action) {(state), (action), 0, false}
+#define EMIT(state, action, tok) {(state), (action), (tok), false}
+#define AGAIN(state, action, tok) {(state), (action), (tok), true}
+
+// Fills every entry of a transition table row, before the entries that differ are listed
+#define ALL_CLASSES [0 ... NUM_CHAR_CLASSES - 1]
+
+static const unsigned char char_class[256] = {
+    ['\0'] = CC_NUL, [' '] = CC_SPACE, ['\t'] = CC_BLANK, ['\r'] = CC_BLANK, ['\n'] = CC_NEWLINE,
+    ['a' ... 'z'] = CC_ALPHA, ['A' ... 'Z'] = CC_ALPHA, ['0' ... '9'] = CC_DIGIT, ['.'] = CC_DOT,
+    ['('] = CC_DELIM, [')'] = CC_DELIM, ['['] = CC_DELIM, [']'] = CC_DELIM, ['{'] = CC_DELIM,
+    ['}'] = CC_DELIM, [';'] = CC_DELIM, [','] = CC_DELIM, ['+'] = CC_OPERATOR, ['*'] = CC_OPERATOR,
+    ['/'] = CC_OPERATOR, ['%'] = CC_OPERATOR, [':'] = CC_COLON, ['='] = CC_EQUALS, ['<'] = CC_LT,
+    ['>'] = CC_GT, ['!'] = CC_BANG, ['-'] = CC_MINUS, ['"'] = CC_QUOTE, ['\''] = CC_APOSTROPHE,
+    ['\\'] = CC_BACKSLASH};
+
+// Token emitted by A_SINGLE for each character it applies to
+static const unsigned char single_tokens[256] = {
+    ['('] = T_LPAREN, [')'] = T_RPAREN, ['['] = T_LBRACKET, [']'] = T_RBRACKET, ['{'] = T_LBRACE,
+    ['}'] = T_RBRACE, [';'] = T_SEMICOLON, [','] = T_COMMA, ['.'] = T_DOT, ['+'] = T_PLUS,
+    ['*'] = T_MUL, ['/'] = T_DIV, ['%'] = T_MOD};
+
+/* Transition table, indexed by state and then character class.
+ *
+ *  Column numbers follow the rules the lexer has always had: whitespace and the characters of
+ *  identifiers and numbers advance the column, while single character tokens and string literals
+ *  do not. Identifiers end at a space, newline or delimiter and may otherwise contain anything,
+ *  and a lone ':' swallows the character after it. */
+static const transition_t transitions[NUM_LEXER_STATES][NUM_CHAR_CLASSES] = {
+    [S_START] =
+        {
+            [CC_OTHER]      = GO(S_START, A_UNKNOWN),
+            [CC_NUL]        = GO(S_START, A_EOF),
+            [CC_SPACE]      = GO(S_START, A_BLANKS),
+            [CC_BLANK]      = GO(S_START, A_BLANKS),
+            [CC_NEWLINE]    = GO(S_START, A_NEWLINE),
+            [CC_ALPHA]      = GO(S_IDENT, A_BEGIN_IDENT),
+            [CC_DIGIT]      = GO(S_INTEGER, A_BEGIN_WORD),
+            [CC_DOT]        = GO(S_START, A_SINGLE),
+            [CC_DELIM]      = GO(S_START, A_SINGLE),
+            [CC_OPERATOR]   = GO(S_START, A_SINGLE),
+            [CC_COLON]      = GO(S_COLON, A_NONE),
+            [CC_EQUALS]     = GO(S_EQUALS, A_NONE),
+            [CC_LT]         = GO(S_LT, A_NONE),
+            [CC_GT]         = GO(S_GT, A_NONE),
+            [CC_BANG]       = GO(S_BANG, A_NONE),
+            [CC_MINUS]      = GO(S_MINUS, A_NONE),
+            [CC_QUOTE]      = GO(S_STRING, A_BEGIN_STRING),
+            [CC_APOSTROPHE] = GO(S_COMMENT, A_COMMENT),
+            [CC_BACKSLASH]  = GO(S_START, A_UNKNOWN),
+        },
+    [S_IDENT] =
+        {
+            ALL_CLASSES     = GO(S_IDENT, A_COUNT),
+            [CC_NUL]        = AGAIN(S_START, A_IDENT, 0),
+            [CC_SPACE]      = GO(S_START, A_IDENT),
+            [CC_NEWLINE]    = AGAIN(S_START, A_IDENT, 0),
+            [CC_DOT]        = AGAIN(S_START, A_IDENT, 0),
+            [CC_DELIM]      = AGAIN(S_START, A_IDENT, 0),
+            [CC_COLON]      = GO(S_IDENT_COLON, A_IDENT),
+        },
+    [S_IDENT_COLON] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_COUNT_OP1, T_COLON),
+            [CC_EQUALS]     = EMIT(S_START, A_COUNT_OP2, T_ASSIGN),
+        },
+    [S_INTEGER] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_INTEGER, 0),
+            [CC_DIGIT]      = GO(S_INTEGER, A_COUNT),
+            [CC_DOT]        = GO(S_FRACTION_DOT, A_COUNT),
+        },
+    [S_FRACTION_DOT] =
+        {
+            ALL_CLASSES     = GO(S_START, A_UNKNOWN),
+            [CC_DIGIT]      = GO(S_FRACTION, A_COUNT),
+        },
+    [S_FRACTION] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_FLOAT, 0),
+            [CC_DIGIT]      = GO(S_FRACTION, A_COUNT),
+        },
+    [S_STRING] =
+        {
+            ALL_CLASSES     = GO(S_STRING, A_NONE),
+            [CC_NUL]        = GO(S_START, A_UNTERMINATED),
+            [CC_QUOTE]      = GO(S_START, A_STRING),
+            [CC_BACKSLASH]  = GO(S_ESCAPE, A_NONE),
+        },
+    [S_ESCAPE] =
+        {
+            ALL_CLASSES     = GO(S_STRING, A_STRING_RUN),
+            [CC_NUL]        = GO(S_START, A_UNTERMINATED),
+        },
+    [S_COMMENT] =
+        {
+            ALL_CLASSES     = GO(S_COMMENT, A_COUNT),
+            [CC_NUL]        = AGAIN(S_START, A_COUNT, 0),
+            [CC_NEWLINE]    = GO(S_START, A_NEWLINE),
+        },
+    [S_COLON] =
+        {
+            ALL_CLASSES     = GO(S_START, A_NONE),
+            [CC_NUL]        = AGAIN(S_START, A_NONE, 0),
+            [CC_EQUALS]     = EMIT(S_START, A_OP2, T_ASSIGN),
+        },
+    [S_EQUALS] =
+        {
+            ALL_CLASSES     = GO(S_START, A_UNKNOWN_PREV),
+            [CC_EQUALS]     = EMIT(S_START, A_COUNT_OP2, T_EQ),
+        },
+    [S_LT] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_OP1, T_LT),
+            [CC_EQUALS]     = EMIT(S_START, A_COUNT_OP2, T_LE),
+        },
+    [S_GT] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_OP1, T_GT),
+            [CC_EQUALS]     = EMIT(S_START, A_COUNT_OP2, T_GE),
+        },
+    [S_BANG] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_OP1, T_BANG),
+            [CC_EQUALS]     = EMIT(S_START, A_COUNT_OP2, T_NE),
+        },
+    [S_MINUS] =
+        {
+            ALL_CLASSES     = AGAIN(S_START, A_OP1, T_MINUS),
+            [CC_DIGIT]      = GO(S_INTEGER, A_BEGIN_NEG),
+            [CC_GT]         = EMIT(S_START, A_COUNT_OP2, T_OFTYPE),
+        },
+};
 
 // Elements must remain in this order
 static char keywords[N_KEYWORDS][MAX_KEYWORD_LEN] = {
     "and", "or",   "func",   "for",   "while", "to",   "end", "struct", "true", "false", "nil",
     "int", "bool", "string", "float", "void",  "goto", "if",  "then",   "else", "return"};
 
-void split_into_lines(const char *path) {
-    line_map = mk_vector();
-
-    if (line_map == NULL) {
-        log_error("Unable to allocate a line_map vector");
-    }
-
-    FILE *fp = fopen(path, "r");
-    if (fp != NULL) {
+// See lexer.h
+t_array *lex(lexer_t *lexer, const char *path, strtab_t *names) {
+    // Regular files are mapped rather than copied, so the lexer reads straight from the page cache
+    return lex_source(lexer, lex_open(path), names);
+}
 
-        char line_buff[MAX_LINE] = {'\0'};
-        while (fgets(line_buff, MAX_LINE, fp) != NULL) {
-            line_t *newline = (line_t *)malloc(sizeof(line_t));
-            memset(newline, 0, sizeof(*newline));
+t_array *lex_source(lexer_t *lexer, source_t *source, strtab_t *names) {
+    // Start from the top of the new file
+    lexer->char_num = -1;
+    lexer->line_num = 1;
+    lexer->col_num  = 1;
+    lexer->names    = names;
 
-            snprintf(newline->text, sizeof(newline->text), "%s", line_buff);
-            vector_add(line_map, newline);
-        }
+    // The token array takes ownership of the source, since tokens point into it
+    lexer->tokens = t_array_new(source);
 
-        fclose(fp);
+    if (lexer->tokens == NULL) {
+        log_error("Unable to allocate memory for token array");
     }
 
-    debug("Lines:");
+    lexer->tokens->names = names;
 
-    vecnode *ln = line_map->head;
-    int i       = 1;
-    while (ln != NULL) {
-        line_t *line = (line_t *)ln->data;
-        debug("%3d. %s", i, line->text);
-        i++;
+    tokenize(lexer, source->buffer);
 
-        ln = ln->next;
-    }
+    return lexer->tokens;
 }
 
-// See lexer.h
-t_list *lex(const char *path) {
-    char *prog_buff = input_file(path);
-
-    if (prog_buff != NULL) {
-        split_into_lines(path);
-        debug("=================================\n");
-
-        token_list = t_list_new();
-
-        if (token_list == NULL) {
-            log_error("Unable to allocate memory for token_list");
-        }
+bool has_source_extension(const char *path) {
+    const size_t len = strlen(path);
 
-        tokenize(prog_buff);
+    if (len < strlen(REQUIRED_FILE_EXT_LC)) {
+        return false;
     }
 
-    if (prog_buff != NULL) {
-        free(prog_buff);
-    }
+    // If path is "testfile.lb", we are pointing to the "."
+    const char *extension = path + len - strlen(REQUIRED_FILE_EXT_LC);
 
-    return token_list;
+    return (strcmp(extension, REQUIRED_FILE_EXT_LC) == 0) ||
+           (strcmp(extension, REQUIRED_FILE_EXT_UC) == 0);
 }
 
-// Takes a file path and returns a buffer containing the contents of the file at path
-static char *input_file(const char *path) {
-    char extension[4] = {'\0'};
-
-    // If path is "testfile.lb", we are pointing to the "."
-    strncpy(extension, &path[strlen(path) - 3], 3);
-    extension[4] = '\0';
-
-    if ((strcmp(extension, REQUIRED_FILE_EXT_LC) != 0) &&
-        (strcmp(extension, REQUIRED_FILE_EXT_UC) != 0)) {
+source_t *lex_open(const char *path) {
+    if ((strcmp(path, SOURCE_STDIN_PATH) != 0) && !has_source_extension(path)) {
         log_error("File name must end with '.lb' or '.LB'");
     }
 
-    FILE *fp     = fopen(path, "r");
-    char *buffer = NULL;
-
-    if (fp != NULL) {
-        // Get file size
-        fseek(fp, 0, SEEK_END);
-        const size_t file_size = ftell(fp);
-        debug("File size: %ld bytes", file_size);
-
-        // Seek back to the beginning of the file
-        rewind(fp);
-
-        // Allocate the buffer. Freed in lex()
-        buffer = (char *)malloc(file_size + 1);
-
-        if (buffer != NULL) {
-            // Copy the file contents into the buffer
-            fread(buffer, 1, file_size, fp);
-
-            // Append \0 to end of buffer
-            buffer[file_size] = '\0';
-        }
+    source_t *source = source_open(path);
 
-        fclose(fp);
+    if (source != NULL) {
+        trace(TRACE_LEXER, TRACE_INFO, "File size: %zu bytes", source->length);
     } else {
         log_error("Unable to open file for reading");
-        exit(LEXER_ERROR_BAD_FILE_POINTER);
+        error_exit(LEXER_ERROR_BAD_FILE_POINTER);
     }
 
-    return buffer;
+    return source;
 }
 
-// Appends a t_list struct to the doubly-linked list of tokens
-static void emit_token(t_list *lst, token_type type, const char *literal) {
-    t_list *new_tok = (t_list *)malloc(sizeof(t_list));
-    token *tok      = (token *)malloc(sizeof(token));
-
-    memset(tok->literal, 0, MAX_LITERAL);
-
-    tok->type = type;
-    tok->line = line_num;
-    tok->col  = col_num;
-    strncpy(tok->literal, literal, strlen(literal));
-
-    if (tok->type != T_EOF) {
-        // Get token's line from line_map
-        vecnode *vn = get_nth_node(line_map, line_num);
-        if (vn != NULL) {
-            line_t *line = (line_t *)vn->data;
+// Appends a token to the token array. The token's lexeme is the span of length bytes beginning at
+// index start of the program buffer.
+static void emit_token(lexer_t *lexer, token_type type, int start, int length) {
+    t_array *arr    = lexer->tokens;
+    const token tok = {.type   = type,
+                       .offset = start,
+                       .length = length,
+                       .line   = lexer->line_num,
+                       .col    = lexer->col_num};
+
+    // Only call out to grow the array when it is full
+    if (arr->count < arr->capacity) {
+        arr->toks[arr->count++] = tok;
+    } else {
+        t_array_append(arr, &tok);
+    }
+}
 
-            if (line != NULL) {
-                snprintf(tok->line_str, sizeof(tok->line_str), "%s", line->text);
-            }
-        }
+// Interns the text of the identifier or string literal just emitted and records its id in the
+// token. The text is what token_literal() or, for string literals, token_string_value() would copy
+// into a MAX_LITERAL buffer.
+static void intern_token(lexer_t *lexer) {
+    if (lexer->names == NULL) {
+        return;
     }
 
-    if (new_tok != NULL) {
-        if (tok != NULL) {
-            new_tok->tok = tok;
-            t_list_append(lst, new_tok);
-        } else {
-            log_error("Unable to create tok");
-        }
+    token *tok          = &lexer->tokens->toks[lexer->tokens->count - 1];
+    const char *name    = NULL;
+    const char *program = lexer->tokens->src->buffer;
+
+    if (tok->type == L_STR) {
+        char value[MAX_LITERAL];
+        token_string_value(lexer->tokens->src, tok, value, sizeof(value));
+        name = strtab_intern(lexer->names, value, strlen(value));
     } else {
-        log_error("Unable to create new_tok");
+        const size_t len = (tok->length < MAX_LITERAL - 1) ? tok->length : MAX_LITERAL - 1;
+        name             = strtab_intern(lexer->names, program + tok->offset, len);
     }
-}
 
-static bool check_singles(char c) {
-    bool retval = true;
+    tok->name = strtab_id(name);
+}
 
-    switch (c) {
-        case '(':
-            emit_token(token_list, T_LPAREN, "(");
-            break;
-        case ')':
-            emit_token(token_list, T_RPAREN, ")");
-            break;
-        case '[':
-            emit_token(token_list, T_LBRACKET, "[");
-            break;
-        case ']':
-            emit_token(token_list, T_RBRACKET, "]");
-            break;
-        case '{':
-            emit_token(token_list, T_LBRACE, "{");
-            break;
-        case '}':
-            emit_token(token_list, T_RBRACE, "}");
-            break;
-        case ';':
-            emit_token(token_list, T_SEMICOLON, ";");
-            break;
-        case '+':
-            emit_token(token_list, T_PLUS, "+");
-            break;
-        case '*':
-            emit_token(token_list, T_MUL, "*");
+/* Returns the index within keywords[] of the only keyword that could match the len bytes at lexeme,
+ * or -1 if there is none.
+ *
+ *  Keywords are told apart by their length and first character, and the second or fourth character
+ *  where two of them share both. The switch must be kept in step with keywords[]. */
+static int keyword_candidate(const char *lexeme, size_t len) {
+    switch (len) {
+        case 2:
+            switch (lexeme[0]) {
+                case 'o':
+                    return 1; // or
+                case 't':
+                    return 5; // to
+                case 'i':
+                    return 17; // if
+            }
             break;
-        case '/':
-            emit_token(token_list, T_DIV, "/");
+        case 3:
+            switch (lexeme[0]) {
+                case 'a':
+                    return 0; // and
+                case 'f':
+                    return 3; // for
+                case 'e':
+                    return 6; // end
+                case 'n':
+                    return 10; // nil
+                case 'i':
+                    return 11; // int
+            }
             break;
-        case '%':
-            emit_token(token_list, T_MOD, "%");
+        case 4:
+            switch (lexeme[0]) {
+                case 'f':
+                    return 2; // func
+                case 't':
+                    return (lexeme[1] == 'r') ? 8 : 18; // true, then
+                case 'b':
+                    return 12; // bool
+                case 'v':
+                    return 15; // void
+                case 'g':
+                    return 16; // goto
+                case 'e':
+                    return 19; // else
+            }
             break;
-        case ',':
-            emit_token(token_list, T_COMMA, ",");
+        case 5:
+            switch (lexeme[0]) {
+                case 'w':
+                    return 4; // while
+                case 'f':
+                    return (lexeme[1] == 'a') ? 9 : 14; // false, float
+            }
             break;
-        case '.':
-            emit_token(token_list, T_DOT, ".");
+        case 6:
+            switch (lexeme[0]) {
+                case 's':
+                    return (lexeme[3] == 'u') ? 7 : 13; // struct, string
+                case 'r':
+                    return 20; // return
+            }
             break;
-        // Intentional fallthrough
-        case '<':
-        case '>':
-        case '=':
-        case '!':
-        case ':':
-        case '-':
-        case '\'':
-        case '"':
-            return true;
-        default:
-            retval = false;
     }
 
-    return retval;
+    return -1;
 }
 
-static bool is_keyword(char *lexeme, token_type *type) {
-    int idx;
-    for (idx = 0; idx < N_KEYWORDS; idx++) {
-        if (strcmp(lexeme, keywords[idx]) == 0) {
-            *type = (idx + T_AND);
-            return true;
-        }
+// Checks whether the len bytes at lexeme are a keyword. lexeme is a span of the program buffer and
+// is not null-terminated.
+static bool is_keyword(const char *lexeme, size_t len, token_type *type) {
+    const int idx = keyword_candidate(lexeme, len);
+
+    // At most one keyword needs comparing
+    if ((idx >= 0) && (memcmp(lexeme, keywords[idx], len) == 0)) {
+        *type = (idx + T_AND);
+        return true;
     }
 
     return false;
 }
 
-static bool is_digit(char c) { return (c >= '0' && c <= '9'); }
-
-// Get the next char from the buffer
-static char get_char(char *prog_buff) {
-    char_num++;
-    return *(prog_buff + char_num);
-}
-
-// Decrement buffer index
-static void unget_char() { char_num--; }
-
-static void tokenize(char *prog_buff) {
-    char c = 0;
-    char lexeme[MAX_LITERAL];
-    token_type tmp;
-
-    memset(lexeme, 0, sizeof(lexeme));
-
-    c = get_char(prog_buff);
-    while (c != '\0') {
-        // Skip whitespace
-        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
-            col_num++;
-            if (c == '\n') {
-                line_num++;
-                col_num = 1;
-            }
-            c = get_char(prog_buff);
-            continue;
-        }
-
-        // Check single character tokens
-        if (check_singles(c)) {
-
-            // Beginning of string literal
-            if (c == '"') {
-                // Read until ending quote
-                c = get_char(prog_buff);
-                while (c != '"') {
-                    sprintf(lexeme, "%s%c", lexeme, c);
-                    c = get_char(prog_buff);
-                }
-                emit_token(token_list, L_STR, lexeme);
-
-                // Reset lexeme
-                memset(lexeme, 0, sizeof(lexeme));
-            }
-
-            // Beginning of a comment
-            else if (c == '\'') {
-                // Read until a new line is seen
-                while (c != '\n') {
-                    c = get_char(prog_buff);
-                    col_num++;
-                    if (c == '\n') {
-                        line_num++;
-                        col_num = 1;
-                    }
-                }
-                c = get_char(prog_buff);
-                continue;
-            }
-
-            // Beginning of assignment token
-            else if (c == ':') {
-                c = get_char(prog_buff);
-                if (c == '=') {
-                    emit_token(token_list, T_ASSIGN, ":=");
-
-                    // Reset lexeme
-                    memset(lexeme, 0, sizeof(lexeme));
-                    c = get_char(prog_buff);
-                    continue;
-                }
-            }
-
-            else {
-                switch (c) {
-                    case '=':
-                        c = get_char(prog_buff);
-                        if (c == '=') {
-                            col_num++;
-                            emit_token(token_list, T_EQ, "==");
-                        } else {
-                            unget_char();
-                            unget_char();
-                            c = get_char(prog_buff);
-                            log_error("Unknown character on line %d, col %d: \"%c\" (index: %d)",
-                                      line_num, col_num, c, char_num);
-                            exit(LEXER_ERROR_UNKNOWN_CHARACTER);
-                        }
-                        break;
-                    case '<':
-                        c = get_char(prog_buff);
-                        if (c == '=') {
-                            col_num++;
-                            emit_token(token_list, T_LE, "<=");
-                        } else {
-                            unget_char();
-                            emit_token(token_list, T_LT, "<");
-                        }
-                        break;
-                    case '>':
-                        c = get_char(prog_buff);
-                        if (c == '=') {
-                            col_num++;
-                            emit_token(token_list, T_GE, ">=");
-                        } else {
-                            unget_char();
-                            emit_token(token_list, T_GT, ">");
-                        }
-                        break;
-                    case '!':
-                        c = get_char(prog_buff);
-                        if (c == '=') {
-                            col_num++;
-                            emit_token(token_list, T_NE, "!=");
-                        } else {
-                            unget_char();
-                            emit_token(token_list, T_BANG, "!");
-                        }
-                        break;
-                    case '-':
-                        c = get_char(prog_buff);
-                        // Are we a number?
-                        if (is_digit(c)) {
-                            // Append '-' to lexeme
-                            col_num++;
-                            sprintf(lexeme, "%s%c", lexeme, '-');
-                            goto lex_num;
-                            // Yes, using a goto is bad, but it's the easiest way to
-                            // directly parse a negative number with atoi or atof if we
-                            // encode the - within the token
-                        } else {
-                            if (c == '>') {
-                                col_num++;
-                                emit_token(token_list, T_OFTYPE, "->");
-                            } else {
-                                unget_char();
-                                emit_token(token_list, T_MINUS, "-");
-                            }
-                        }
-                        break;
-                }
+/* Splits the program into tokens.
+ *
+ *  Each character is classified with one lookup in char_class and then drives one step of the
+ *  transition table, so the loop below is the whole lexer. The end of the buffer is its own
+ *  character class, and the A_EOF action is the only way out.
+ *
+ *  Runs of blanks, comments, identifiers and string literals are skipped in one go by the actions
+ *  that begin them (see scan.h), leaving the table to handle the byte that ends the run. */
+static void tokenize(lexer_t *lexer, const char *prog_buff) {
+    const unsigned char *buff = (const unsigned char *)prog_buff;
+    lexer_state_t state       = S_START;
+    int start                 = 0;
+    token_type type;
+
+    for (lexer->char_num = 0;; lexer->char_num++) {
+        const unsigned char c  = buff[lexer->char_num];
+        const transition_t *tr = &transitions[state][char_class[c]];
+
+        switch (tr->action) {
+            case A_NONE:
+                break;
+            case A_COUNT:
+                lexer->col_num++;
+                break;
+            case A_NEWLINE:
+                lexer->line_num++;
+                lexer->col_num = 1;
+                break;
+            case A_BEGIN_WORD:
+                start = lexer->char_num;
+                lexer->col_num++;
+                break;
+            case A_BEGIN_STRING:
+                start = lexer->char_num + 1;
+                lexer->char_num += scan->string(prog_buff + start);
+                break;
+            case A_STRING_RUN:
+                lexer->char_num += scan->string(prog_buff + lexer->char_num + 1);
+                break;
+            case A_BLANKS: {
+                const size_t n = scan->blanks(prog_buff + lexer->char_num + 1);
+                lexer->col_num += n + 1;
+                lexer->char_num += n;
+                break;
             }
-
-            // Reset lexeme
-            // memset(lexeme, 0, sizeof(lexeme));
-            c = get_char(prog_buff);
-            continue;
-        }
-
-        // Identifier or keyword?
-        else if (isalpha(c)) {
-            char tmp_delim = 0;
-            bool inc_line  = false;
-            // Read until newline, space, colon, semicolon, period, or lparen
-            while ((c != '\n') && (c != ' ')) {
-                col_num++;
-                // Append to lexeme
-                sprintf(lexeme, "%s%c", lexeme, c);
-                c = get_char(prog_buff);
-
-                if (c == '\n') {
-                    inc_line = true;
-                }
-
-                // Delimiters
-                if (c == '(' || c == ')' || c == '[' || c == ']' || c == '{' || c == '}' ||
-                    c == ':' || c == ';' || c == ',' || c == '.') {
-                    tmp_delim = c;
-                    break;
-                }
+            case A_BEGIN_IDENT: {
+                const size_t n = scan->ident(prog_buff + lexer->char_num + 1);
+                start          = lexer->char_num;
+                lexer->col_num += n + 1;
+                lexer->char_num += n;
+                break;
             }
-            col_num++;
-
-            if (is_keyword(lexeme, &tmp)) {
-                emit_token(token_list, tmp, lexeme);
-                // Reset lexeme
-                memset(lexeme, 0, sizeof(lexeme));
-            } else {
-                // Identifier
-                emit_token(token_list, T_IDENT, lexeme);
-                memset(lexeme, 0, sizeof(lexeme));
+            case A_COMMENT: {
+                const size_t n = scan->line(prog_buff + lexer->char_num + 1);
+                lexer->col_num += n;
+                lexer->char_num += n;
+                break;
             }
-
-            if (tmp_delim) {
-                if (check_singles(tmp_delim)) {
-                    if (tmp_delim == ':') {
-                        c = get_char(prog_buff);
-                        col_num++;
-                        if (c == '=') {
-                            unget_char();
-                            continue;
-                        } else {
-                            unget_char();
-                            emit_token(token_list, T_COLON, ":");
-                        }
-                    }
+            case A_BEGIN_NEG:
+                // The '-' is the first character of the number, so that atoi or atof see it
+                start = lexer->char_num - 1;
+                lexer->col_num += 2;
+                break;
+            case A_SINGLE:
+                emit_token(lexer, single_tokens[c], lexer->char_num, 1);
+                break;
+            case A_COUNT_OP1:
+                lexer->col_num++;
+                // fall through
+            case A_OP1:
+                emit_token(lexer, tr->token, lexer->char_num - 1, 1);
+                break;
+            case A_COUNT_OP2:
+                lexer->col_num++;
+                // fall through
+            case A_OP2:
+                emit_token(lexer, tr->token, lexer->char_num - 1, 2);
+                break;
+            case A_IDENT:
+                lexer->col_num++;
+                if (is_keyword(prog_buff + start, lexer->char_num - start, &type)) {
+                    emit_token(lexer, type, start, lexer->char_num - start);
+                } else {
+                    emit_token(lexer, T_IDENT, start, lexer->char_num - start);
+                    intern_token(lexer);
                 }
-            }
-
-            /* In the case where we've found a token at the end of a line, we need to "delay" the
-             * line number increment until after we've
-             * emitted the token. Otherwise, our token will be assigned a line number that is below
-             * where the token's real position is. */
-            if (inc_line) {
-                line_num++;
-                col_num  = 1;
-                inc_line = false;
-            }
+                break;
+            case A_INTEGER:
+                emit_token(lexer, L_INTEGER, start, lexer->char_num - start);
+                break;
+            case A_FLOAT:
+                emit_token(lexer, L_FLOAT, start, lexer->char_num - start);
+                break;
+            case A_STRING:
+                // The token refers to the characters between the quotes, escape sequences and
+                // all. Its name is the decoded value.
+                emit_token(lexer, L_STR, start, lexer->char_num - start);
+                intern_token(lexer);
+                break;
+            case A_EOF:
+                emit_token(lexer, T_EOF, lexer->char_num, 0);
+                return;
+            case A_UNKNOWN_PREV:
+                lexer->char_num--;
+                // fall through
+            case A_UNKNOWN:
+                log_error("Unknown character on line %d, col %d: \"%c\" (index: %d)",
+                          lexer->line_num, lexer->col_num, buff[lexer->char_num], lexer->char_num);
+                error_exit(LEXER_ERROR_UNKNOWN_CHARACTER);
+            case A_UNTERMINATED:
+                log_error("Unterminated string literal on line %d, col %d", lexer->line_num,
+                          lexer->col_num);
+                error_exit(LEXER_ERROR_UNKNOWN_CHARACTER);
         }
 
-        // Number?
-        else if (is_digit(c)) {
-            // Read until not a digit
-        lex_num:
-            while (is_digit(c)) {
-                // Append to lexeme
-                sprintf(lexeme, "%s%c", lexeme, c);
-                c = get_char(prog_buff);
-                col_num++;
-            }
-
-            // Are we a float?
-            if (c == '.') {
-                // Append dot to lexeme
-                sprintf(lexeme, "%s%c", lexeme, c);
-                // Advance lexeme
-                c = get_char(prog_buff);
-                col_num++;
-
-                if (!is_digit(c)) {
-                    log_error("Unknown character on line %d, col %d: \"%c\" (index: %d)", line_num,
-                              col_num, c, char_num);
-                    exit(LEXER_ERROR_UNKNOWN_CHARACTER);
-                }
-
-                // Read until we hit another non-digit character
-                while (is_digit(c)) {
-                    sprintf(lexeme, "%s%c", lexeme, c);
-                    c = get_char(prog_buff);
-                    col_num++;
-                }
+        state = tr->next;
 
-                unget_char();
-                emit_token(token_list, L_FLOAT, lexeme);
-                memset(lexeme, 0, sizeof(lexeme));
-            } else {
-                unget_char();
-                emit_token(token_list, L_INTEGER, lexeme);
-                memset(lexeme, 0, sizeof(lexeme));
-            }
-        }
-
-        else {
-            log_error("Unknown character on line %d, col %d: \"%c\" (index: %d)", line_num, col_num,
-                      c, char_num);
-            exit(LEXER_ERROR_UNKNOWN_CHARACTER);
+        // Look at the same character again from the new state
+        if (tr->reprocess) {
+            lexer->char_num--;
         }
-
-        c = get_char(prog_buff);
     }
-
-    // Once we hit '\0', append the EOF token
-    emit_token(token_list, T_EOF, "EOF");
 }
@@ -7,8 +7,35 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include "strtab.h"
 #include "token.h"
 
-t_list *lex(const char *path);
+/* Lexer Context
+ *
+ *  Everything the lexer needs to know about the file it is working on. Each lexer_t is
+ *  independent of any other, so several files may be lexed at once on different threads. */
+typedef struct lexer_s {
+    t_array *tokens; // Tokens found so far. The array owns the source they point into.
+    strtab_t *names; // Interns identifiers and string literals
+    int char_num;    // Index of the character being examined
+    int line_num;    // Line and column of the next token
+    int col_num;
+} lexer_t;
+
+// Lexes the program at path (or standard input, see SOURCE_STDIN_PATH) using lexer, which is reset
+// first, and returns its tokens. The caller frees them with t_array_free().
+//
+// The text of each identifier, and the decoded value of each string literal, is interned in names
+// and its id stored in the token. names may be NULL when the tokens will not be parsed.
+t_array *lex(lexer_t *lexer, const char *path, strtab_t *names);
+
+// True if path ends in .lb or .LB, as the path of every program must
+bool has_source_extension(const char *path);
+
+// Checks the extension of path and opens the program there (or standard input), as lex() does
+source_t *lex_open(const char *path);
+
+// Lexes source, which the returned token array takes ownership of, as lex() does
+t_array *lex_source(lexer_t *lexer, source_t *source, strtab_t *names);
 
 #endif // LEXER_H
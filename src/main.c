@@ -4,16 +4,19 @@
  * Author: Liam M. Murphy
  */
 
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "ast.h"
+#include "astcache.h"
+#include "driver.h"
 #include "error.h"
-#include "lexer.h"
-#include "parser.h"
-#include "token.h"
-#include "typechecker.h"
+#include "scan.h"
+#include "server.h"
+#include "version.h"
 
 #include "test.h"
 
@@ -21,16 +24,147 @@ void print_usage() {
     printf("LBASIC Compiler Usage\n");
     printf("    ./lbasic -v or --version\n");
     printf("    ./lbasic -t or --test (debug build only)\n");
+    printf("    ./lbasic -b or --bench\n");
     printf("    ./lbasic -h or --help\n");
     printf("    ./lbasic <path>\n");
+    printf("    ./lbasic - (read the program from standard input)\n");
+    printf("    ./lbasic [-j <jobs>] <path or directory>... (compile many programs in parallel)\n");
+    printf("    ./lbasic --server <socket> (compile for clients, keeping programs in memory)\n");
+    printf("    ./lbasic --client <socket> <path>... (compile programs on a server)\n");
+    printf("    ./lbasic --stop-server <socket>\n");
+    printf("    ./lbasic --trace <category>[=<level>],... <arguments> (debug build only)\n");
+    printf("        categories: lexer, parser, symtab, typecheck or all\n");
+    printf("        levels: off, info, debug (the default) or verbose, or 0-3\n");
+    printf("        LBASIC_TRACE may hold the same list\n");
+    printf("    ./lbasic --max-errors <n> <arguments> (stop a program after n errors, "
+           "default %d)\n",
+           DEFAULT_ERROR_LIMIT);
+    printf("        0 reports every error\n");
+    printf("    ./lbasic --cache-dir <directory> <arguments> (keep parsed programs there)\n");
+    printf("        LBASIC_CACHE_DIR may hold the same directory\n");
 }
 
 void print_version() {
-    printf("LBASIC Compiler v0.2 - September 2023\n");
+    printf("LBASIC Compiler v%s - %s\n", LBASIC_VERSION, LBASIC_RELEASE_DATE);
     printf("Author: Liam M. Murphy\n");
 }
 
+// Reads value, which must be nothing but digits, into count. Returns false for anything else,
+// including a number too large for count.
+static bool parse_count(const char *value, unsigned int *count) {
+    if ((value == NULL) || !isdigit((unsigned char)value[0])) {
+        return false;
+    }
+
+    char *end = NULL;
+    errno     = 0;
+
+    const unsigned long number = strtoul(value, &end, 10);
+    if ((errno != 0) || (*end != '\0') || (number > UINT_MAX)) {
+        return false;
+    }
+
+    *count = (unsigned int)number;
+
+    return true;
+}
+
+// Compiles every program named on the command line, and every program beneath each directory, on
+// a pool of threads. -j or --jobs sets the number of threads, one per online CPU by default.
+static int compile_batch(int argc, char *argv[]) {
+    char **paths       = NULL;
+    unsigned int count = 0;
+    unsigned int jobs  = 0;
+
+    for (int idx = 1; idx < argc; idx++) {
+        if ((strcmp(argv[idx], "-j") == 0) || (strcmp(argv[idx], "--jobs") == 0)) {
+            const char *value = (idx + 1 < argc) ? argv[idx + 1] : NULL;
+
+            if (!parse_count(value, &jobs) || (jobs == 0)) {
+                log_error("%s expects a number of threads, such as '%s 4'", argv[idx], argv[idx]);
+            }
+
+            idx++;
+        } else {
+            collect_sources(argv[idx], &paths, &count);
+        }
+    }
+
+    if (count == 0) {
+        log_error("No programs to compile");
+    }
+
+    const int retval = compile_files(paths, count, jobs, stdout);
+
+    for (unsigned int idx = 0; idx < count; idx++) {
+        free(paths[idx]);
+    }
+    free(paths);
+
+    return retval;
+}
+
+// Sets the trace levels from LBASIC_TRACE and the AST cache directory from LBASIC_CACHE_DIR, then
+// applies any leading --trace, --max-errors and --cache-dir flags, in any order, and removes them
+// from the arguments
+static void configure_options(int *argc, char *argv[]) {
+    if (!trace_configure(getenv("LBASIC_TRACE"))) {
+        log_error("Malformed LBASIC_TRACE '%s'", getenv("LBASIC_TRACE"));
+    }
+
+    const char *dir = getenv("LBASIC_CACHE_DIR");
+    if ((dir != NULL) && (dir[0] != '\0')) {
+        ast_cache_dir = dir;
+    }
+
+    int skip    = 0;
+    bool traced = false;
+
+    while (1 + skip < *argc) {
+        const char *flag  = argv[1 + skip];
+        const char *value = (2 + skip < *argc) ? argv[2 + skip] : NULL;
+
+        if (strcmp(flag, "--trace") == 0) {
+            if ((value == NULL) || !trace_configure(value)) {
+                log_error("--trace expects a list of categories, such as 'symtab,parser=verbose'");
+            }
+
+            traced = true;
+        } else if (strcmp(flag, "--max-errors") == 0) {
+            if (!parse_count(value, &error_limit)) {
+                log_error("--max-errors expects a number of errors, or 0 for no limit");
+            }
+        } else if (strcmp(flag, "--cache-dir") == 0) {
+            if ((value == NULL) || (value[0] == '\0')) {
+                log_error("--cache-dir expects a directory");
+            }
+
+            ast_cache_dir = value;
+        } else {
+            break;
+        }
+
+        skip += 2;
+    }
+
+#if defined(DEBUG)
+    (void)traced;
+#else
+    if (traced) {
+        printf("Tracing unavailable in production builds\n");
+    }
+#endif
+
+    *argc -= skip;
+    memmove(&argv[1], &argv[1 + skip], (*argc - 1) * sizeof(char *));
+}
+
 int main(int argc, char *argv[]) {
+    // Pick the fastest scanners this CPU supports for the lexer
+    scan_init(SCAN_BEST);
+
+    configure_options(&argc, argv);
+
     if (argc > 1) {
 
         if ((strcmp(argv[1], "-v") == 0) || (strcmp(argv[1], "--version") == 0)) {
@@ -47,36 +181,53 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
+        else if ((strcmp(argv[1], "-b") == 0) || (strcmp(argv[1], "--bench") == 0)) {
+            run_benchmarks();
+            return 0;
+        }
+
         else if ((strcmp(argv[1], "-h") == 0) || (strcmp(argv[1], "--help") == 0)) {
             print_usage();
             return 0;
         }
 
-        // Lexical analysis
-        t_list *token_list = lex(argv[1]);
+        else if (strcmp(argv[1], "--server") == 0) {
+            if (argc != 3) {
+                log_error("--server expects the path of a socket to listen on");
+            }
 
-        if (token_list != NULL) {
-#if defined(DEBUG)
-//            print_list(token_list);
-#endif
-            // Syntactic analysis
-            node *program = parse(token_list);
+            server_t server;
+            server_open(&server, argv[2], stdout);
+            printf("Listening on %s\n", argv[2]);
+            fflush(stdout);
 
-            if (program != NULL) {
-#if defined(DEBUG)
-                print_ast(program);
-#endif
-                // Cleanup token_list
-                t_list_free(token_list);
+            server_run(&server);
+            return 0;
+        }
 
-                // Semantic analysis
-                typecheck(program);
-            } else {
-                log_error("Unreadable AST generated during parsing.");
+        else if (strcmp(argv[1], "--client") == 0) {
+            if (argc < 4) {
+                log_error("--client expects the path of a server's socket and programs to compile");
             }
-        } else {
-            log_error("Provide valid file path.");
+
+            return server_request(argv[2], &argv[3], (unsigned int)(argc - 3), stdout);
         }
+
+        else if (strcmp(argv[1], "--stop-server") == 0) {
+            if (argc != 3) {
+                log_error("--stop-server expects the path of the server's socket");
+            }
+
+            server_stop(argv[2]);
+            return 0;
+        }
+
+        // A single program is compiled as it always was, straight to stdout
+        if ((argc == 2) && !is_directory(argv[1])) {
+            return compile_file(argv[1]);
+        }
+
+        return compile_batch(argc, argv);
     } else {
         print_usage();
     }
@@ -11,48 +11,42 @@
 #include "token.h"
 #include "vector.h"
 
-#include <assert.h>
+#include <setjmp.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Globals
-static token lookahead;
-
-// Pointer to doubly-linked list of tokens
-static t_list *toks;
-
 // Private prototypes
-static token get_token(t_list *);
-static token *peek(void);
-static void consume(void);
-static void backup(void);
-static void syntax_error(const char *func, const char *exp, token l);
-static void print_lookahead_debug(const char *msg);
+static const token *get_token(parser_t *parser, unsigned int idx);
+static token *peek(parser_t *parser);
+static void consume(parser_t *parser);
+static void backup(parser_t *parser);
+static void syntax_error(parser_t *parser, const char *func, const char *exp, const token *l);
+static void print_lookahead_debug(parser_t *parser, const char *msg);
 
 // Grammar productions
-static vector *parse_statements(void);       // done
-static node *parse_statement(bool *more);    // done
-static node *parse_block_stmt(void);         // done
-static node *parse_for_stmt(void);           // TBD later on
-static node *parse_while_stmt(void);         // done
-static node *parse_if_stmt(void);            // done
-static node *parse_assign_expr(void);        // done
-static vector *parse_arg_list(void);         // done
-static node *parse_call_expr(void);          // done
-static node *parse_expression(void);         // done
-static vector *parse_formals(void);          // done
-static node *parse_function_decl(void);      // done
-static node *parse_label_decl(void);         // done
-static node *parse_goto_stmt(void);          // done
-static node *parse_var_decl(void);           // done
-static node *parse_member_decl(void);        // done
-static node *parse_struct_decl(void);        // done
-static node *parse_struct_access_expr(void); // done
-static node *parse_return_stmt(void);        // done
-static node *parse_array_init_expr(void);    // done
-static node *parse_array_access_expr(void);  // done
+static vector *parse_statements(parser_t *parser);          // done
+static node *parse_statement(parser_t *parser, bool *more); // done
+static node *parse_block_stmt(parser_t *parser);            // done
+static node *parse_for_stmt(parser_t *parser);              // TBD later on
+static node *parse_while_stmt(parser_t *parser);            // done
+static node *parse_if_stmt(parser_t *parser);               // done
+static node *parse_assign_expr(parser_t *parser);           // done
+static vector *parse_arg_list(parser_t *parser);            // done
+static node *parse_call_expr(parser_t *parser);             // done
+static node *parse_expression(parser_t *parser);            // done
+static vector *parse_formals(parser_t *parser);             // done
+static node *parse_function_decl(parser_t *parser);         // done
+static node *parse_label_decl(parser_t *parser);            // done
+static node *parse_goto_stmt(parser_t *parser);             // done
+static node *parse_var_decl(parser_t *parser);              // done
+static node *parse_member_decl(parser_t *parser);           // done
+static node *parse_struct_decl(parser_t *parser);           // done
+static node *parse_struct_access_expr(parser_t *parser);    // done
+static node *parse_return_stmt(parser_t *parser);           // done
+static node *parse_array_init_expr(parser_t *parser);       // done
+static node *parse_array_access_expr(parser_t *parser);     // done
 
 /* Precedence rules, lowest to highest
  * && ||
@@ -61,37 +55,87 @@ static node *parse_array_access_expr(void);  // done
  * + -
  * * / %
  */
-static node *parse_and_expr(void);     // done
-static node *parse_not_expr(void);     // done
-static node *parse_compare_expr(void); // done
-static node *parse_add_expr(void);     // done
-static node *parse_mult_expr(void);    // done
+static node *parse_and_expr(parser_t *parser);     // done
+static node *parse_not_expr(parser_t *parser);     // done
+static node *parse_compare_expr(parser_t *parser); // done
+static node *parse_add_expr(parser_t *parser);     // done
+static node *parse_mult_expr(parser_t *parser);    // done
 // Same as a 'factor'. Here we parse primitives.
-static node *parse_primary_expr(void); // done
-
-static node *parse_identifier(void);      // done
-static node *parse_string_literal(void);  // done
-static node *parse_integer_literal(void); // done
-static node *parse_float_literal(void);   // done
-static node *parse_bool_literal(void);    // done
-static node *parse_nil(void);             // done
+static node *parse_primary_expr(parser_t *parser); // done
+
+static node *parse_identifier(parser_t *parser);      // done
+static node *parse_string_literal(parser_t *parser);  // done
+static node *parse_integer_literal(parser_t *parser); // done
+static node *parse_float_literal(parser_t *parser);   // done
+static node *parse_bool_literal(parser_t *parser);    // done
+static node *parse_nil(parser_t *parser);             // done
+
+node *mk_node(arena_t *arena, n_type type) {
+    // Nothing frees a node on its own, so every node belongs to a program's arena
+    if (arena == NULL) {
+        log_error("mk_node(): Nodes must be allocated from an arena");
+    }
 
-node *mk_node(n_type type) {
-    node *retval = (node *)malloc(sizeof(node));
+    node *retval = (node *)arena_alloc(arena, sizeof(node));
 
-    // Freed TBD
     if (retval != NULL) {
-        memset(retval, 0, sizeof(node));
-
         // Assign type
         retval->type = type;
 
-        if (type == N_PROGRAM) {
-            retval->data.program.statements = mk_vector();
+        // Names start out empty rather than NULL
+        switch (type) {
+            case N_PROGRAM:
+                retval->data.program.statements = mk_vector(arena);
 
-            if (retval->data.program.statements == NULL) {
-                log_error("Could not allocate node's 'statements' vector");
-            }
+                if (retval->data.program.statements == NULL) {
+                    log_error("Could not allocate node's 'statements' vector");
+                }
+                break;
+            case N_VAR_DECL:
+                retval->data.var_decl.name        = strtab_empty;
+                retval->data.var_decl.struct_type = strtab_empty;
+                break;
+            case N_FUNC_DECL:
+                retval->data.function_decl.name        = strtab_empty;
+                retval->data.function_decl.struct_type = strtab_empty;
+                break;
+            case N_FORMAL:
+                retval->data.formal.name        = strtab_empty;
+                retval->data.formal.struct_type = strtab_empty;
+                break;
+            case N_MEMBER_DECL:
+                retval->data.member_decl.name = strtab_empty;
+                break;
+            case N_STRUCT_DECL:
+                retval->data.struct_decl.name = strtab_empty;
+                break;
+            case N_LABEL_DECL:
+                retval->data.label_decl.name = strtab_empty;
+                break;
+            case N_GOTO_STMT:
+                retval->data.goto_stmt.label = strtab_empty;
+                break;
+            case N_CALL_EXPR:
+                retval->data.call_expr.func_name = strtab_empty;
+                break;
+            case N_STRUCT_ACCESS_EXPR:
+                retval->data.struct_access.name        = strtab_empty;
+                retval->data.struct_access.member_name = strtab_empty;
+                break;
+            case N_ARRAY_ACCESS_EXPR:
+                retval->data.array_access_expr.name = strtab_empty;
+                break;
+            case N_IDENT:
+                retval->data.identifier.name = strtab_empty;
+                break;
+            case N_STRING_LITERAL:
+                retval->data.string_literal.value = strtab_empty;
+                break;
+            case N_BOOL_LITERAL:
+                retval->data.bool_literal.str_val = strtab_empty;
+                break;
+            default:
+                break;
         }
     } else {
         log_error("mk_node(): Unable to allocate memory for new AST node");
@@ -100,110 +144,207 @@ node *mk_node(n_type type) {
     return retval;
 }
 
-// Extracts a token from a t_list struct
-static token get_token(t_list *t) {
-    token retval;
-    if (t != NULL) {
-        retval = *(t->tok);
+// Interns the text of the lookahead token. Identifiers were interned by the lexer already.
+static const char *intern_lookahead(parser_t *parser) {
+    if (parser->lookahead->type == T_IDENT) {
+        return strtab_name(parser->names, parser->lookahead->name);
+    }
+
+    char literal[MAX_LITERAL];
+    token_literal(parser->src, parser->lookahead, literal, sizeof(literal));
+
+    return strtab_intern(parser->names, literal, strlen(literal));
+}
+
+// Points to the token at index idx of the token array
+static const token *get_token(parser_t *parser, unsigned int idx) {
+    const token *retval = NULL;
+    if (idx < parser->toks->count) {
+        retval = &parser->toks->toks[idx];
     } else {
-        log_error("Failed to get next token. Bad t_list or you're trying to access beyond the end "
-                  "of the token list.");
+        log_error("Failed to get next token. You're trying to access beyond the end of the token "
+                  "array.");
     }
     return retval;
 }
 
-// Looks ahead by one token, but does not consume it
-static token *peek() {
-    t_list *next = t_list_next(toks);
-    return next->tok;
+// Looks ahead by one token, but does not consume it. Past the end, this is the EOF token.
+static token *peek(parser_t *parser) {
+    const unsigned int last = parser->toks->count - 1;
+    const unsigned int next = (parser->pos + 1 < last) ? parser->pos + 1 : last;
+    return &parser->toks->toks[next];
 }
 
-// Advances lookahead by one token
-static void consume() {
-    t_list *next = t_list_next(toks);
-    lookahead    = get_token(next);
-    toks         = t_list_next(toks);
+// Advances parser->lookahead by one token
+static void consume(parser_t *parser) {
+    parser->lookahead = get_token(parser, parser->pos + 1);
+    parser->pos++;
 }
 
-// Backs-up lookahead by one token
-static void backup() {
-    t_list *prev = t_list_prev(toks);
-    lookahead    = get_token(prev);
-    toks         = t_list_prev(toks);
+// Backs-up parser->lookahead by one token
+static void backup(parser_t *parser) {
+    if (parser->pos == 0) {
+        log_error("Failed to back up before the first token.");
+    }
+
+    parser->lookahead = get_token(parser, parser->pos - 1);
+    parser->pos--;
 }
 
-static void syntax_error(const char *func, const char *exp, token l) {
-    printf("Syntax Error (line %d, col %d): Expected '%s' but got '%s'.\n", l.line, l.col, exp,
-           l.literal);
+static void syntax_error(parser_t *parser, const char *func, const char *exp, const token *l) {
+    char literal[MAX_LITERAL];
+    size_t line_len       = 0;
+    const char *line_text = token_line(parser->src, l, &line_len);
+
+    diag_printf("Syntax Error (line %d, col %d): Expected '%s' but got '%s'.\n", l->line, l->col,
+                exp, token_literal(parser->src, l, literal, sizeof(literal)));
 #if defined(DEBUG)
-    printf("Error caught within %s()\n", func);
+    diag_printf("Error caught within %s()\n", func);
 #endif
-    printf("%s", l.line_str);
-    for (int i = 0; i < l.col; i++) {
-        printf(" ");
+    diag_printf("%.*s", (int)line_len, line_text);
+    for (int i = 0; i < l->col; i++) {
+        diag_printf(" ");
+    }
+    diag_printf("^\n");
+
+    error_count(&parser->num_errors, PARSER_ERROR_SYNTAX_ERROR);
+    if (parser->recover == NULL) {
+        error_exit(PARSER_ERROR_SYNTAX_ERROR);
+    }
+
+    // Give up on the statement, and go on with the next one
+    longjmp(*parser->recover, 1);
+}
+
+// Skips what is left of a statement with a syntax error in it: up to and including the next ';', or
+// up to the next 'end' or keyword that starts a statement. If the statement began at start and got
+// no further, its first token is skipped as well, so that the parse always moves on.
+static void synchronize(parser_t *parser, unsigned int start) {
+    if ((parser->pos == start) && (parser->lookahead->type != T_END) &&
+        (parser->lookahead->type != T_EOF)) {
+        consume(parser);
+    }
+
+    while (true) {
+        switch (parser->lookahead->type) {
+            case T_SEMICOLON:
+                consume(parser);
+                return;
+            case T_END:
+            case T_EOF:
+            case T_FUNC:
+            case T_IF:
+            case T_WHILE:
+            case T_FOR:
+            case T_STRUCT:
+            case T_INT:
+            case T_FLOAT:
+            case T_STRING:
+            case T_BOOL:
+            case T_RETURN:
+            case T_GOTO:
+                return;
+            default:
+                consume(parser);
+        }
     }
-    printf("^\n");
-    exit(PARSER_ERROR_SYNTAX_ERROR);
 }
 
-static void print_lookahead_debug(const char *msg) {
-#ifdef DEBUG
+// Traced at TRACE_VERBOSE, as it is called at nearly every step of the parse
+static void print_lookahead_debug(parser_t *parser, const char *msg) {
+    if (!trace_enabled(TRACE_PARSER, TRACE_VERBOSE)) {
+        return;
+    }
+
     if (strlen(msg) > 0) {
-        printf("Msg: %s\n", msg);
+        diag_printf("Msg: %s\n", msg);
     }
-    printf("Lookahead type: %d\n", lookahead.type);
-    printf("Lookahead literal: %s\n", lookahead.literal);
-    printf("Line: %d\n", lookahead.line);
-    printf("Column: %d\n", lookahead.col);
-#endif
+    diag_printf("Lookahead type: %d\n", parser->lookahead->type);
+    char literal[MAX_LITERAL];
+    diag_printf("Lookahead literal: %s\n",
+                token_literal(parser->src, parser->lookahead, literal, sizeof(literal)));
+    diag_printf("Line: %d\n", parser->lookahead->line);
+    diag_printf("Column: %d\n", parser->lookahead->col);
 }
 
 // Recursive descent
 
 // <program> := <statements>
-node *parse(t_list *tokens) {
-    node *program = mk_node(N_PROGRAM);
-
-    if (!toks) {
-        toks = tokens;
+node *parse(parser_t *parser, t_array *tokens, arena_t *arena) {
+    // Start from the first token of the new program
+    parser->toks       = tokens;
+    parser->src        = tokens->src;
+    parser->arena      = arena;
+    parser->names      = tokens->names;
+    parser->pos        = 0;
+    parser->recover    = NULL;
+    parser->num_errors = 0;
+
+    if (parser->names == NULL) {
+        log_error("parse(): Tokens were lexed without a string table");
     }
 
-    // Find HEAD token
-    lookahead = get_token(toks);
+    node *program               = mk_node(parser->arena, N_PROGRAM);
+    program->data.program.names = parser->names;
 
-    if (lookahead.type == T_HEAD) {
-        // Found head, get first real token
-        consume();
+    // Get the first token
+    parser->lookahead = get_token(parser, parser->pos);
 
-        if (lookahead.type == T_EOF) {
-            // If we go immediately to an EOF, this is an empty file.
-            log_error("Empty files are not valid LBASIC programs");
-        }
+    if (parser->lookahead->type == T_EOF) {
+        // If we go immediately to an EOF, this is an empty file.
+        log_error("Empty files are not valid LBASIC programs");
     }
 
     // Parse the body of the program
-    program->data.program.statements = parse_statements();
+    program->data.program.statements = parse_statements(parser);
+
+    // The rest of a broken block can leave its 'end' behind at the top level. Skip it, so that the
+    // statements after it are checked too.
+    while ((parser->num_errors > 0) && (parser->lookahead->type == T_END)) {
+        consume(parser);
+        parse_statements(parser);
+    }
+
+    if (parser->num_errors > 0) {
+        if (parser->num_errors > 1) {
+            diag_printf("%u syntax errors\n", parser->num_errors);
+        }
+        error_exit(PARSER_ERROR_SYNTAX_ERROR);
+    }
 
     return program;
 }
 
 // <statements> := <statement> <statements>
 //               | <statement>
-static vector *parse_statements() {
-    vector *retval = mk_vector();
-    bool more      = true;
-    debug("parsing stmts");
+static vector *parse_statements(parser_t *parser) {
+    vector *retval = mk_vector(parser->arena);
+    jmp_buf *outer = parser->recover;
+    jmp_buf recover;
+    debug(TRACE_PARSER, "parsing stmts");
+
+    // Where the statement being parsed began. It is volatile, as it changes after setjmp().
+    volatile unsigned int start = parser->pos;
+
+    // A syntax error in any of these statements comes back here
+    parser->recover = &recover;
+    if (setjmp(recover) != 0) {
+        synchronize(parser, start);
+    }
+
+    bool more = true;
 
     if (retval != NULL) {
         do {
-            node *new_node = parse_statement(&more);
+            start          = parser->pos;
+            node *new_node = parse_statement(parser, &more);
             if (new_node != NULL) {
-                print_lookahead_debug("adding statement node");
-                debug("NODE TYPE: %d\n", new_node->type);
+                print_lookahead_debug(parser, "adding statement node");
+                debug(TRACE_PARSER, "NODE TYPE: %d\n", new_node->type);
                 vector_add(retval, new_node);
 
                 // If we reach the end of the file, break out
-                if (lookahead.type == T_EOF) {
+                if (parser->lookahead->type == T_EOF) {
                     break;
                 }
             }
@@ -212,6 +353,8 @@ static vector *parse_statements() {
         log_error("parse_statements(): Unable to allocate vector");
     }
 
+    parser->recover = outer;
+
     return retval;
 }
 
@@ -229,115 +372,111 @@ static vector *parse_statements() {
 //              | <expression>
 //              | ';' (empty statement)
 //              | ( <expression> )
-static node *parse_statement(bool *more) {
+static node *parse_statement(parser_t *parser, bool *more) {
     node *retval = NULL;
-    debug("type: %d", lookahead.type);
+    debug(TRACE_PARSER, "type: %d", parser->lookahead->type);
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case T_THEN:
-            retval = parse_block_stmt();
+            retval = parse_block_stmt(parser);
             break;
         case T_FOR:
-            retval = parse_for_stmt();
+            retval = parse_for_stmt(parser);
             break;
         case T_WHILE:
-            retval = parse_while_stmt();
+            retval = parse_while_stmt(parser);
             break;
         case T_IF:
-            retval = parse_if_stmt();
+            retval = parse_if_stmt(parser);
             break;
         case T_FUNC:
-            retval = parse_function_decl();
+            retval = parse_function_decl(parser);
             break;
         case T_IDENT: {
-            print_lookahead_debug("ident");
-            token *tmp = peek();
-            debug("tmp literal: %s", tmp->literal);
+            print_lookahead_debug(parser, "ident");
+            token *tmp = peek(parser);
+            debug(TRACE_PARSER, "tmp type: %d", tmp->type);
 
-            if (strcmp(tmp->literal, ":=") == 0) {
-                retval = parse_expression();
+            if (tmp->type == T_ASSIGN) {
+                retval = parse_expression(parser);
                 break;
-            } else if (strcmp(tmp->literal, ":") == 0) {
-                retval = parse_label_decl();
+            } else if (tmp->type == T_COLON) {
+                retval = parse_label_decl(parser);
                 break;
-            } else if (strcmp(tmp->literal, "(") == 0) {
+            } else if (tmp->type == T_LPAREN) {
                 // Likely a function call
-                retval = parse_expression();
+                retval = parse_expression(parser);
                 break;
-            } else if ((strcmp(tmp->literal, "and") == 0) || (strcmp(tmp->literal, "or") == 0) ||
-                       (strcmp(tmp->literal, "+") == 0) || (strcmp(tmp->literal, "-") == 0) ||
-                       (strcmp(tmp->literal, "*") == 0) || (strcmp(tmp->literal, "/") == 0) ||
-                       (strcmp(tmp->literal, "%") == 0) || (strcmp(tmp->literal, ">") == 0) ||
-                       (strcmp(tmp->literal, "<") == 0) || (strcmp(tmp->literal, ">=") == 0) ||
-                       (strcmp(tmp->literal, "<=") == 0) || (strcmp(tmp->literal, "==") == 0) ||
-                       (strcmp(tmp->literal, "!=") == 0)) {
-                retval = parse_expression(); // binop exprs when dealing with variables
+            } else if ((tmp->type == T_AND) || (tmp->type == T_OR) || (tmp->type == T_PLUS) ||
+                       (tmp->type == T_MINUS) || (tmp->type == T_MUL) || (tmp->type == T_DIV) ||
+                       (tmp->type == T_MOD) || (tmp->type == T_GT) || (tmp->type == T_LT) ||
+                       (tmp->type == T_GE) || (tmp->type == T_LE) || (tmp->type == T_EQ) ||
+                       (tmp->type == T_NE)) {
+                retval = parse_expression(parser); // binop exprs when dealing with variables
                 break;
-            } else if (strcmp(tmp->literal, ";") == 0) {
+            } else if (tmp->type == T_SEMICOLON) {
                 // Maybe we'll make this a no-op situation, but for now just raise an error
-                log_error("Illegal statement: %s%s (line %d, col: %d)", lookahead.literal,
-                          tmp->literal, tmp->line, tmp->col);
-            } else if (strcmp(tmp->literal, ".") == 0) {
+                syntax_error(parser, __FUNCTION__, ":=, : or ( after identifier", tmp);
+            } else if (tmp->type == T_DOT) {
                 // Likely a struct access
-                retval = parse_expression();
+                retval = parse_expression(parser);
                 break;
-            } else if (strcmp(tmp->literal, "[") == 0) {
+            } else if (tmp->type == T_LBRACKET) {
                 // Likely an array access
-                retval = parse_expression();
+                retval = parse_expression(parser);
                 break;
             } else {
-                log_error("Parser Error: Unknown case when encountering N_IDENT\n");
-                break;
+                syntax_error(parser, __FUNCTION__, ":=, :, ( or operator after identifier", tmp);
             }
         }
         case T_GOTO:
-            retval = parse_goto_stmt();
+            retval = parse_goto_stmt(parser);
             break;
         case T_INT:
         case T_FLOAT:
         case T_STRING:
         case T_BOOL:
-            retval = parse_var_decl();
+            retval = parse_var_decl(parser);
             break;
         case L_INTEGER:
         case L_FLOAT:
-            retval = parse_expression();
+            retval = parse_expression(parser);
             break;
         case T_STRUCT: {
             // We are either a struct declaration or a variable declaration
             // LL(2) region
-            token *next1 = peek();
+            token *next1 = peek(parser);
             if (next1->type == T_IDENT) {
-                consume();
-                token *next2 = peek();
+                consume(parser);
+                token *next2 = peek(parser);
 
                 if (next2->type == T_IDENT) {
                     // If we see 'struct <ident> <ident>', then this is a struct variable
                     // declaration.
-                    backup();
+                    backup(parser);
 
-                    retval = parse_var_decl();
+                    retval = parse_var_decl(parser);
                 } else if (next2->type == T_THEN) {
                     // If we see 'struct <ident> then', then this is a struct declaration.
-                    backup();
+                    backup(parser);
 
-                    retval = parse_struct_decl();
+                    retval = parse_struct_decl(parser);
                 } else {
                     // Some other case, which is an error
-                    syntax_error(__FUNCTION__, "identifier or 'then'", lookahead);
+                    syntax_error(parser, __FUNCTION__, "identifier or 'then'", parser->lookahead);
                 }
             }
             break;
         }
         case T_LPAREN:
-            retval = parse_expression();
+            retval = parse_expression(parser);
             break;
         case T_RETURN:
-            retval = parse_return_stmt();
+            retval = parse_return_stmt(parser);
             break;
         case T_SEMICOLON:
             // If we see a lone semicolon, just consume it and move on. Empty statement.
-            consume();
+            consume(parser);
             break;
         case T_END: // This should be the end of most bodies (conditionals, functions, etc)
         case T_EOF: // End of file, we're done
@@ -349,65 +488,71 @@ static node *parse_statement(bool *more) {
 }
 
 // <block-stmt> := 'then' <statements>
-static node *parse_block_stmt() {
-    node *retval = mk_node(N_BLOCK_STMT);
+static node *parse_block_stmt(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_BLOCK_STMT);
 
     if (retval != NULL) {
         // Look for 'then'
-        if (lookahead.type == T_THEN) {
+        if (parser->lookahead->type == T_THEN) {
             // Consume it
-            consume();
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, "then", lookahead);
+            syntax_error(parser, __FUNCTION__, "then", parser->lookahead);
         }
 
         // Parse statements until we hit 'end'
         // NOTE: There will be nested 'end's (if's, loops)
-        retval->data.block_stmt.statements = parse_statements();
+        retval->data.block_stmt.statements = parse_statements(parser);
     }
 
     return retval;
 }
 
-static node *parse_for_stmt() { assert(0 && "Not yet implemented"); }
+// 'for' loops are not parsed yet. Each one is reported as a syntax error, which the parse recovers
+// from like any other.
+static node *parse_for_stmt(parser_t *parser) {
+    syntax_error(parser, __FUNCTION__, "statement ('for' is not supported yet)", parser->lookahead);
+
+    return NULL;
+}
 
 // <while-stmt> := 'while' '(' <expression> ')' <block-stmt> 'end'
-static node *parse_while_stmt() {
-    node *retval = mk_node(N_WHILE_STMT);
+static node *parse_while_stmt(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_WHILE_STMT);
 
     if (retval != NULL) {
         // Parse 'while'
-        if (lookahead.type != T_WHILE) {
-            syntax_error(__FUNCTION__, "while", lookahead);
+        if (parser->lookahead->type != T_WHILE) {
+            syntax_error(parser, __FUNCTION__, "while", parser->lookahead);
         }
         // Consume while
-        consume();
+        consume(parser);
 
         // Parse beginning of test '('
-        if (lookahead.type != T_LPAREN) {
-            syntax_error(__FUNCTION__, "(", lookahead);
+        if (parser->lookahead->type != T_LPAREN) {
+            syntax_error(parser, __FUNCTION__, "(", parser->lookahead);
         }
         // Consume (
-        consume();
+        consume(parser);
 
         // Parse expression
-        retval->data.while_stmt.test = parse_expression();
+        retval->data.while_stmt.test = parse_expression(parser);
 
         // Parse ending ')'
-        if (lookahead.type != T_RPAREN) {
-            syntax_error(__FUNCTION__, ")", lookahead);
+        if (parser->lookahead->type != T_RPAREN) {
+            syntax_error(parser, __FUNCTION__, ")", parser->lookahead);
         }
         // Consume )
-        consume();
+        consume(parser);
 
         // Parse body
-        retval->data.while_stmt.body = parse_block_stmt();
+        retval->data.while_stmt.body = parse_block_stmt(parser);
 
         // Look for 'end'
-        if (lookahead.type != T_END) {
-            syntax_error(__FUNCTION__, "end", lookahead);
+        if (parser->lookahead->type != T_END) {
+            syntax_error(parser, __FUNCTION__, "end", parser->lookahead);
         } else {
-            consume();
+            consume(parser);
         }
     }
 
@@ -415,52 +560,52 @@ static node *parse_while_stmt() {
 }
 
 // <if-stmt> := 'if' '(' <expression> ')' <block-stmt> ('else' <block-stmt>)? 'end'
-static node *parse_if_stmt() {
-    node *retval = mk_node(N_IF_STMT);
+static node *parse_if_stmt(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_IF_STMT);
 
     if (retval != NULL) {
         // Parse 'if'
-        if (lookahead.type != T_IF) {
-            syntax_error(__FUNCTION__, "if", lookahead);
+        if (parser->lookahead->type != T_IF) {
+            syntax_error(parser, __FUNCTION__, "if", parser->lookahead);
         }
         // Consume if
-        consume();
+        consume(parser);
 
         // Parse beginning of test '('
-        if (lookahead.type != T_LPAREN) {
-            syntax_error(__FUNCTION__, "(", lookahead);
+        if (parser->lookahead->type != T_LPAREN) {
+            syntax_error(parser, __FUNCTION__, "(", parser->lookahead);
         }
         // Consume (
-        consume();
+        consume(parser);
 
         // Parse expression
-        retval->data.if_stmt.test = parse_expression();
+        retval->data.if_stmt.test = parse_expression(parser);
 
         // Parse ending ')'
-        if (lookahead.type != T_RPAREN) {
-            syntax_error(__FUNCTION__, ")", lookahead);
+        if (parser->lookahead->type != T_RPAREN) {
+            syntax_error(parser, __FUNCTION__, ")", parser->lookahead);
         }
         // Consume )
-        consume();
+        consume(parser);
 
         // Parse body
-        retval->data.if_stmt.body = parse_block_stmt();
+        retval->data.if_stmt.body = parse_block_stmt(parser);
 
         // If we see an 'end' token, there will be no 'else'
-        if (lookahead.type == T_END) {
+        if (parser->lookahead->type == T_END) {
             retval->data.if_stmt.else_stmt = NULL;
-            consume();
-        } else if (lookahead.type == T_ELSE) {
-            consume();
-            retval->data.if_stmt.else_stmt = parse_block_stmt();
+            consume(parser);
+        } else if (parser->lookahead->type == T_ELSE) {
+            consume(parser);
+            retval->data.if_stmt.else_stmt = parse_block_stmt(parser);
 
-            if (lookahead.type == T_END) {
-                consume();
+            if (parser->lookahead->type == T_END) {
+                consume(parser);
             } else {
-                syntax_error(__FUNCTION__, "end", lookahead);
+                syntax_error(parser, __FUNCTION__, "end", parser->lookahead);
             }
         } else {
-            syntax_error(__FUNCTION__, "else or end", lookahead);
+            syntax_error(parser, __FUNCTION__, "else or end", parser->lookahead);
         }
     }
 
@@ -471,19 +616,19 @@ static node *parse_if_stmt() {
 // To handle the else-if we have to do this a bit differently
 
 // And and Or
-static node *parse_and_expr() {
-    print_lookahead_debug("begin and_expr");
+static node *parse_and_expr(parser_t *parser) {
+    print_lookahead_debug(parser, "begin and_expr");
 
     // Try to parse the "left hand side"
     node *retval     = NULL;
-    node *e1         = parse_not_expr(); // "Term"
+    node *e1         = parse_not_expr(parser); // "Term"
     node *e2         = NULL;
     token_type ttype = -1;
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case T_AND:
         case T_OR:
-            ttype = lookahead.type;
+            ttype = parser->lookahead->type;
             break;
         default:
             break;
@@ -494,12 +639,12 @@ static node *parse_and_expr() {
         retval = e1;
     } else {
         // Consume the operator
-        consume();
-        e2 = parse_not_expr(); // "Term"
+        consume(parser);
+        e2 = parse_not_expr(parser); // "Term"
 
         if (e1 != NULL) {
             if (e2 != NULL) {
-                retval = mk_node(N_BINOP_EXPR);
+                retval = mk_node(parser->arena, N_BINOP_EXPR);
                 if (retval != NULL) {
                     retval->data.bin_op_expr.lhs = e1;
                     retval->data.bin_op_expr.rhs = e2;
@@ -517,61 +662,61 @@ static node *parse_and_expr() {
 }
 
 // Negation and unary minus
-static node *parse_not_expr() {
-    print_lookahead_debug("begin not_expr");
+static node *parse_not_expr(parser_t *parser) {
+    print_lookahead_debug(parser, "begin not_expr");
 
     node *retval = NULL;
 
     // Look for !
-    if (lookahead.type == T_BANG) {
-        print_lookahead_debug("found !");
+    if (parser->lookahead->type == T_BANG) {
+        print_lookahead_debug(parser, "found !");
         // Consume it
-        consume();
+        consume(parser);
 
         // Parse the expression
-        retval = mk_node(N_NOT_EXPR);
+        retval = mk_node(parser->arena, N_NOT_EXPR);
         if (retval != NULL) {
-            retval->data.not_expr.expr = parse_expression();
+            retval->data.not_expr.expr = parse_expression(parser);
         } else {
             log_error("Unable to create N_NOT_EXPR node");
         }
-    } else if (lookahead.type == T_MINUS) {
-        consume();
-        print_lookahead_debug("found -");
+    } else if (parser->lookahead->type == T_MINUS) {
+        consume(parser);
+        print_lookahead_debug(parser, "found -");
         // Parse the expr
-        retval = mk_node(N_NEG_EXPR);
+        retval = mk_node(parser->arena, N_NEG_EXPR);
         if (retval != NULL) {
-            retval->data.neg_expr.expr = parse_expression();
+            retval->data.neg_expr.expr = parse_expression(parser);
         } else {
             log_error("Unable to create N_NEG_EXPR node");
         }
     } else {
-        print_lookahead_debug("did not find !");
+        print_lookahead_debug(parser, "did not find !");
         // If we didn't find a !, continue to parse.
-        retval = parse_compare_expr();
+        retval = parse_compare_expr(parser);
     }
 
     return retval;
 }
 
 // Comparisons (relational)
-static node *parse_compare_expr() {
-    print_lookahead_debug("begin compare_expr");
+static node *parse_compare_expr(parser_t *parser) {
+    print_lookahead_debug(parser, "begin compare_expr");
 
     // Try to parse the "left hand side"
     node *retval     = NULL;
-    node *e1         = parse_add_expr(); // "Term"
+    node *e1         = parse_add_expr(parser); // "Term"
     node *e2         = NULL;
     token_type ttype = -1;
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case T_EQ:
         case T_NE:
         case T_GT:
         case T_GE:
         case T_LT:
         case T_LE:
-            ttype = lookahead.type;
+            ttype = parser->lookahead->type;
             break;
         default:
             break;
@@ -582,12 +727,12 @@ static node *parse_compare_expr() {
         retval = e1;
     } else {
         // Consume the operator
-        consume();
-        e2 = parse_add_expr(); // "Term"
+        consume(parser);
+        e2 = parse_add_expr(parser); // "Term"
 
         if (e1 != NULL) {
             if (e2 != NULL) {
-                retval = mk_node(N_BINOP_EXPR);
+                retval = mk_node(parser->arena, N_BINOP_EXPR);
                 if (retval != NULL) {
                     retval->data.bin_op_expr.lhs = e1;
                     retval->data.bin_op_expr.rhs = e2;
@@ -605,19 +750,19 @@ static node *parse_compare_expr() {
 }
 
 // Addition and subtraction
-static node *parse_add_expr() {
-    print_lookahead_debug("begin add_expr");
+static node *parse_add_expr(parser_t *parser) {
+    print_lookahead_debug(parser, "begin add_expr");
 
     // Try to parse the "left hand side"
     node *retval     = NULL;
-    node *e1         = parse_mult_expr(); // "Term"
+    node *e1         = parse_mult_expr(parser); // "Term"
     node *e2         = NULL;
     token_type ttype = -1;
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case T_PLUS:
         case T_MINUS:
-            ttype = lookahead.type;
+            ttype = parser->lookahead->type;
             break;
         default:
             break;
@@ -628,12 +773,12 @@ static node *parse_add_expr() {
         retval = e1;
     } else {
         // Consume the operator
-        consume();
-        e2 = parse_mult_expr(); // "Term"
+        consume(parser);
+        e2 = parse_mult_expr(parser); // "Term"
 
         if (e1 != NULL) {
             if (e2 != NULL) {
-                retval = mk_node(N_BINOP_EXPR);
+                retval = mk_node(parser->arena, N_BINOP_EXPR);
                 if (retval != NULL) {
                     retval->data.bin_op_expr.lhs = e1;
                     retval->data.bin_op_expr.rhs = e2;
@@ -651,20 +796,20 @@ static node *parse_add_expr() {
 }
 
 // Multiplication, division, and modulus
-static node *parse_mult_expr() {
-    print_lookahead_debug("begin mult_expr");
+static node *parse_mult_expr(parser_t *parser) {
+    print_lookahead_debug(parser, "begin mult_expr");
 
     // Try to parse the "left hand side"
     node *retval     = NULL;
-    node *e1         = parse_primary_expr(); // "Factor"
+    node *e1         = parse_primary_expr(parser); // "Factor"
     node *e2         = NULL;
     token_type ttype = -1;
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case T_MUL:
         case T_DIV:
         case T_MOD:
-            ttype = lookahead.type;
+            ttype = parser->lookahead->type;
             break;
         default:
             break;
@@ -675,12 +820,12 @@ static node *parse_mult_expr() {
         retval = e1;
     } else {
         // Consume the operator
-        consume();
-        e2 = parse_primary_expr(); // "Factor"
+        consume(parser);
+        e2 = parse_primary_expr(parser); // "Factor"
 
         if (e1 != NULL) {
             if (e2 != NULL) {
-                retval = mk_node(N_BINOP_EXPR);
+                retval = mk_node(parser->arena, N_BINOP_EXPR);
                 if (retval != NULL) {
                     retval->data.bin_op_expr.lhs = e1;
                     retval->data.bin_op_expr.rhs = e2;
@@ -698,55 +843,55 @@ static node *parse_mult_expr() {
 }
 
 // Literals and grouping expressions
-static node *parse_primary_expr() {
+static node *parse_primary_expr(parser_t *parser) {
     node *retval;
-    print_lookahead_debug("begin primary_expr");
+    print_lookahead_debug(parser, "begin primary_expr");
 
     // Move past assignment operator
-    //    consume();
+    //    consume(parser);
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case L_INTEGER:
-            retval = parse_integer_literal();
+            retval = parse_integer_literal(parser);
             break;
         case L_FLOAT:
-            retval = parse_float_literal();
+            retval = parse_float_literal(parser);
             break;
         case L_STR:
-            retval = parse_string_literal();
+            retval = parse_string_literal(parser);
             break;
         case T_TRUE:
         case T_FALSE:
-            retval = parse_bool_literal();
+            retval = parse_bool_literal(parser);
             break;
         case T_IDENT: {
-            print_lookahead_debug("checking primary_expr ident cases");
+            print_lookahead_debug(parser, "checking primary_expr ident cases");
             // We need to check if this is a regular variable, a function call, a struct access, or
             // an array access
-            token *tmp = peek();
+            token *tmp = peek(parser);
             if ((tmp != NULL) && (tmp->type == T_LPAREN)) {
                 // This is a function call
-                retval = parse_call_expr();
-                print_lookahead_debug("returned from call_expr");
+                retval = parse_call_expr(parser);
+                print_lookahead_debug(parser, "returned from call_expr");
                 return retval;
 
             } else if ((tmp != NULL) && (tmp->type == T_DOT)) {
-                // In this case, we need to lookahead 3 (NOT GREAT I KNOW)
-                consume();
+                // In this case, we need to parser->lookahead 3 (NOT GREAT I KNOW)
+                consume(parser);
 
-                token *tmp2 = peek();
+                token *tmp2 = peek(parser);
                 if (tmp2->type == T_IDENT) {
-                    consume();
-                    token *tmp3 = peek();
+                    consume(parser);
+                    token *tmp3 = peek(parser);
                     // We must check if we are part of an assignment or a regular struct access
                     if (tmp3->type == T_ASSIGN) {
-                        backup(); // Backup the ident, lookahead should be the dot
-                        backup(); // Backup the dot, lookahead should be the ident
-                        retval = parse_assign_expr();
+                        backup(parser); // Backup the ident, parser->lookahead should be the dot
+                        backup(parser); // Backup the dot, parser->lookahead should be the ident
+                        retval = parse_assign_expr(parser);
                     } else {
-                        backup(); // Backup the ident, lookahead should be the dot
-                        backup(); // Backup the dot, lookahead should be the ident
-                        retval = parse_struct_access_expr();
+                        backup(parser); // Backup the ident, parser->lookahead should be the dot
+                        backup(parser); // Backup the dot, parser->lookahead should be the ident
+                        retval = parse_struct_access_expr(parser);
                     }
                 }
                 return retval;
@@ -754,40 +899,40 @@ static node *parse_primary_expr() {
                 // This is an array access
 
                 // First, try to figure out if we ever hit an assignment operator
-                // Token lookahead buffer (does not consume from real token stream)
-                t_list *curr_tok = toks;
-                token tmp_tok    = get_token(curr_tok);
+                // Token parser->lookahead buffer (does not consume from real token stream)
+                unsigned int curr_tok = parser->pos;
+                const token *tmp_tok  = get_token(parser, curr_tok);
 
                 // Now get next token
-                curr_tok = curr_tok->next;
-                tmp_tok  = get_token(curr_tok);
+                curr_tok++;
+                tmp_tok = get_token(parser, curr_tok);
 
                 bool more = false;
                 do {
-                    if (tmp_tok.type != T_LBRACKET) {
+                    if (tmp_tok->type != T_LBRACKET) {
                         // At this point, this shouldn't happen, but if it does, break out
                         break;
                     } else {
-                        curr_tok = curr_tok->next;
-                        tmp_tok  = get_token(curr_tok);
+                        curr_tok++;
+                        tmp_tok = get_token(parser, curr_tok);
 
                         // Read chars until closing bracket
-                        while (tmp_tok.type != T_RBRACKET) {
-                            curr_tok = curr_tok->next;
-                            tmp_tok  = get_token(curr_tok);
+                        while (tmp_tok->type != T_RBRACKET) {
+                            curr_tok++;
+                            tmp_tok = get_token(parser, curr_tok);
                         }
 
                         // Look for closing bracket
-                        if (tmp_tok.type != T_RBRACKET) {
+                        if (tmp_tok->type != T_RBRACKET) {
                             // If we don't find it, break out
                             break;
                         } else {
-                            curr_tok = curr_tok->next;
-                            tmp_tok  = get_token(curr_tok);
+                            curr_tok++;
+                            tmp_tok = get_token(parser, curr_tok);
                         }
 
                         // See if we have another dimension
-                        if (tmp_tok.type == T_LBRACKET) {
+                        if (tmp_tok->type == T_LBRACKET) {
                             more = true;
                         } else {
                             break;
@@ -795,29 +940,29 @@ static node *parse_primary_expr() {
                     }
                 } while (more);
 
-                if (tmp_tok.type == T_ASSIGN) {
+                if (tmp_tok->type == T_ASSIGN) {
                     // This is an assignment (eventually)
-                    retval = parse_assign_expr();
+                    retval = parse_assign_expr(parser);
                 } else {
-                    retval = parse_array_access_expr();
+                    retval = parse_array_access_expr(parser);
                 }
                 return retval;
             } else if ((tmp != NULL) && (tmp->type == T_ASSIGN)) {
-                retval = parse_assign_expr();
+                retval = parse_assign_expr(parser);
                 return retval;
             } else if (tmp != NULL) {
                 // Treat this as a regular variable name
-                retval = parse_identifier();
+                retval = parse_identifier(parser);
             }
             break;
         }
         case T_NIL:
-            retval = parse_nil();
+            retval = parse_nil(parser);
             break;
         case T_LPAREN:
-            consume();
-            retval = parse_expression();
-            consume();
+            consume(parser);
+            retval = parse_expression(parser);
+            consume(parser);
             return retval;
             break;
         default:
@@ -825,8 +970,8 @@ static node *parse_primary_expr() {
     }
 
     // Consume the literal or ident
-    consume();
-    print_lookahead_debug("end primary_expr");
+    consume(parser);
+    print_lookahead_debug(parser, "end primary_expr");
 
     return retval;
 }
@@ -834,53 +979,53 @@ static node *parse_primary_expr() {
 // <assign-expr> := <struct-access-expr> ':=' <expression> ';'
 //                | <array-access-expr> ':=' <expression> ';'
 //                | <ident> ':=' <expression> ';'
-static node *parse_assign_expr() {
-    node *retval = mk_node(N_ASSIGN_EXPR);
+static node *parse_assign_expr(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_ASSIGN_EXPR);
 
     if (retval != NULL) {
         // Identifier should be live in
-        print_lookahead_debug("top of assign_expr");
+        print_lookahead_debug(parser, "top of assign_expr");
 
-        if (lookahead.type == T_IDENT) {
-            token *tmp = peek();
+        if (parser->lookahead->type == T_IDENT) {
+            token *tmp = peek(parser);
 
             if (tmp->type == T_DOT) {
-                retval->data.assign_expr.lhs = parse_struct_access_expr();
+                retval->data.assign_expr.lhs = parse_struct_access_expr(parser);
             } else if (tmp->type == T_LBRACKET) {
-                retval->data.assign_expr.lhs = parse_array_access_expr();
+                retval->data.assign_expr.lhs = parse_array_access_expr(parser);
             } else {
-                retval->data.assign_expr.lhs = parse_identifier();
-                consume();
+                retval->data.assign_expr.lhs = parse_identifier(parser);
+                consume(parser);
             }
         } else {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         }
-        //        retval->data.assign_expr.lhs = parse_expression();
+        //        retval->data.assign_expr.lhs = parse_expression(parser);
 
         // Consume identifier (ignoring arrays for now)
-        //        consume();
+        //        consume(parser);
 
-        print_lookahead_debug("after consuming ident");
+        print_lookahead_debug(parser, "after consuming ident");
 
         // Now we should be looking at an assignment operator
-        if (lookahead.type == T_ASSIGN) {
+        if (parser->lookahead->type == T_ASSIGN) {
             // Consume assignment
-            consume();
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, ":=", lookahead);
+            syntax_error(parser, __FUNCTION__, ":=", parser->lookahead);
         }
 
-        print_lookahead_debug("before parsing RHS");
+        print_lookahead_debug(parser, "before parsing RHS");
 
         // Right hand side is an expression
-        retval->data.assign_expr.rhs = parse_expression();
+        retval->data.assign_expr.rhs = parse_expression(parser);
 
-        print_lookahead_debug("after parsing RHS");
+        print_lookahead_debug(parser, "after parsing RHS");
 
-        if (lookahead.type == T_SEMICOLON) {
-            consume();
+        if (parser->lookahead->type == T_SEMICOLON) {
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, ";", lookahead);
+            syntax_error(parser, __FUNCTION__, ";", parser->lookahead);
         }
     }
 
@@ -888,14 +1033,14 @@ static node *parse_assign_expr() {
 }
 
 // <arg-list> := ( <expression> (',')? )*
-static vector *parse_arg_list() {
-    vector *retval = mk_vector();
+static vector *parse_arg_list(parser_t *parser) {
+    vector *retval = mk_vector(parser->arena);
 
     if (retval == NULL) {
         log_error("Unable to allocate vector for function call arguments");
     }
 
-    print_lookahead_debug("inside parse_arg_list");
+    print_lookahead_debug(parser, "inside parse_arg_list");
 
     // Look for args (expressions)
     bool repeat = true;
@@ -903,19 +1048,19 @@ static vector *parse_arg_list() {
     node *new_arg_expr = NULL;
 
     do {
-        new_arg_expr = parse_expression();
+        new_arg_expr = parse_expression(parser);
         if (new_arg_expr != NULL) {
             vector_add(retval, new_arg_expr);
         } else {
             log_error("Unable to parse argument expression");
         }
 
-        print_lookahead_debug("after argument");
+        print_lookahead_debug(parser, "after argument");
 
-        if (lookahead.type == T_RPAREN) {
+        if (parser->lookahead->type == T_RPAREN) {
             repeat = false;
-        } else if (lookahead.type == T_COMMA) {
-            consume();
+        } else if (parser->lookahead->type == T_COMMA) {
+            consume(parser);
             repeat = true;
         }
     } while (repeat);
@@ -926,44 +1071,42 @@ static vector *parse_arg_list() {
 // Known issue: if a function call, like a print statement, is on its own, the parser does not
 // properly detect the lack of a semicolon (in this case, it is correctly parsed with or without the
 // semicolon) <call-expr> := <identifier> '(' ( <arg-list> )? ')'
-static node *parse_call_expr() {
-    node *retval = mk_node(N_CALL_EXPR);
+static node *parse_call_expr(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_CALL_EXPR);
 
     if (retval != NULL) {
-        print_lookahead_debug("inside call_expr");
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        print_lookahead_debug(parser, "inside call_expr");
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         }
 
-        memset(retval->data.call_expr.func_name, 0, sizeof(retval->data.call_expr.func_name));
-        snprintf(retval->data.call_expr.func_name, sizeof(retval->data.call_expr.func_name), "%s",
-                 lookahead.literal);
+        retval->data.call_expr.func_name = intern_lookahead(parser);
 
         // Consume function name
-        consume();
+        consume(parser);
 
-        if (lookahead.type != T_LPAREN) {
-            syntax_error(__FUNCTION__, "(", lookahead);
+        if (parser->lookahead->type != T_LPAREN) {
+            syntax_error(parser, __FUNCTION__, "(", parser->lookahead);
         }
 
         // Consume (
-        consume();
+        consume(parser);
 
-        if (lookahead.type == T_RPAREN) {
+        if (parser->lookahead->type == T_RPAREN) {
             // No args
             retval->data.call_expr.args = NULL;
-            consume();
+            consume(parser);
         } else {
-            retval->data.call_expr.args = parse_arg_list();
+            retval->data.call_expr.args = parse_arg_list(parser);
 
-            if (lookahead.type != T_RPAREN) {
-                syntax_error(__FUNCTION__, ") after argument list", lookahead);
+            if (parser->lookahead->type != T_RPAREN) {
+                syntax_error(parser, __FUNCTION__, ") after argument list", parser->lookahead);
             }
-            consume();
+            consume(parser);
         }
     }
 
-    print_lookahead_debug("end of call_expr");
+    print_lookahead_debug(parser, "end of call_expr");
 
     return retval;
 }
@@ -971,14 +1114,14 @@ static node *parse_call_expr() {
 // TODO: Allow this to accept arrays and structs
 // <formal> := ( 'struct' )? <type> ( '[' ']' )* <identifier>
 // <formal-list> := <formal> ( ',' <formal> )*
-static vector *parse_formals() {
-    print_lookahead_debug("inside parse_formals()");
+static vector *parse_formals(parser_t *parser) {
+    print_lookahead_debug(parser, "inside parse_formals()");
     bool repeat = false;
     bool first  = true;
 
-    vector *retval = mk_vector();
+    vector *retval = mk_vector(parser->arena);
 
-    node *formal = mk_node(N_FORMAL);
+    node *formal = mk_node(parser->arena, N_FORMAL);
     node *new    = {0};
 
     node *current = formal;
@@ -986,94 +1129,92 @@ static vector *parse_formals() {
     // TODO: Optimize this do-while loop, like when parsing struct member decls.
     do {
         if (!first) {
-            new     = mk_node(N_FORMAL);
+            new     = mk_node(parser->arena, N_FORMAL);
             current = new;
         }
 
-        consume();
+        consume(parser);
         // Lookahead is now a type
 
         // Look for the optional 'struct' keyword
-        if (lookahead.type == T_STRUCT) {
+        if (parser->lookahead->type == T_STRUCT) {
             current->data.formal.is_struct = true;
 
             // consume it
-            consume();
+            consume(parser);
         }
 
         if (current->data.formal.is_struct) {
             // If we're a struct, our data type is 'struct' and our struct type is the
             // identifier after the 'struct' keyword
             current->data.formal.type = D_STRUCT;
-            memset(current->data.formal.struct_type, 0, sizeof(current->data.formal.struct_type));
-            snprintf(current->data.formal.struct_type, sizeof(current->data.formal.struct_type),
-                     "%s", lookahead.literal);
+            current->data.formal.struct_type = intern_lookahead(parser);
         } else {
             // If no 'struct', then just get the type
-            switch (lookahead.type) {
+            switch (parser->lookahead->type) {
                 case T_INT:
                 case T_BOOL:
                 case T_STRING:
                 case T_FLOAT:
                     break;
                 default:
-                    syntax_error(__FUNCTION__, "int, bool, string, or float", lookahead);
+                    syntax_error(parser, __FUNCTION__, "int, bool, string, or float",
+                                 parser->lookahead);
             }
 
-            current->data.formal.type = keyword_to_type(lookahead.type);
+            current->data.formal.type = keyword_to_type(parser->lookahead->type);
         }
 
         // consume type
-        consume();
+        consume(parser);
 
-        print_lookahead_debug("before checking array");
+        print_lookahead_debug(parser, "before checking array");
 
         // Check to see if the formal is an array
-        if (lookahead.type == T_LBRACKET) {
-            consume();
+        if (parser->lookahead->type == T_LBRACKET) {
+            consume(parser);
 
-            if (lookahead.type != T_RBRACKET) {
-                syntax_error(__FUNCTION__, "]", lookahead);
+            if (parser->lookahead->type != T_RBRACKET) {
+                syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
             } else {
                 current->data.formal.is_array       = true;
                 current->data.formal.num_dimensions = 1;
-                consume();
+                consume(parser);
             }
         }
 
-        while (lookahead.type == T_LBRACKET) {
-            consume();
+        while (parser->lookahead->type == T_LBRACKET) {
+            consume(parser);
 
-            if (lookahead.type != T_RBRACKET) {
-                syntax_error(__FUNCTION__, "]", lookahead);
+            if (parser->lookahead->type != T_RBRACKET) {
+                syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
             } else {
                 current->data.formal.num_dimensions += 1;
-                consume();
+                consume(parser);
             }
         }
 
         // Now should be the identifier itself
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(current->data.formal.name, 0, MAX_LITERAL);
-            sprintf(current->data.formal.name, "%s", lookahead.literal);
+            current->data.formal.name = intern_lookahead(parser);
             vector_add(retval, current);
         }
 
         // Look for a ',' or ')'
-        token *tmp = peek();
+        token *tmp = peek(parser);
 
         // End of formals
         if (tmp->type == T_RPAREN) {
-            consume();
+            consume(parser);
             repeat = false;
             break;
         }
 
         // More formals
         else if (tmp->type == T_COMMA) {
-            consume();
+            consume(parser);
             repeat = true;
             first  = false;
         }
@@ -1086,144 +1227,140 @@ static vector *parse_formals() {
 // TODO: Allow this to return structs and arrays
 // <function-decl> := 'func' <ident> '(' <formals> ')' '->' ( 'struct' )? <type> ( '[' ']' )* 'then'
 // <block-stmt> 'end'
-static node *parse_function_decl() {
-    node *retval = mk_node(N_FUNC_DECL);
+static node *parse_function_decl(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_FUNC_DECL);
 
     if (retval != NULL) {
         // Look for 'func'
-        if (lookahead.type == T_FUNC) {
-            consume();
+        if (parser->lookahead->type == T_FUNC) {
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, "func", lookahead);
+            syntax_error(parser, __FUNCTION__, "func", parser->lookahead);
         }
 
         // Look for identifier
-        if (lookahead.type == T_IDENT) {
-            snprintf(retval->data.function_decl.name, sizeof(retval->data.function_decl.name), "%s",
-                     lookahead.literal);
-            consume();
+        if (parser->lookahead->type == T_IDENT) {
+            retval->data.function_decl.name = intern_lookahead(parser);
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, "function name", lookahead);
+            syntax_error(parser, __FUNCTION__, "function name", parser->lookahead);
         }
 
         // Look for formal args
-        if (lookahead.type == T_LPAREN) {
-            token *tok = peek();
+        if (parser->lookahead->type == T_LPAREN) {
+            token *tok = peek(parser);
             if ((tok != NULL) && (tok->type == T_RPAREN)) {
                 // No args
                 retval->data.function_decl.formals = NULL;
 
                 // Consume '('
-                consume();
+                consume(parser);
 
                 // Consume ')'
-                consume();
+                consume(parser);
             } else if (tok != NULL) {
                 // Maybe we have some formals
 
                 // consume the (
-                // consume();
-                retval->data.function_decl.formals = parse_formals();
+                // consume(parser);
+                retval->data.function_decl.formals = parse_formals(parser);
 
                 // Consume the ')' at the end of the formals list
-                consume();
+                consume(parser);
             }
         } else {
-            syntax_error(__FUNCTION__, "(", lookahead);
+            syntax_error(parser, __FUNCTION__, "(", parser->lookahead);
         }
 
         // Look for type arrow
-        if (lookahead.type == T_OFTYPE) {
-            consume();
+        if (parser->lookahead->type == T_OFTYPE) {
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, "->", lookahead);
+            syntax_error(parser, __FUNCTION__, "->", parser->lookahead);
         }
 
         // Look for type
 
         // Is it a struct?
-        if (lookahead.type == T_STRUCT) {
+        if (parser->lookahead->type == T_STRUCT) {
             retval->data.function_decl.is_struct = true;
-            consume();
+            consume(parser);
         }
 
         if (retval->data.function_decl.is_struct) {
-            if (lookahead.type != T_IDENT) {
-                syntax_error(__FUNCTION__, "struct type", lookahead);
+            if (parser->lookahead->type != T_IDENT) {
+                syntax_error(parser, __FUNCTION__, "struct type", parser->lookahead);
             } else {
-                memset(retval->data.function_decl.struct_type, 0,
-                       sizeof(retval->data.function_decl.struct_type));
-                snprintf(retval->data.function_decl.struct_type,
-                         sizeof(retval->data.function_decl.struct_type), "%s", lookahead.literal);
+                retval->data.function_decl.struct_type = intern_lookahead(parser);
                 retval->data.function_decl.type = D_STRUCT;
             }
         } else {
-            switch (lookahead.type) {
+            switch (parser->lookahead->type) {
                 case T_INT:
                 case T_FLOAT:
                 case T_BOOL:
                 case T_STRING:
                 case T_VOID:
-                    retval->data.function_decl.type = keyword_to_type(lookahead.type);
+                    retval->data.function_decl.type = keyword_to_type(parser->lookahead->type);
                     break;
                 default:
-                    syntax_error(__FUNCTION__, "type declaration", lookahead);
+                    syntax_error(parser, __FUNCTION__, "type declaration", parser->lookahead);
                     break;
             }
         }
 
-        consume();
+        consume(parser);
 
         // Is it an array?
-        if (lookahead.type == T_LBRACKET) {
-            consume();
+        if (parser->lookahead->type == T_LBRACKET) {
+            consume(parser);
 
-            if (lookahead.type != T_RBRACKET) {
-                syntax_error(__FUNCTION__, "]", lookahead);
+            if (parser->lookahead->type != T_RBRACKET) {
+                syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
             } else {
                 retval->data.function_decl.is_array       = true;
                 retval->data.function_decl.num_dimensions = 1;
-                consume();
+                consume(parser);
             }
         }
 
-        while (lookahead.type == T_LBRACKET) {
-            consume();
+        while (parser->lookahead->type == T_LBRACKET) {
+            consume(parser);
 
-            if (lookahead.type != T_RBRACKET) {
-                syntax_error(__FUNCTION__, "]", lookahead);
+            if (parser->lookahead->type != T_RBRACKET) {
+                syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
             } else {
                 retval->data.function_decl.num_dimensions += 1;
-                consume();
+                consume(parser);
             }
         }
 
         // Look for 'then'
-        if (lookahead.type == T_THEN) {
+        if (parser->lookahead->type == T_THEN) {
             // If we have one, parse the function body
-            retval->data.function_decl.body = parse_block_stmt();
+            retval->data.function_decl.body = parse_block_stmt(parser);
         } else {
-            syntax_error(__FUNCTION__, "then", lookahead);
+            syntax_error(parser, __FUNCTION__, "then", parser->lookahead);
         }
 
         // Parse the end token and we're done
-        if (lookahead.type == T_END) {
-            consume();
+        if (parser->lookahead->type == T_END) {
+            consume(parser);
         } else {
-            syntax_error(__FUNCTION__, "end", lookahead);
+            syntax_error(parser, __FUNCTION__, "end", parser->lookahead);
         }
 
-        print_lookahead_debug("here");
+        print_lookahead_debug(parser, "here");
     }
 
     return retval;
 }
 
-static node *parse_expression() {
+static node *parse_expression(parser_t *parser) {
     struct node *retval;
-    print_lookahead_debug("begin parse_expr()");
+    print_lookahead_debug(parser, "begin parse_expr()");
 
-    switch (lookahead.type) {
+    switch (parser->lookahead->type) {
         case T_IDENT:
         case L_INTEGER:
         case L_FLOAT:
@@ -1235,99 +1372,93 @@ static node *parse_expression() {
         case T_MINUS:
         case T_NIL:
             // Entry point into arithmetic expressions and booleans
-            retval = parse_and_expr();
+            retval = parse_and_expr(parser);
             break;
         case T_ASSIGN:
             // This case might be dead code
-            retval = parse_assign_expr();
+            retval = parse_assign_expr(parser);
             break;
         case T_LBRACE:
-            retval = parse_array_init_expr();
+            retval = parse_array_init_expr(parser);
             break;
-        default: {
-            log_error("Unknown token at beginning of expression: %s (line %d, col: %d)\n%s",
-                      lookahead.literal, lookahead.line, lookahead.col, lookahead.line_str);
-        }
+        default:
+            syntax_error(parser, __FUNCTION__, "expression", parser->lookahead);
     }
 
     return retval;
 }
 
 // <label-decl> := <identifier> ':'
-static node *parse_label_decl() {
-    node *retval = mk_node(N_LABEL_DECL);
+static node *parse_label_decl(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_LABEL_DECL);
 
     if (retval != NULL) {
         // Look for label name
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(retval->data.label_decl.name, 0, MAX_LITERAL);
-            snprintf(retval->data.label_decl.name, sizeof(retval->data.label_decl.name), "%s",
-                     lookahead.literal);
+            retval->data.label_decl.name = intern_lookahead(parser);
         }
 
-        consume();
+        consume(parser);
 
         // Look for colon
-        if (lookahead.type != T_COLON) {
-            syntax_error(__FUNCTION__, ":", lookahead);
+        if (parser->lookahead->type != T_COLON) {
+            syntax_error(parser, __FUNCTION__, ":", parser->lookahead);
         }
 
         // Consume it
-        consume();
+        consume(parser);
     }
 
     return retval;
 }
 
 // <goto-stmt> := 'goto' <identifier> ';'
-static node *parse_goto_stmt() {
-    node *retval = mk_node(N_GOTO_STMT);
+static node *parse_goto_stmt(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_GOTO_STMT);
 
     if (retval != NULL) {
         // Look for goto
-        if (lookahead.type != T_GOTO) {
-            syntax_error(__FUNCTION__, "goto", lookahead);
+        if (parser->lookahead->type != T_GOTO) {
+            syntax_error(parser, __FUNCTION__, "goto", parser->lookahead);
         }
 
         // Otherwise, consume it
-        consume();
+        consume(parser);
 
         // Look for identifier
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(retval->data.goto_stmt.label, 0, MAX_LITERAL);
-            snprintf(retval->data.goto_stmt.label, sizeof(retval->data.goto_stmt.label), "%s",
-                     lookahead.literal);
+            retval->data.goto_stmt.label = intern_lookahead(parser);
 
-            consume();
+            consume(parser);
         }
 
         // Look for semicolon
-        if (lookahead.type != T_SEMICOLON) {
-            syntax_error(__FUNCTION__, ";", lookahead);
+        if (parser->lookahead->type != T_SEMICOLON) {
+            syntax_error(parser, __FUNCTION__, ";", parser->lookahead);
         }
 
-        consume();
+        consume(parser);
     }
 
     return retval;
 }
 
 // <var-decl> := ( 'struct' )? <type> ( '[' ']' )* <identifier> ( ':=' <expression> )? ';'
-static node *parse_var_decl() {
-    node *retval = mk_node(N_VAR_DECL);
+static node *parse_var_decl(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_VAR_DECL);
 
     if (retval != NULL) {
-        print_lookahead_debug("top of var_decl");
+        print_lookahead_debug(parser, "top of var_decl");
 
         // Look for the optional 'struct' keyword
-        if (lookahead.type == T_STRUCT) {
+        if (parser->lookahead->type == T_STRUCT) {
             retval->data.var_decl.is_struct = true;
             // consume it
-            consume();
+            consume(parser);
         }
 
         // Get type
@@ -1335,91 +1466,84 @@ static node *parse_var_decl() {
             // If we're a struct, our data type is 'struct' and our struct type is the identifier
             // after the 'struct' keyword
             retval->data.var_decl.type = D_STRUCT;
-            memset(retval->data.var_decl.struct_type, 0, sizeof(retval->data.var_decl.struct_type));
-            snprintf(retval->data.var_decl.struct_type, sizeof(retval->data.var_decl.struct_type),
-                     "%s", lookahead.literal);
+            retval->data.var_decl.struct_type = intern_lookahead(parser);
         } else {
             // Otherwise, we're a primitive data type
-            retval->data.var_decl.type = keyword_to_type(lookahead.type);
+            retval->data.var_decl.type = keyword_to_type(parser->lookahead->type);
         }
 
         // Consume the type declaration
-        consume();
+        consume(parser);
 
         // Look for the optional array declaration
-        if (lookahead.type == T_LBRACKET) {
-            consume();
+        if (parser->lookahead->type == T_LBRACKET) {
+            consume(parser);
 
-            if (lookahead.type != T_RBRACKET) {
-                syntax_error(__FUNCTION__, "]", lookahead);
+            if (parser->lookahead->type != T_RBRACKET) {
+                syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
             } else {
                 retval->data.var_decl.is_array       = true;
                 retval->data.var_decl.num_dimensions = 1;
-                consume();
+                consume(parser);
             }
         }
 
-        while (lookahead.type == T_LBRACKET) {
-            consume();
+        while (parser->lookahead->type == T_LBRACKET) {
+            consume(parser);
 
-            if (lookahead.type != T_RBRACKET) {
-                syntax_error(__FUNCTION__, "]", lookahead);
+            if (parser->lookahead->type != T_RBRACKET) {
+                syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
             } else {
                 retval->data.var_decl.num_dimensions += 1;
-                consume();
+                consume(parser);
             }
         }
 
         // Look for the variable name
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier name", lookahead);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier name", parser->lookahead);
         } else {
-            memset(retval->data.var_decl.name, 0, MAX_LITERAL);
-            snprintf(retval->data.var_decl.name, sizeof(retval->data.var_decl.name), "%s",
-                     lookahead.literal);
+            retval->data.var_decl.name = intern_lookahead(parser);
         }
 
-        consume();
+        consume(parser);
 
         // Look for the assignment
-        if (lookahead.type == T_ASSIGN) {
+        if (parser->lookahead->type == T_ASSIGN) {
 
             // Consume assignment
-            consume();
-            retval->data.var_decl.value = parse_expression();
+            consume(parser);
+            retval->data.var_decl.value = parse_expression(parser);
 
-            if (lookahead.type != T_SEMICOLON) {
-                syntax_error(__FUNCTION__, "; after expression", lookahead);
+            if (parser->lookahead->type != T_SEMICOLON) {
+                syntax_error(parser, __FUNCTION__, "; after expression", parser->lookahead);
             }
             // Consume the semicolon
-            consume();
+            consume(parser);
         } else {
             // If we don't immediately assign a value, set a default based upon the type
-            if (lookahead.type == T_SEMICOLON) {
+            if (parser->lookahead->type == T_SEMICOLON) {
                 node *val_default = NULL;
                 switch (retval->data.var_decl.type) {
                     case D_INTEGER:
-                        val_default                             = mk_node(N_INTEGER_LITERAL);
+                        val_default = mk_node(parser->arena, N_INTEGER_LITERAL);
                         val_default->data.integer_literal.value = 0;
                         break;
                     case D_FLOAT:
-                        val_default                           = mk_node(N_FLOAT_LITERAL);
+                        val_default = mk_node(parser->arena, N_FLOAT_LITERAL);
                         val_default->data.float_literal.value = 0.0;
                         break;
                     case D_STRING:
-                        val_default                           = mk_node(N_STRING_LITERAL);
+                        val_default = mk_node(parser->arena, N_STRING_LITERAL);
                         val_default->data.string_literal.type = D_STRING;
                         // Empty string
-                        memset(val_default->data.string_literal.value, 0,
-                               sizeof(val_default->data.string_literal.value));
-                        snprintf(val_default->data.string_literal.value,
-                                 sizeof(val_default->data.string_literal.value), "%s", "");
+                        val_default->data.string_literal.value = strtab_empty;
                         break;
                     case D_BOOLEAN:
-                        val_default                          = mk_node(N_BOOL_LITERAL);
+                        val_default = mk_node(parser->arena, N_BOOL_LITERAL);
                         val_default->data.bool_literal.value = 0; // false
-                        snprintf(val_default->data.bool_literal.str_val,
-                                 sizeof(val_default->data.bool_literal.str_val), "false");
+                        val_default->data.bool_literal.str_val =
+                            strtab_intern(parser->names, "false", strlen("false"));
                         break;
                     case D_STRUCT:
                         // For structs, don't assign a default value. We'll handle this at codegen
@@ -1427,15 +1551,22 @@ static node *parse_var_decl() {
                         val_default = NULL;
                         break;
                     default:
-                        syntax_error(__FUNCTION__, "Unknown literal type", lookahead);
+                        syntax_error(parser, __FUNCTION__, "Unknown literal type",
+                                     parser->lookahead);
+                }
+
+                // An array is not one value of its element type, so its elements are left to
+                // codegen time too, as a struct's members are
+                if (retval->data.var_decl.is_array) {
+                    val_default = NULL;
                 }
 
                 retval->data.var_decl.value = val_default;
 
                 // Consume next token and we're done
-                consume();
+                consume(parser);
             } else {
-                syntax_error(__FUNCTION__, "; after empty declaration", lookahead);
+                syntax_error(parser, __FUNCTION__, "; after empty declaration", parser->lookahead);
             }
         }
     }
@@ -1443,85 +1574,81 @@ static node *parse_var_decl() {
     return retval;
 }
 
-static node *parse_member_decl() {
-    node *retval = mk_node(N_MEMBER_DECL);
+static node *parse_member_decl(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_MEMBER_DECL);
 
     if (retval != NULL) {
-        switch (lookahead.type) {
+        switch (parser->lookahead->type) {
             case T_INT:
             case T_BOOL:
             case T_STRING:
             case T_FLOAT:
-                retval->data.member_decl.type = keyword_to_type(lookahead.type);
+                retval->data.member_decl.type = keyword_to_type(parser->lookahead->type);
                 break;
             default:
-                syntax_error(__FUNCTION__, "type", lookahead);
+                syntax_error(parser, __FUNCTION__, "type", parser->lookahead);
         }
 
-        consume();
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        consume(parser);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(retval->data.member_decl.name, 0, MAX_LITERAL);
-            snprintf(retval->data.member_decl.name, sizeof(retval->data.member_decl.name), "%s",
-                     lookahead.literal);
+            retval->data.member_decl.name = intern_lookahead(parser);
         }
 
-        consume();
-        if (lookahead.type != T_SEMICOLON) {
-            syntax_error(__FUNCTION__, ";", lookahead);
+        consume(parser);
+        if (parser->lookahead->type != T_SEMICOLON) {
+            syntax_error(parser, __FUNCTION__, ";", parser->lookahead);
         }
 
-        consume();
+        consume(parser);
     }
 
     return retval;
 }
 
 // <struct-decl> := 'struct' <ident> 'then' <member-decls> 'end'
-static node *parse_struct_decl() {
-    node *retval = mk_node(N_STRUCT_DECL);
+static node *parse_struct_decl(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_STRUCT_DECL);
 
     if (retval != NULL) {
-        retval->data.struct_decl.members = mk_vector();
-        if (lookahead.type != T_STRUCT) {
-            syntax_error(__FUNCTION__, "struct", lookahead);
+        retval->data.struct_decl.members = mk_vector(parser->arena);
+        if (parser->lookahead->type != T_STRUCT) {
+            syntax_error(parser, __FUNCTION__, "struct", parser->lookahead);
         } else {
             retval->data.struct_decl.type = D_STRUCT;
         }
 
-        consume();
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        consume(parser);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(retval->data.struct_decl.name, 0, MAX_LITERAL);
-            snprintf(retval->data.struct_decl.name, sizeof(retval->data.struct_decl.name), "%s",
-                     lookahead.literal);
+            retval->data.struct_decl.name = intern_lookahead(parser);
         }
 
-        consume();
-        if (lookahead.type != T_THEN) {
-            syntax_error(__FUNCTION__, "then", lookahead);
+        consume(parser);
+        if (parser->lookahead->type != T_THEN) {
+            syntax_error(parser, __FUNCTION__, "then", parser->lookahead);
         }
 
         // Parse member declarations
-        consume();
+        consume(parser);
         do {
-            node *member = parse_member_decl();
+            node *member = parse_member_decl(parser);
 
             if (member != NULL) {
                 vector_add(retval->data.struct_decl.members, member);
             } else {
                 log_error("Unable to add NULL member decl to vector");
             }
-        } while (lookahead.type != T_END);
+        } while (parser->lookahead->type != T_END);
 
         // Check for the 'end' token
-        if (lookahead.type != T_END) {
-            syntax_error(__FUNCTION__, "end", lookahead);
+        if (parser->lookahead->type != T_END) {
+            syntax_error(parser, __FUNCTION__, "end", parser->lookahead);
         } else {
             // Consume 'end'
-            consume();
+            consume(parser);
         }
     }
 
@@ -1529,78 +1656,74 @@ static node *parse_struct_decl() {
 }
 
 // <struct-access-expr> := <ident> '.' <ident>
-static node *parse_struct_access_expr() {
-    node *retval = mk_node(N_STRUCT_ACCESS_EXPR);
+static node *parse_struct_access_expr(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_STRUCT_ACCESS_EXPR);
 
     if (retval != NULL) {
-        print_lookahead_debug("top of parse_struct_access");
+        print_lookahead_debug(parser, "top of parse_struct_access");
 
         // Get struct name
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(retval->data.struct_access.name, 0, sizeof(retval->data.struct_access.name));
-            snprintf(retval->data.struct_access.name, sizeof(retval->data.struct_access.name), "%s",
-                     lookahead.literal);
+            retval->data.struct_access.name = intern_lookahead(parser);
 
             // Consume struct name
-            consume();
+            consume(parser);
         }
 
-        print_lookahead_debug("looking for dot");
-        if (lookahead.type != T_DOT) {
-            syntax_error(__FUNCTION__, ".", lookahead);
+        print_lookahead_debug(parser, "looking for dot");
+        if (parser->lookahead->type != T_DOT) {
+            syntax_error(parser, __FUNCTION__, ".", parser->lookahead);
         } else {
             // Consume dot
-            consume();
+            consume(parser);
         }
 
-        print_lookahead_debug("looking for ident");
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "member identifier", lookahead);
+        print_lookahead_debug(parser, "looking for ident");
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "member identifier", parser->lookahead);
         } else {
-            memset(retval->data.struct_access.member_name, 0,
-                   sizeof(retval->data.struct_access.member_name));
-            snprintf(retval->data.struct_access.member_name,
-                     sizeof(retval->data.struct_access.member_name), "%s", lookahead.literal);
+            retval->data.struct_access.member_name = intern_lookahead(parser);
 
             // Consume member name
-            consume();
+            consume(parser);
         }
 
-        print_lookahead_debug("end of parse_struct_access");
+        print_lookahead_debug(parser, "end of parse_struct_access");
     }
 
     return retval;
 }
 
 // 'return' ( <expression> )? ';'
-static node *parse_return_stmt() {
-    node *retval = mk_node(N_RETURN_STMT);
+static node *parse_return_stmt(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_RETURN_STMT);
 
     if (retval != NULL) {
         // Look for 'return'
-        if (lookahead.type != T_RETURN) {
-            syntax_error(__FUNCTION__, "return", lookahead);
+        if (parser->lookahead->type != T_RETURN) {
+            syntax_error(parser, __FUNCTION__, "return", parser->lookahead);
         } else {
-            consume();
+            consume(parser);
 
             // If we run into a semicolon immediately after the return, consider this an "empty"
             // return, which may be used within a void function to break out.
-            if (lookahead.type == T_SEMICOLON) {
+            if (parser->lookahead->type == T_SEMICOLON) {
                 retval->data.return_stmt.expr = NULL;
             } else {
-                retval->data.return_stmt.expr = parse_expression();
-                print_lookahead_debug("after return expr");
+                retval->data.return_stmt.expr = parse_expression(parser);
+                print_lookahead_debug(parser, "after return expr");
 
                 // Look for ;
-                if (lookahead.type != T_SEMICOLON) {
-                    syntax_error(__FUNCTION__, "; after return expression", lookahead);
+                if (parser->lookahead->type != T_SEMICOLON) {
+                    syntax_error(parser, __FUNCTION__, "; after return expression",
+                                 parser->lookahead);
                 }
             }
 
             // Consume it
-            consume();
+            consume(parser);
         }
     }
 
@@ -1608,34 +1731,34 @@ static node *parse_return_stmt() {
 }
 
 // <array-init-expr> := '{' ( <expr> ( ',' )? )? '}'
-static node *parse_array_init_expr() {
-    node *retval = mk_node(N_ARRAY_INIT_EXPR);
+static node *parse_array_init_expr(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_ARRAY_INIT_EXPR);
 
     if (retval != NULL) {
-        if (lookahead.type != T_LBRACE) {
-            syntax_error(__FUNCTION__, "{", lookahead);
+        if (parser->lookahead->type != T_LBRACE) {
+            syntax_error(parser, __FUNCTION__, "{", parser->lookahead);
         } else {
-            retval->data.array_init_expr.expressions = mk_vector();
-            consume();
+            retval->data.array_init_expr.expressions = mk_vector(parser->arena);
+            consume(parser);
 
-            if (lookahead.type == T_RBRACE) {
+            if (parser->lookahead->type == T_RBRACE) {
                 // Empty intializer
-                consume();
+                consume(parser);
             } else {
                 // Look for expressions, separated by commas.
                 bool more = false;
 
                 do {
-                    node *expr = parse_expression();
+                    node *expr = parse_expression(parser);
                     vector_add(retval->data.array_init_expr.expressions, expr);
 
-                    print_lookahead_debug("after adding expr");
+                    print_lookahead_debug(parser, "after adding expr");
 
-                    if (lookahead.type == T_COMMA) {
-                        consume();
+                    if (parser->lookahead->type == T_COMMA) {
+                        consume(parser);
                         more = true;
-                    } else if (lookahead.type == T_RBRACE) {
-                        consume();
+                    } else if (parser->lookahead->type == T_RBRACE) {
+                        consume(parser);
                         more = false;
                     }
                 } while (more);
@@ -1647,43 +1770,40 @@ static node *parse_array_init_expr() {
 }
 
 // <array-access-expr> := <ident> ( '[' <expression> ']' )+
-static node *parse_array_access_expr() {
-    node *retval = mk_node(N_ARRAY_ACCESS_EXPR);
+static node *parse_array_access_expr(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_ARRAY_ACCESS_EXPR);
 
     if (retval != NULL) {
-        print_lookahead_debug("top of parse_array_access_expr()");
-        if (lookahead.type != T_IDENT) {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+        print_lookahead_debug(parser, "top of parse_array_access_expr()");
+        if (parser->lookahead->type != T_IDENT) {
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         } else {
-            memset(retval->data.array_access_expr.name, 0,
-                   sizeof(retval->data.array_access_expr.name));
-            snprintf(retval->data.array_access_expr.name,
-                     sizeof(retval->data.array_access_expr.name), "%s", lookahead.literal);
+            retval->data.array_access_expr.name = intern_lookahead(parser);
 
-            retval->data.array_access_expr.expressions = mk_vector();
-            consume();
+            retval->data.array_access_expr.expressions = mk_vector(parser->arena);
+            consume(parser);
         }
 
         // Look for indexing
         bool more = false;
         do {
-            if (lookahead.type != T_LBRACKET) {
-                syntax_error(__FUNCTION__, "[", lookahead);
+            if (parser->lookahead->type != T_LBRACKET) {
+                syntax_error(parser, __FUNCTION__, "[", parser->lookahead);
             } else {
-                consume();
+                consume(parser);
 
                 // Read expression
-                node *expr = parse_expression();
+                node *expr = parse_expression(parser);
                 vector_add(retval->data.array_access_expr.expressions, expr);
 
                 // Look for closing bracket
-                if (lookahead.type != T_RBRACKET) {
-                    syntax_error(__FUNCTION__, "]", lookahead);
+                if (parser->lookahead->type != T_RBRACKET) {
+                    syntax_error(parser, __FUNCTION__, "]", parser->lookahead);
                 } else {
-                    consume();
+                    consume(parser);
                 }
 
-                if (lookahead.type == T_LBRACKET) {
+                if (parser->lookahead->type == T_LBRACKET) {
                     more = true;
                 } else {
                     more = false;
@@ -1695,90 +1815,88 @@ static node *parse_array_access_expr() {
     return retval;
 }
 
-static node *parse_identifier() {
-    node *retval = mk_node(N_IDENT);
-    print_lookahead_debug("parse_identifier");
+static node *parse_identifier(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_IDENT);
+    print_lookahead_debug(parser, "parse_identifier");
 
     if (retval != NULL) {
-        if (lookahead.type == T_IDENT) {
-            // Assume the current lookahead is an identifier token
-            memset(retval->data.identifier.name, 0, sizeof(retval->data.identifier.name));
-            snprintf(retval->data.identifier.name, sizeof(retval->data.identifier.name), "%s",
-                     lookahead.literal);
+        if (parser->lookahead->type == T_IDENT) {
+            // Assume the current parser->lookahead is an identifier token
+            retval->data.identifier.name = intern_lookahead(parser);
 
         } else {
-            syntax_error(__FUNCTION__, "identifier", lookahead);
+            syntax_error(parser, __FUNCTION__, "identifier", parser->lookahead);
         }
     }
 
     return retval;
 }
-static node *parse_string_literal() {
-    node *retval = mk_node(N_STRING_LITERAL);
+static node *parse_string_literal(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_STRING_LITERAL);
 
     if (retval != NULL) {
-        if (lookahead.type == L_STR) {
-            print_lookahead_debug("inside parse_string_literal");
-            retval->data.string_literal.type = D_STRING;
-            memset(retval->data.string_literal.value, 0, sizeof(retval->data.string_literal.value));
-            snprintf(retval->data.string_literal.value,
-                     sizeof(retval->data.string_literal.value) - 1, "%s", lookahead.literal);
-            // Size is MAX_LITERAL + 1, but we want to write the null terminator to the
-            // MAX_LITERAL'th byte (ie. 0-1024)
-            retval->data.string_literal.value[MAX_LITERAL] = '\0';
+        if (parser->lookahead->type == L_STR) {
+            print_lookahead_debug(parser, "inside parse_string_literal");
+            // The lexer interned the decoded value
+            retval->data.string_literal.type  = D_STRING;
+            retval->data.string_literal.value = strtab_name(parser->names, parser->lookahead->name);
         } else {
-            syntax_error(__FUNCTION__, "string literal", lookahead);
+            syntax_error(parser, __FUNCTION__, "string literal", parser->lookahead);
         }
     }
 
     return retval;
 }
-static node *parse_integer_literal() {
-    node *retval = mk_node(N_INTEGER_LITERAL);
+static node *parse_integer_literal(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_INTEGER_LITERAL);
 
     if (retval != NULL) {
-        retval->data.integer_literal.type  = D_INTEGER;
-        retval->data.integer_literal.value = atoi(lookahead.literal);
+        char literal[MAX_LITERAL];
+
+        retval->data.integer_literal.type = D_INTEGER;
+        retval->data.integer_literal.value =
+            atoi(token_literal(parser->src, parser->lookahead, literal, sizeof(literal)));
     }
 
     return retval;
 }
 
-static node *parse_float_literal() {
-    node *retval = mk_node(N_FLOAT_LITERAL);
+static node *parse_float_literal(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_FLOAT_LITERAL);
 
     if (retval != NULL) {
-        retval->data.float_literal.type  = D_FLOAT;
-        retval->data.float_literal.value = atof(lookahead.literal);
+        char literal[MAX_LITERAL];
+
+        retval->data.float_literal.type = D_FLOAT;
+        retval->data.float_literal.value =
+            atof(token_literal(parser->src, parser->lookahead, literal, sizeof(literal)));
     }
 
     return retval;
 }
-static node *parse_bool_literal() {
-    node *retval = mk_node(N_BOOL_LITERAL);
+static node *parse_bool_literal(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_BOOL_LITERAL);
 
     if (retval != NULL) {
-        if (lookahead.type == T_TRUE || lookahead.type == T_FALSE) {
+        if (parser->lookahead->type == T_TRUE || parser->lookahead->type == T_FALSE) {
             retval->data.bool_literal.type = D_BOOLEAN;
-            memset(retval->data.bool_literal.str_val, 0, sizeof(retval->data.bool_literal.str_val));
-            snprintf(retval->data.bool_literal.str_val, sizeof(retval->data.bool_literal.str_val),
-                     "%s", lookahead.literal);
-            retval->data.bool_literal.value = (lookahead.type == T_TRUE) ? 1 : 0;
+            retval->data.bool_literal.str_val = intern_lookahead(parser);
+            retval->data.bool_literal.value = (parser->lookahead->type == T_TRUE) ? 1 : 0;
         } else {
-            syntax_error(__FUNCTION__, "true or false", lookahead);
+            syntax_error(parser, __FUNCTION__, "true or false", parser->lookahead);
         }
     }
 
     return retval;
 }
-static node *parse_nil() {
-    node *retval = mk_node(N_NIL);
+static node *parse_nil(parser_t *parser) {
+    node *retval = mk_node(parser->arena, N_NIL);
 
     if (retval != NULL) {
-        if (lookahead.type == T_NIL) {
+        if (parser->lookahead->type == T_NIL) {
             retval->data.nil.value = 0; // ALWAYS zero
         } else {
-            syntax_error(__FUNCTION__, "nil", lookahead);
+            syntax_error(parser, __FUNCTION__, "nil", parser->lookahead);
         }
     }
 
@@ -7,10 +7,38 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "arena.h"
 #include "ast.h"
+#include "strtab.h"
 #include "token.h"
 
+#include <setjmp.h>
+
+/* Parser Context
+ *
+ *  Everything the parser needs to know about the program it is working on. Each parser_t is
+ *  independent of any other, so several programs may be parsed at once on different threads.
+ *
+ *  A syntax error is reported and then jumps back to the innermost list of statements being
+ *  parsed, which skips the rest of the broken statement and goes on with the next one. */
+typedef struct parser_s {
+    t_array *toks;           // Tokens of the program
+    const source_t *src;     // Source buffer the tokens point into
+    arena_t *arena;          // Owns the AST
+    strtab_t *names;         // The tokens' string table, which the AST's names also come from
+    unsigned int pos;        // Index of the lookahead within toks
+    const token *lookahead;  // The token at pos. toks does not move once the program is lexed.
+    jmp_buf *recover;        // Where a syntax error jumps to, or NULL outside of any statements
+    unsigned int num_errors; // Syntax errors reported so far
+} parser_t;
+
 // Prototypes
-node *parse(t_list *tokens);
+
+// Parses tokens using parser, which is reset first, and returns the program's AST. Every node and
+// vector of the AST is allocated from arena, and is freed along with it. The tokens must have been
+// lexed with a string table (allocated from arena too), which the AST's names come from. If the
+// program has any syntax errors, they are all reported and the compile ends with
+// PARSER_ERROR_SYNTAX_ERROR.
+node *parse(parser_t *parser, t_array *tokens, arena_t *arena);
 
 #endif // PARSER_H
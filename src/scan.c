@@ -0,0 +1,236 @@
+/**
+ * LBASIC Byte Scanning Module
+ * File: scan.c
+ * Author: Liam M. Murphy
+ */
+
+#include "scan.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86
+#endif
+
+/* Scalar scanners
+ *
+ *  Portable fallback. Each scanner has a table of the bytes that end its run. */
+static const bool line_stops[256]   = {['\0'] = true, ['\n'] = true};
+static const bool string_stops[256] = {['\0'] = true, ['"'] = true, ['\\'] = true};
+static const bool ident_stops[256]  = {
+    ['\0'] = true, [' '] = true, ['\n'] = true, ['('] = true, [')'] = true,
+    ['['] = true,  [']'] = true, ['{'] = true,  ['}'] = true, [':'] = true,
+    [';'] = true,  [','] = true, ['.'] = true};
+
+static size_t scalar_line(const char *p) {
+    size_t n = 0;
+    while (!line_stops[(unsigned char)p[n]]) {
+        n++;
+    }
+
+    return n;
+}
+
+static size_t scalar_blanks(const char *p) {
+    size_t n = 0;
+    while (p[n] == ' ' || p[n] == '\t' || p[n] == '\r') {
+        n++;
+    }
+
+    return n;
+}
+
+static size_t scalar_ident(const char *p) {
+    size_t n = 0;
+    while (!ident_stops[(unsigned char)p[n]]) {
+        n++;
+    }
+
+    return n;
+}
+
+static size_t scalar_string(const char *p) {
+    size_t n = 0;
+    while (!string_stops[(unsigned char)p[n]]) {
+        n++;
+    }
+
+    return n;
+}
+
+static const scan_ops_t scalar_ops = {
+    .name   = "scalar",
+    .line   = scalar_line,
+    .blanks = scalar_blanks,
+    .ident  = scalar_ident,
+    .string = scalar_string,
+};
+
+/* Vector scanners
+ *
+ *  Each one computes a mask with a bit set for every byte of a block that ends the run. The first
+ *  load is rounded down to the block alignment and the bits for the bytes before p are shifted
+ *  out. Aligned loads stay within the page of the bytes they are after, so reading past the null
+ *  terminator is harmless. */
+#define SCAN_BLOCKS(p, vec_t, width, load, stop_mask)                                              \
+    do {                                                                                           \
+        const uintptr_t skip = (uintptr_t)(p) & ((width)-1);                                       \
+        const vec_t *block   = (const vec_t *)((p)-skip);                                          \
+        uint32_t mask        = stop_mask(load(block)) >> skip;                                     \
+        size_t n             = (width)-skip;                                                       \
+                                                                                                   \
+        if (mask != 0) {                                                                           \
+            return __builtin_ctz(mask);                                                            \
+        }                                                                                          \
+                                                                                                   \
+        for (;; n += (width)) {                                                                    \
+            mask = stop_mask(load(++block));                                                       \
+            if (mask != 0) {                                                                       \
+                return n + __builtin_ctz(mask);                                                    \
+            }                                                                                      \
+        }                                                                                          \
+    } while (0)
+
+#if defined(SCAN_X86) && defined(__SSE2__)
+#define SSE2_EQ(v, c) _mm_cmpeq_epi8((v), _mm_set1_epi8(c))
+#define SSE2_MASK(v) ((uint32_t)_mm_movemask_epi8(v))
+
+static inline uint32_t sse2_line_mask(__m128i v) {
+    return SSE2_MASK(_mm_or_si128(SSE2_EQ(v, '\n'), SSE2_EQ(v, '\0')));
+}
+
+static inline uint32_t sse2_blanks_mask(__m128i v) {
+    const __m128i blank = _mm_or_si128(_mm_or_si128(SSE2_EQ(v, ' '), SSE2_EQ(v, '\t')),
+                                       SSE2_EQ(v, '\r'));
+
+    return SSE2_MASK(blank) ^ 0xffff;
+}
+
+static inline uint32_t sse2_ident_mask(__m128i v) {
+    __m128i stop = _mm_or_si128(SSE2_EQ(v, '\0'), SSE2_EQ(v, ' '));
+    stop         = _mm_or_si128(stop, _mm_or_si128(SSE2_EQ(v, '\n'), SSE2_EQ(v, '.')));
+    stop         = _mm_or_si128(stop, _mm_or_si128(SSE2_EQ(v, '('), SSE2_EQ(v, ')')));
+    stop         = _mm_or_si128(stop, _mm_or_si128(SSE2_EQ(v, '['), SSE2_EQ(v, ']')));
+    stop         = _mm_or_si128(stop, _mm_or_si128(SSE2_EQ(v, '{'), SSE2_EQ(v, '}')));
+    stop         = _mm_or_si128(stop, _mm_or_si128(SSE2_EQ(v, ':'), SSE2_EQ(v, ';')));
+    stop         = _mm_or_si128(stop, SSE2_EQ(v, ','));
+
+    return SSE2_MASK(stop);
+}
+
+static inline uint32_t sse2_string_mask(__m128i v) {
+    return SSE2_MASK(
+        _mm_or_si128(_mm_or_si128(SSE2_EQ(v, '"'), SSE2_EQ(v, '\\')), SSE2_EQ(v, '\0')));
+}
+
+static size_t sse2_line(const char *p) {
+    SCAN_BLOCKS(p, __m128i, 16, _mm_load_si128, sse2_line_mask);
+}
+
+static size_t sse2_blanks(const char *p) {
+    SCAN_BLOCKS(p, __m128i, 16, _mm_load_si128, sse2_blanks_mask);
+}
+
+static size_t sse2_ident(const char *p) {
+    SCAN_BLOCKS(p, __m128i, 16, _mm_load_si128, sse2_ident_mask);
+}
+
+static size_t sse2_string(const char *p) {
+    SCAN_BLOCKS(p, __m128i, 16, _mm_load_si128, sse2_string_mask);
+}
+
+static const scan_ops_t sse2_ops = {
+    .name   = "sse2",
+    .line   = sse2_line,
+    .blanks = sse2_blanks,
+    .ident  = sse2_ident,
+    .string = sse2_string,
+};
+#endif // SSE2
+
+#if defined(SCAN_X86)
+// Compiled for AVX2 regardless of the build flags, and only called when CPUID reports it
+#define AVX2 __attribute__((target("avx2")))
+#define AVX2_EQ(v, c) _mm256_cmpeq_epi8((v), _mm256_set1_epi8(c))
+#define AVX2_MASK(v) ((uint32_t)_mm256_movemask_epi8(v))
+
+AVX2 static inline __m256i avx2_load(const __m256i *p) { return _mm256_load_si256(p); }
+
+AVX2 static inline uint32_t avx2_line_mask(__m256i v) {
+    return AVX2_MASK(_mm256_or_si256(AVX2_EQ(v, '\n'), AVX2_EQ(v, '\0')));
+}
+
+AVX2 static inline uint32_t avx2_blanks_mask(__m256i v) {
+    const __m256i blank = _mm256_or_si256(_mm256_or_si256(AVX2_EQ(v, ' '), AVX2_EQ(v, '\t')),
+                                          AVX2_EQ(v, '\r'));
+
+    return ~AVX2_MASK(blank);
+}
+
+AVX2 static inline uint32_t avx2_ident_mask(__m256i v) {
+    __m256i stop = _mm256_or_si256(AVX2_EQ(v, '\0'), AVX2_EQ(v, ' '));
+    stop         = _mm256_or_si256(stop, _mm256_or_si256(AVX2_EQ(v, '\n'), AVX2_EQ(v, '.')));
+    stop         = _mm256_or_si256(stop, _mm256_or_si256(AVX2_EQ(v, '('), AVX2_EQ(v, ')')));
+    stop         = _mm256_or_si256(stop, _mm256_or_si256(AVX2_EQ(v, '['), AVX2_EQ(v, ']')));
+    stop         = _mm256_or_si256(stop, _mm256_or_si256(AVX2_EQ(v, '{'), AVX2_EQ(v, '}')));
+    stop         = _mm256_or_si256(stop, _mm256_or_si256(AVX2_EQ(v, ':'), AVX2_EQ(v, ';')));
+    stop         = _mm256_or_si256(stop, AVX2_EQ(v, ','));
+
+    return AVX2_MASK(stop);
+}
+
+AVX2 static inline uint32_t avx2_string_mask(__m256i v) {
+    return AVX2_MASK(_mm256_or_si256(_mm256_or_si256(AVX2_EQ(v, '"'), AVX2_EQ(v, '\\')),
+                                     AVX2_EQ(v, '\0')));
+}
+
+AVX2 static size_t avx2_line(const char *p) {
+    SCAN_BLOCKS(p, __m256i, 32, avx2_load, avx2_line_mask);
+}
+
+AVX2 static size_t avx2_blanks(const char *p) {
+    SCAN_BLOCKS(p, __m256i, 32, avx2_load, avx2_blanks_mask);
+}
+
+AVX2 static size_t avx2_ident(const char *p) {
+    SCAN_BLOCKS(p, __m256i, 32, avx2_load, avx2_ident_mask);
+}
+
+AVX2 static size_t avx2_string(const char *p) {
+    SCAN_BLOCKS(p, __m256i, 32, avx2_load, avx2_string_mask);
+}
+
+static const scan_ops_t avx2_ops = {
+    .name   = "avx2",
+    .line   = avx2_line,
+    .blanks = avx2_blanks,
+    .ident  = avx2_ident,
+    .string = avx2_string,
+};
+#endif // SCAN_X86
+
+const scan_ops_t *scan = &scalar_ops;
+
+const scan_ops_t *scan_init(scan_impl_t impl) {
+    const scan_ops_t *best = &scalar_ops;
+
+#if defined(SCAN_X86)
+    __builtin_cpu_init();
+
+#if defined(__SSE2__)
+    if ((impl >= SCAN_SSE2) && __builtin_cpu_supports("sse2")) {
+        best = &sse2_ops;
+    }
+#endif
+
+    if ((impl >= SCAN_AVX2) && __builtin_cpu_supports("avx2")) {
+        best = &avx2_ops;
+    }
+#endif
+
+    scan = best;
+
+    return scan;
+}
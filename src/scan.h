@@ -0,0 +1,52 @@
+/**
+ * LBASIC Byte Scanning Public Definitions
+ * File: scan.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stddef.h>
+
+/* Byte Scanners
+ *
+ *  The lexer spends most of its time stepping over runs of bytes that cannot end what it is
+ *  reading: the text of a comment, blanks between tokens, the characters of an identifier or
+ *  string literal. These functions find the end of such a run, 16 or 32 bytes at a time where the
+ *  CPU allows it.
+ *
+ *  Each one returns the number of bytes from p up to (not including) the first byte that ends the
+ *  run. The text must be null-terminated, and a null byte always ends a run. Vector loads are
+ *  aligned, so they never cross into a page that holds none of the text. */
+typedef struct scan_ops_s {
+    const char *name;
+
+    // Up to the next '\n'
+    size_t (*line)(const char *p);
+
+    // Up to the next byte that is not ' ', '\t' or '\r'
+    size_t (*blanks)(const char *p);
+
+    // Up to the next byte that ends an identifier: ' ', '\n', ( ) [ ] { } : ; , .
+    size_t (*ident)(const char *p);
+
+    // Up to the next '"' or '\'
+    size_t (*string)(const char *p);
+} scan_ops_t;
+
+typedef enum scan_impl {
+    SCAN_SCALAR = 0,
+    SCAN_SSE2   = 1,
+    SCAN_AVX2   = 2,
+    SCAN_BEST   = 3, // The fastest one the CPU supports
+} scan_impl_t;
+
+// Scanners in use by the lexer. Set by scan_init().
+extern const scan_ops_t *scan;
+
+// Selects the scanners for impl. If this CPU does not support impl (checked with CPUID), the best
+// one it does support is selected instead. Returns the scanners selected.
+const scan_ops_t *scan_init(scan_impl_t impl);
+
+#endif // SCAN_H
@@ -0,0 +1,378 @@
+/**
+ * LBASIC Compile Server
+ * File: server.c
+ * Author: Liam M. Murphy
+ */
+
+#include "server.h"
+
+#include "driver.h"
+#include "error.h"
+#include "lexer.h"
+#include "source.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// A program the server has compiled
+typedef struct server_entry_s {
+    uint64_t hash;           // Of the program's source
+    size_t length;           // Of the program's source, which tells apart most sources that collide
+    uint64_t last_used;      // server->clock when it was last asked for
+    char *path;              // Where it was compiled from
+    compile_result_t result; // Its diagnostics, and its AST and scopes if it has no errors
+} server_entry_t;
+
+// The hash table takes a 32-bit key and hash, so a source's hash is split between them
+static uint32_t entry_key(uint64_t hash) { return (uint32_t)hash; }
+static uint32_t entry_hash(uint64_t hash) { return (uint32_t)(hash >> 32); }
+
+static void free_entry(server_entry_t *entry) {
+    compile_result_free(&entry->result);
+    free(entry->path);
+    free(entry);
+}
+
+static void cache_remove(server_t *server, server_entry_t *entry) {
+    ht_remove(server->cache, entry_key(entry->hash), entry_hash(entry->hash));
+    server->num_cached--;
+
+    free_entry(entry);
+}
+
+// Returns the entry for the source with the given hash and length, or NULL if there is none
+static server_entry_t *cache_lookup(server_t *server, uint64_t hash, size_t length) {
+    server_entry_t *entry =
+        (server_entry_t *)ht_lookup(server->cache, entry_key(hash), entry_hash(hash));
+
+    // Another source with the same key is of no use, and makes way for this one
+    if ((entry != NULL) && ((entry->hash != hash) || (entry->length != length))) {
+        cache_remove(server, entry);
+        entry = NULL;
+    }
+
+    return entry;
+}
+
+// Drops the program that was asked for least recently
+static void cache_evict(server_t *server) {
+    server_entry_t *oldest = NULL;
+
+    for (unsigned int idx = 0; idx < server->cache->capacity; idx++) {
+        server_entry_t *entry = (server_entry_t *)server->cache->slots[idx].data;
+
+        if ((entry != NULL) && ((oldest == NULL) || (entry->last_used < oldest->last_used))) {
+            oldest = entry;
+        }
+    }
+
+    if (oldest != NULL) {
+        cache_remove(server, oldest);
+    }
+}
+
+// Adds an entry for the program at path, which has yet to be compiled
+static server_entry_t *cache_insert(server_t *server, uint64_t hash, size_t length,
+                                    const char *path) {
+    if (server->num_cached >= SERVER_CACHE_SIZE) {
+        cache_evict(server);
+    }
+
+    server_entry_t *entry = (server_entry_t *)calloc(1, sizeof(server_entry_t));
+    if (entry == NULL) {
+        log_error("Unable to allocate memory to cache '%s'", path);
+    }
+
+    entry->hash   = hash;
+    entry->length = length;
+    entry->path   = strdup(path);
+
+    ht_insert(server->cache, entry_key(hash), entry_hash(hash), entry);
+    server->num_cached++;
+
+    return entry;
+}
+
+// Writes all len bytes at buf to fd. Returns false if the other end has gone away.
+static bool send_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        const ssize_t sent = send(fd, buf, len, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        buf += sent;
+        len -= (size_t)sent;
+    }
+
+    return true;
+}
+
+static void socket_address(struct sockaddr_un *addr, const char *socket_path) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (strlen(socket_path) >= sizeof(addr->sun_path)) {
+        log_error("Socket path '%s' is longer than %zu characters", socket_path,
+                  sizeof(addr->sun_path) - 1);
+    }
+
+    strcpy(addr->sun_path, socket_path);
+}
+
+// Connects to the server at socket_path. Returns -1 if there is none.
+static int connect_to(const char *socket_path) {
+    struct sockaddr_un addr;
+    socket_address(&addr, socket_path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        log_error("Unable to create a socket: %s", strerror(errno));
+    }
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Sends one reply. Returns false if the client has gone away.
+static bool reply(int conn, int status, const char *output, size_t output_len) {
+    char header[64];
+    const int header_len = snprintf(header, sizeof(header), "%d %zu\n", status, output_len);
+
+    return send_all(conn, header, (size_t)header_len) && send_all(conn, output, output_len);
+}
+
+// Compiles a program that is not cached, and never will be, as it is not named as a program must
+// be. Returns false if the client has gone away.
+static bool answer_uncached(int conn, const char *path) {
+    compile_result_t result;
+    compile_kept(path, NULL, &result);
+
+    const bool sent = reply(conn, result.status, result.output, result.output_len);
+    compile_result_free(&result);
+
+    return sent;
+}
+
+// Answers a request for the program at path. Returns false if the client has gone away.
+static bool answer(server_t *server, int conn, const char *path) {
+    // The cache is keyed by content alone, so a program with the same text under a name that is
+    // not allowed must not be answered from it
+    if ((path[0] == '/') && !has_source_extension(path)) {
+        return answer_uncached(conn, path);
+    }
+
+    const double start = now_ms();
+    source_t *src      = (path[0] == '/') ? source_open(path) : NULL;
+
+    if (src == NULL) {
+        char message[MAX_ERROR_LEN];
+        const int len = snprintf(message, sizeof(message), "[ERROR]: Unable to open '%s'%s\n", path,
+                                 (path[0] == '/') ? "" : ". The server needs absolute paths.");
+
+        return reply(conn, COMPILER_ERROR_UNKNOWN_PATH, message,
+                     ((size_t)len < sizeof(message)) ? (size_t)len : sizeof(message) - 1);
+    }
+
+    const uint64_t hash = source_hash(src);
+    const size_t length = src->length;
+
+    server_entry_t *entry = cache_lookup(server, hash, length);
+    const bool cached     = (entry != NULL);
+
+    if (cached) {
+        source_free(src);
+        server->hits++;
+    } else {
+        // Compiled from the text that was hashed, which the file may no longer hold
+        entry = cache_insert(server, hash, length, path);
+        compile_kept(entry->path, src, &entry->result);
+        server->misses++;
+    }
+
+    entry->last_used = ++server->clock;
+
+    if (server->log != NULL) {
+        fprintf(server->log, "%10.2f ms  %-8s %-4d %s\n", now_ms() - start,
+                cached ? "cached" : "compiled", entry->result.status, path);
+        fflush(server->log);
+    }
+
+    return reply(conn, entry->result.status, entry->result.output, entry->result.output_len);
+}
+
+// Answers each request sent over conn until the client is done. Returns false if it asked the
+// server to stop.
+static bool serve_connection(server_t *server, int conn) {
+    FILE *in = fdopen(conn, "r");
+    if (in == NULL) {
+        log_error("Unable to read from a client: %s", strerror(errno));
+    }
+
+    bool running = true;
+    char *line   = NULL;
+    size_t cap   = 0;
+    ssize_t len  = 0;
+
+    while ((len = getline(&line, &cap, in)) > 0) {
+        if (line[len - 1] == '\n') {
+            line[len - 1] = '\0';
+        }
+
+        if (strcmp(line, SERVER_STOP_REQUEST) == 0) {
+            running = false;
+            break;
+        }
+
+        if (!answer(server, conn, line)) {
+            break;
+        }
+    }
+
+    free(line);
+    fclose(in);
+
+    return running;
+}
+
+void server_open(server_t *server, const char *socket_path, FILE *log) {
+    struct sockaddr_un addr;
+    socket_address(&addr, socket_path);
+
+    // A socket nobody answers on was left by a server that did not stop cleanly
+    struct stat st;
+    if ((lstat(socket_path, &st) == 0) && S_ISSOCK(st.st_mode)) {
+        const int fd = connect_to(socket_path);
+        if (fd >= 0) {
+            close(fd);
+            log_error("A server is already listening on '%s'", socket_path);
+        }
+
+        unlink(socket_path);
+    }
+
+    *server             = (server_t){0};
+    server->socket_path = socket_path;
+    server->log         = log;
+    server->cache       = ht_new();
+    server->listen_fd   = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if ((server->listen_fd < 0) ||
+        (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+        (listen(server->listen_fd, SOMAXCONN) != 0)) {
+        log_error("Unable to listen on '%s': %s", socket_path, strerror(errno));
+    }
+}
+
+void server_run(server_t *server) {
+    bool running = true;
+
+    while (running) {
+        const int conn = accept(server->listen_fd, NULL, NULL);
+
+        if (conn < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_error("Unable to accept a connection on '%s': %s", server->socket_path,
+                      strerror(errno));
+        }
+
+        running = serve_connection(server, conn);
+    }
+
+    close(server->listen_fd);
+    unlink(server->socket_path);
+
+    for (unsigned int idx = 0; idx < server->cache->capacity; idx++) {
+        server_entry_t *entry = (server_entry_t *)server->cache->slots[idx].data;
+
+        if (entry != NULL) {
+            compile_result_free(&entry->result);
+            free(entry->path);
+        }
+    }
+
+    // Frees the entries themselves
+    ht_free(&server->cache);
+    server->num_cached = 0;
+}
+
+int server_request(const char *socket_path, char **paths, unsigned int count, FILE *report) {
+    const int fd = connect_to(socket_path);
+    if (fd < 0) {
+        log_error("No server is listening on '%s'", socket_path);
+    }
+
+    FILE *in = fdopen(fd, "r");
+    if (in == NULL) {
+        log_error("Unable to read from the server: %s", strerror(errno));
+    }
+
+    int retval  = 0;
+    char *line  = NULL;
+    size_t cap  = 0;
+    char *input = NULL;
+
+    for (unsigned int idx = 0; idx < count; idx++) {
+        // The server runs in a directory of its own
+        char *absolute      = realpath(paths[idx], NULL);
+        const char *request = (absolute != NULL) ? absolute : paths[idx];
+        int status          = 0;
+        size_t output_len   = 0;
+
+        if (!send_all(fd, request, strlen(request)) || !send_all(fd, "\n", 1) ||
+            (getline(&line, &cap, in) <= 0) ||
+            (sscanf(line, "%d %zu", &status, &output_len) != 2)) {
+            log_error("Lost the server on '%s' while compiling '%s'", socket_path, paths[idx]);
+        }
+
+        input = (char *)realloc(input, output_len + 1);
+        if ((input == NULL) || (fread(input, 1, output_len, in) != output_len)) {
+            log_error("Lost the server on '%s' while compiling '%s'", socket_path, paths[idx]);
+        }
+
+        if (report != NULL) {
+            if ((count > 1) && (output_len > 0)) {
+                fprintf(report, "==> %s <==\n", paths[idx]);
+            }
+            fwrite(input, 1, output_len, report);
+        }
+
+        if ((status != 0) && (retval == 0)) {
+            retval = status;
+        }
+
+        free(absolute);
+    }
+
+    free(input);
+    free(line);
+    fclose(in);
+
+    return retval;
+}
+
+void server_stop(const char *socket_path) {
+    const int fd = connect_to(socket_path);
+    if (fd < 0) {
+        log_error("No server is listening on '%s'", socket_path);
+    }
+
+    const char request[] = SERVER_STOP_REQUEST "\n";
+    send_all(fd, request, strlen(request));
+    close(fd);
+}
@@ -0,0 +1,59 @@
+/**
+ * LBASIC Compile Server Public Definitions
+ * File: server.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "hashtable.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Most programs a server keeps at once. The one used least recently makes way for a new one.
+#define SERVER_CACHE_SIZE 256
+
+// Request that stops the server. Any other request is the absolute path to a program.
+#define SERVER_STOP_REQUEST "stop"
+
+/* Compile Server
+ *
+ *  Listens on a Unix socket and compiles the programs clients ask for. Each program compiled is
+ *  kept in memory, its AST, scopes and diagnostics, keyed by a hash of its source text. A program
+ *  whose source has not changed since it was last compiled is answered from the cache, without
+ *  being lexed, parsed or typechecked again.
+ *
+ *  A request is one line holding the absolute path to a program. The reply is a line holding the
+ *  program's status (see compile_result_t) and the length of its diagnostics, then the diagnostics
+ *  themselves. A client may send any number of requests over one connection. Connections are
+ *  answered one at a time, so the cache needs no locking. */
+typedef struct server_s {
+    int listen_fd;           // The listening socket
+    const char *socket_path; // Where it is bound, removed when the server stops
+    hashtable *cache;        // server_entry_t, keyed by the hash of a program's source
+    unsigned int num_cached; // Programs in the cache
+    uint64_t clock;          // Requests answered, which stamps each entry as it is used
+    unsigned int hits;       // Requests answered from the cache
+    unsigned int misses;     // Requests that had to be compiled
+    FILE *log;               // Gets a line per request, or NULL
+} server_t;
+
+// Binds server to a Unix socket at socket_path and starts listening. A stale socket left there by
+// an earlier server is replaced. Each request is logged to log, unless it is NULL.
+void server_open(server_t *server, const char *socket_path, FILE *log);
+
+// Answers requests until one asks the server to stop, then closes the socket and frees the cache
+void server_run(server_t *server);
+
+// Asks the server at socket_path to compile each of count paths, and prints each program's
+// diagnostics to report, or nothing if report is NULL. Returns the status of the first program
+// that failed, or 0.
+int server_request(const char *socket_path, char **paths, unsigned int count, FILE *report);
+
+// Asks the server at socket_path to stop
+void server_stop(const char *socket_path);
+
+#endif // SERVER_H
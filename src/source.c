@@ -0,0 +1,221 @@
+/**
+ * LBASIC Source Buffer Module
+ * File: source.c
+ * Author: Liam M. Murphy
+ */
+
+#include "source.h"
+
+#include "error.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define INITIAL_LINE_CAPACITY 64
+#define INITIAL_READ_CAPACITY 4096
+
+// FNV-1a, 64 bits wide, as whole programs are told apart by their hash alone
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+// Records the offset of the start of every line in a single pass over the buffer
+static void index_lines(source_t *src) {
+    unsigned int capacity = INITIAL_LINE_CAPACITY;
+
+    src->lines     = (unsigned int *)malloc(capacity * sizeof(unsigned int));
+    src->num_lines = 0;
+
+    if (src->lines == NULL) {
+        log_error("Unable to allocate line index");
+    }
+
+    size_t offset = 0;
+    while (offset < src->length) {
+        if (src->num_lines == capacity) {
+            capacity *= 2;
+            src->lines = (unsigned int *)realloc(src->lines, capacity * sizeof(unsigned int));
+
+            if (src->lines == NULL) {
+                log_error("Unable to grow line index to %u lines", capacity);
+            }
+        }
+
+        src->lines[src->num_lines++] = offset;
+
+        // Skip to the beginning of the next line
+        const char *nl = memchr(src->buffer + offset, '\n', src->length - offset);
+        if (nl == NULL) {
+            break;
+        }
+
+        offset = (nl - src->buffer) + 1;
+    }
+}
+
+/* Maps size bytes of the regular file fd read-only and stores the length of the reservation in
+ * map_length.
+ *
+ *  The lexer relies on the program text being null-terminated. The kernel zero fills the rest of
+ *  the last page of a mapping, but when the file size is an exact multiple of the page size there
+ *  is no rest of the page, and reading one byte past the end would fault. So we first reserve an
+ *  anonymous (zeroed) region one byte longer than the file, rounded up to whole pages, and then
+ *  map the file over the beginning of it. */
+static char *map_file(int fd, size_t size, size_t *map_length) {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t span = ((size + 1 + page - 1) / page) * page;
+
+    char *base = mmap(NULL, span, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, span);
+        return NULL;
+    }
+
+    *map_length = span;
+
+    return base;
+}
+
+// Reads everything remaining on fd into a null-terminated heap buffer. Used for pipes, terminals
+// and anything else that cannot be mapped.
+static char *read_stream(int fd, size_t *size) {
+    size_t capacity = INITIAL_READ_CAPACITY;
+    size_t length   = 0;
+    char *buffer    = (char *)malloc(capacity);
+
+    if (buffer == NULL) {
+        log_error("Unable to allocate source buffer");
+    }
+
+    for (;;) {
+        // Always keep room for the null terminator
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            buffer = (char *)realloc(buffer, capacity);
+
+            if (buffer == NULL) {
+                log_error("Unable to grow source buffer to %zu bytes", capacity);
+            }
+        }
+
+        const ssize_t n = read(fd, buffer + length, capacity - length - 1);
+        if (n == 0) {
+            break;
+        } else if (n < 0) {
+            free(buffer);
+            return NULL;
+        }
+
+        length += n;
+    }
+
+    buffer[length] = '\0';
+    *size          = length;
+
+    return buffer;
+}
+
+source_t *source_open(const char *path) {
+    source_t *retval = NULL;
+
+    const bool from_stdin = (strcmp(path, SOURCE_STDIN_PATH) == 0);
+    const int fd          = from_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t map_length = 0;
+        char *buffer      = map_file(fd, st.st_size, &map_length);
+
+        if (buffer != NULL) {
+            trace(TRACE_LEXER, TRACE_INFO, "Mapped %ld bytes of %s", (long)st.st_size, path);
+
+            retval = source_new(buffer, st.st_size);
+            if (retval != NULL) {
+                retval->mapped     = true;
+                retval->map_length = map_length;
+            } else {
+                munmap(buffer, map_length);
+            }
+        }
+    }
+
+    // Not a regular file, empty, or the mapping failed. Fall back to reading it.
+    if (retval == NULL) {
+        size_t size  = 0;
+        char *buffer = read_stream(fd, &size);
+
+        if (buffer != NULL) {
+            trace(TRACE_LEXER, TRACE_INFO, "Read %zu bytes of %s", size, path);
+            retval = source_new(buffer, size);
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    if (!from_stdin) {
+        close(fd);
+    }
+
+    return retval;
+}
+
+source_t *source_new(char *buffer, size_t length) {
+    source_t *retval = (source_t *)calloc(1, sizeof(source_t));
+
+    if (retval != NULL) {
+        retval->buffer = buffer;
+        retval->length = length;
+
+        index_lines(retval);
+    }
+
+    return retval;
+}
+
+uint64_t source_hash(const source_t *src) {
+    uint64_t hash = FNV64_OFFSET_BASIS;
+
+    for (size_t idx = 0; idx < src->length; idx++) {
+        hash ^= (unsigned char)src->buffer[idx];
+        hash *= FNV64_PRIME;
+    }
+
+    return hash;
+}
+
+void source_free(source_t *src) {
+    if (src != NULL) {
+        if (src->mapped) {
+            munmap((void *)src->buffer, src->map_length);
+        } else {
+            free((void *)src->buffer);
+        }
+        free(src->lines);
+        free(src);
+    }
+}
+
+const char *source_line(const source_t *src, unsigned int line, size_t *len) {
+    *len = 0;
+
+    if (src == NULL || line == 0 || line > src->num_lines) {
+        return "";
+    }
+
+    const unsigned int start = src->lines[line - 1];
+    const size_t end         = (line < src->num_lines) ? src->lines[line] : src->length;
+
+    *len = end - start;
+
+    return src->buffer + start;
+}
@@ -0,0 +1,49 @@
+/**
+ * LBASIC Source Buffer Public Definitions
+ * File: source.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Path that reads the program from standard input
+#define SOURCE_STDIN_PATH "-"
+
+/* Source Buffer
+ *
+ *  The text of the program being compiled, plus an index of where each of its lines begins.
+ *  Tokens refer to their text by offset into the buffer, and diagnostics look up the text of a
+ *  line by number in constant time. */
+typedef struct source_s {
+    const char *buffer; // Null-terminated program text
+    size_t length;
+    unsigned int *lines; // Offset of the first byte of each line. lines[0] is line 1.
+    unsigned int num_lines;
+    bool mapped;       // buffer is a read-only mapping of the file rather than a heap copy
+    size_t map_length; // Bytes reserved for the mapping, including the terminating zero page
+} source_t;
+
+// Opens the program at path. Regular files are mapped read-only, so the lexer works directly on
+// the page cache. Pipes, terminals and standard input (SOURCE_STDIN_PATH) are read into memory
+// instead. Returns NULL if path cannot be opened.
+source_t *source_open(const char *path);
+
+// Takes ownership of buffer (length bytes, plus a null terminator) and indexes its lines
+source_t *source_new(char *buffer, size_t length);
+
+// Free a source buffer and its line index
+void source_free(source_t *src);
+
+// 64-bit FNV-1a hash of the program text, which tells programs apart by their content
+uint64_t source_hash(const source_t *src);
+
+// Returns a pointer to the start of a line (numbered from 1) and stores its length, including the
+// newline, in len. Lines that do not exist are empty.
+const char *source_line(const source_t *src, unsigned int line, size_t *len);
+
+#endif // SOURCE_H
@@ -0,0 +1,144 @@
+/**
+ * String Table Module
+ * File: strtab.c
+ * Author: Liam M. Murphy
+ */
+
+#include "strtab.h"
+
+#include "error.h"
+
+#include <string.h>
+
+#define STRTAB_INITIAL_CAPACITY 256
+
+// FNV-1a offset basis, the hash of the empty string
+#define FNV_OFFSET_BASIS 2166136261U
+
+static strtab_entry_t empty_entry = {.hash = FNV_OFFSET_BASIS, .id = 0, .length = 0, .str = ""};
+
+const char *const strtab_empty = empty_entry.str;
+
+strtab_t *strtab_new(arena_t *arena) {
+    strtab_t *retval = (strtab_t *)arena_alloc(arena, sizeof(strtab_t));
+
+    retval->arena    = arena;
+    retval->capacity = STRTAB_INITIAL_CAPACITY;
+    retval->count    = 1;
+
+    retval->slots =
+        (strtab_entry_t **)arena_alloc(arena, STRTAB_INITIAL_CAPACITY * sizeof(strtab_entry_t *));
+
+    // At most half of the slots are ever used, so entries is grown along with them
+    retval->entries = (strtab_entry_t **)arena_alloc(
+        arena, (STRTAB_INITIAL_CAPACITY / 2 + 1) * sizeof(strtab_entry_t *));
+    retval->entries[0] = &empty_entry;
+
+    return retval;
+}
+
+// FNV-1a. Probes here start from it, and the symbol table reuses it as the hash of each key.
+static uint32_t strtab_hash(const char *str, size_t len) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619;
+    }
+
+    return hash;
+}
+
+// Doubles the number of slots, and the room for entries with them. The old arrays stay in the
+// arena until it is freed; they add up to less than the new ones.
+static void strtab_grow(strtab_t *tab) {
+    const unsigned int new_capacity = tab->capacity * 2;
+    strtab_entry_t **new_slots =
+        (strtab_entry_t **)arena_alloc(tab->arena, new_capacity * sizeof(strtab_entry_t *));
+    strtab_entry_t **new_entries = (strtab_entry_t **)arena_alloc(
+        tab->arena, (new_capacity / 2 + 1) * sizeof(strtab_entry_t *));
+
+    memcpy(new_entries, tab->entries, tab->count * sizeof(strtab_entry_t *));
+
+    for (unsigned int idx = 0; idx < tab->capacity; idx++) {
+        strtab_entry_t *entry = tab->slots[idx];
+
+        if (entry != NULL) {
+            unsigned int slot = entry->hash & (new_capacity - 1);
+            while (new_slots[slot] != NULL) {
+                slot = (slot + 1) & (new_capacity - 1);
+            }
+
+            new_slots[slot] = entry;
+        }
+    }
+
+    tab->slots    = new_slots;
+    tab->entries  = new_entries;
+    tab->capacity = new_capacity;
+}
+
+const char *strtab_intern(strtab_t *tab, const char *str, size_t len) {
+    if (len == 0) {
+        return strtab_empty;
+    }
+
+    const uint32_t hash = strtab_hash(str, len);
+    unsigned int slot   = hash & (tab->capacity - 1);
+
+    // Linear probing
+    while (tab->slots[slot] != NULL) {
+        const strtab_entry_t *entry = tab->slots[slot];
+
+        if (entry->hash == hash && entry->length == len && memcmp(entry->str, str, len) == 0) {
+            return entry->str;
+        }
+
+        slot = (slot + 1) & (tab->capacity - 1);
+    }
+
+    strtab_entry_t *entry = (strtab_entry_t *)arena_alloc(tab->arena, sizeof(*entry) + len + 1);
+
+    entry->hash   = hash;
+    entry->id     = tab->count;
+    entry->length = (uint32_t)len;
+    memcpy(entry->str, str, len);
+    entry->str[len] = '\0';
+
+    tab->slots[slot]           = entry;
+    tab->entries[tab->count++] = entry;
+
+    // Keep at least half of the slots empty, so probe sequences stay short
+    if (tab->count * 2 > tab->capacity) {
+        strtab_grow(tab);
+    }
+
+    return entry->str;
+}
+
+const char *strtab_adopt(strtab_t *tab, strtab_entry_t *entry) {
+    if (entry->id != tab->count) {
+        log_error("strtab_adopt(): Expected string id %u, not %u", tab->count, entry->id);
+    }
+
+    unsigned int slot = entry->hash & (tab->capacity - 1);
+    while (tab->slots[slot] != NULL) {
+        slot = (slot + 1) & (tab->capacity - 1);
+    }
+
+    tab->slots[slot]           = entry;
+    tab->entries[tab->count++] = entry;
+
+    if (tab->count * 2 > tab->capacity) {
+        strtab_grow(tab);
+    }
+
+    return entry->str;
+}
+
+const char *strtab_name(const strtab_t *tab, uint32_t id) {
+    if (id >= tab->count) {
+        log_error("strtab_name(): No string has id %u", id);
+    }
+
+    return tab->entries[id]->str;
+}
@@ -0,0 +1,66 @@
+/**
+ * String Table Public Definitions
+ * File: strtab.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef STRTAB_H
+#define STRTAB_H
+
+#include "arena.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// An interned string. Handles point at str, which is null-terminated.
+typedef struct strtab_entry_s {
+    uint32_t hash; // FNV-1a of the string, computed once when it is interned
+    uint32_t id;   // Index within the table's entries, in the order strings were first interned
+    uint32_t length;
+    char str[];
+} strtab_entry_t;
+
+/* String Table
+ *
+ *  Holds the names and string literals of one program. Each distinct string is stored once, in
+ *  the program's arena, and interning it again returns the same pointer. Two interned strings are
+ *  therefore equal exactly when their pointers are.
+ *
+ *  Each string also has a small integer id, which the lexer stores in its tokens and the symbol
+ *  table uses as its key. The id and hash travel with the string, so they are never recomputed. */
+typedef struct strtab_s {
+    arena_t *arena;           // Where the strings and the table itself live
+    strtab_entry_t **slots;   // Open addressing, NULL where empty
+    strtab_entry_t **entries; // Indexed by id. Id 0 is the empty string.
+    unsigned int capacity;    // Number of slots, always a power of two
+    unsigned int count;       // Number of entries, the empty string included
+} strtab_t;
+
+// The empty string, with id 0. Interning "" returns it, and names that have not been set point to
+// it.
+extern const char *const strtab_empty;
+
+// Allocate a new string table within arena
+strtab_t *strtab_new(arena_t *arena);
+
+// Returns the interned copy of the len bytes at str, adding one if there is none yet
+const char *strtab_intern(strtab_t *tab, const char *str, size_t len);
+
+// Adds entry, a string not yet in tab whose hash and length are set, without copying it, and
+// returns its text. Its id must be the next one, tab->count. entry must outlive tab; the AST cache
+// (astcache.h) adopts strings straight from the file it maps.
+const char *strtab_adopt(strtab_t *tab, strtab_entry_t *entry);
+
+// Returns the string with the given id
+const char *strtab_name(const strtab_t *tab, uint32_t id);
+
+// Returns the entry of an interned string
+static inline const strtab_entry_t *strtab_entry(const char *name) {
+    return (const strtab_entry_t *)(name - offsetof(strtab_entry_t, str));
+}
+
+// Id and hash of an interned string
+static inline uint32_t strtab_id(const char *name) { return strtab_entry(name)->id; }
+static inline uint32_t strtab_hash_of(const char *name) { return strtab_entry(name)->hash; }
+
+#endif // STRTAB_H
@@ -7,7 +7,6 @@
 #include "symtab.h"
 #include "error.h"
 
-#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,66 +14,129 @@
 #define MAX_CHILD_OBJ_STR 4096
 #define MAX_CHILD_OBJ_LIST_STR 16384
 
-// Compare bindings by name
-bool ht_compare_binding(vecnode *vn, void *key) {
-    bool retval = false;
-
-    binding_t *b = (binding_t *)vn->data;
-    retval       = (strcmp(b->name, (char *)key) == 0);
-
-    return retval;
-}
+#define SYMTAB_INITIAL_SCOPES 8
+#define SYMTAB_INITIAL_LOG 32
 
 /* Symbol table interface */
 symtab_t *symtab_new(void) {
     symtab_t *retval = (symtab_t *)calloc(1, sizeof(symtab_t));
 
     if (retval != NULL) {
-        retval->level = 0;
         retval->table = ht_new();
-        retval->prev  = NULL;
-        retval->next  = NULL;
-
         if (retval->table == NULL) {
             log_error("Failed to allocate hash table");
         }
+
+        // The global scope is open for as long as the table exists
+        symtab_enter(retval, strtab_empty);
     }
 
     return retval;
 }
 
+void symtab_free(symtab_t *st) {
+    if (st != NULL) {
+        while (st->depth > 0) {
+            symtab_leave(st);
+        }
+
+        ht_free(&st->table);
+        free(st->log);
+        free(st->scopes);
+        free(st);
+    }
+}
+
+void symtab_enter(symtab_t *st, const char *name) {
+    if (st->depth == st->scopes_capacity) {
+        const unsigned int capacity =
+            (st->scopes_capacity > 0) ? st->scopes_capacity * 2 : SYMTAB_INITIAL_SCOPES;
+        scope_t *scopes = (scope_t *)realloc(st->scopes, capacity * sizeof(scope_t));
+
+        if (scopes == NULL) {
+            log_error("Unable to grow the symbol table to %u scopes", capacity);
+        }
+
+        st->scopes          = scopes;
+        st->scopes_capacity = capacity;
+    }
+
+    scope_t *scope = &st->scopes[st->depth];
+    scope->level   = st->depth++;
+    scope->name    = (name != NULL) ? name : strtab_empty;
+    scope->mark    = st->log_count;
+
+    debug(TRACE_SYMTAB, "Entered scope level %u (name='%s')", scope->level, scope->name);
+}
+
+void symtab_leave(symtab_t *st) {
+    if (st->depth == 0) {
+        log_error("Unable to leave a scope when none are open");
+    }
+
+    const scope_t *scope = &st->scopes[--st->depth];
+
+    // Undo the scope's bindings latest first, so each name gets back the binding it had on entry
+    while (st->log_count > scope->mark) {
+        binding_t *b = st->log[--st->log_count];
+
+        ht_remove(st->table, strtab_id(b->name), strtab_hash_of(b->name));
+        if (b->shadowed != NULL) {
+            ht_insert(st->table, strtab_id(b->name), strtab_hash_of(b->name), b->shadowed);
+        }
+
+        free(b);
+    }
+
+    debug(TRACE_SYMTAB, "Left scope level %u (name='%s')", scope->level, scope->name);
+}
+
+scope_t *symtab_scope(symtab_t *st) { return &st->scopes[st->depth - 1]; }
+
 void symtab_insert(symtab_t *st, binding_t *binding) {
     if (st != NULL) {
-        ht_insert(st->table, binding->name, binding);
+        const uint32_t id   = strtab_id(binding->name);
+        const uint32_t hash = strtab_hash_of(binding->name);
 
-        debug("Added '%s' (symbol type %d) to scope level %d", binding->name, binding->symbol_type,
-              st->level);
+        if (st->log_count == st->log_capacity) {
+            const unsigned int capacity =
+                (st->log_capacity > 0) ? st->log_capacity * 2 : SYMTAB_INITIAL_LOG;
+            binding_t **log = (binding_t **)realloc(st->log, capacity * sizeof(binding_t *));
+
+            if (log == NULL) {
+                log_error("Unable to grow the symbol table to %u bindings", capacity);
+            }
+
+            st->log          = log;
+            st->log_capacity = capacity;
+        }
+
+        // The new binding hides any other of the same name until its scope is left
+        binding->level    = st->depth - 1;
+        binding->shadowed = (binding_t *)ht_remove(st->table, id, hash);
+        ht_insert(st->table, id, hash, binding);
+
+        st->log[st->log_count++] = binding;
+
+        debug(TRACE_SYMTAB, "Added '%s' (symbol type %d) to scope level %d", binding->name,
+              binding->symbol_type, binding->level);
     } else {
         log_error("Symbol table is NULL");
     }
 }
 
-binding_t *symtab_lookup(symtab_t *scope, char *identifier, bool single_scope) {
+binding_t *symtab_lookup(symtab_t *st, const char *identifier, bool single_scope) {
     binding_t *retval = NULL;
 
-    if (scope != NULL) {
-        debug("%s(): Looking for '%s' within scope level %d (name='%s')", __FUNCTION__, identifier,
-              scope->level, scope->name);
-        retval = ht_lookup(scope->table, (char *)identifier, ht_compare_binding);
-
-        // Nothing found
-        if (NULL == retval) {
-            // If single_scope is true, we are limiting our search to the current scope only
-            if (!single_scope) {
-                // Otherwise, potentially search parent scopes
-                if (scope->prev == NULL) {
-                    // If we are already in the global scope, we didn't find anything
-                    return NULL;
-                } else {
-                    // If the identifier isn't found in the current scope, look in its parent
-                    retval = symtab_lookup(scope->prev, identifier, single_scope);
-                }
-            }
+    if (st != NULL) {
+        trace(TRACE_SYMTAB, TRACE_VERBOSE,
+              "%s(): Looking for '%s' within scope level %d (name='%s')", __FUNCTION__, identifier,
+              symtab_scope(st)->level, symtab_scope(st)->name);
+        retval = ht_lookup(st->table, strtab_id(identifier), strtab_hash_of(identifier));
+
+        // The innermost binding of the name is the only one that can be in the current scope
+        if (single_scope && retval != NULL && retval->level != symtab_scope(st)->level) {
+            retval = NULL;
         }
     } else {
         log_error("Symbol table is NULL");
@@ -83,13 +145,41 @@ binding_t *symtab_lookup(symtab_t *scope, char *identifier, bool single_scope) {
     return retval;
 }
 
-void symtab_free(symtab_t *st) { assert(false && "Not implemented"); }
+binding_t *symtab_lookup_enclosing(symtab_t *st, const char *identifier) {
+    binding_t *retval = symtab_lookup(st, identifier, false);
+
+    while (retval != NULL && retval->level >= symtab_scope(st)->level) {
+        retval = retval->shadowed;
+    }
+
+    return retval;
+}
 
 binding_t *mk_binding(symbol_type_t symbol_type) {
     binding_t *retval = (binding_t *)calloc(1, sizeof(binding_t));
 
     if (NULL != retval) {
         retval->symbol_type = symbol_type;
+        retval->name        = strtab_empty;
+
+        switch (symbol_type) {
+            case SYMBOL_TYPE_FUNCTION:
+                retval->data.function_type.struct_type = strtab_empty;
+                break;
+            case SYMBOL_TYPE_VARIABLE:
+            case SYMBOL_TYPE_FORMAL:
+                retval->data.variable_type.struct_type = strtab_empty;
+                break;
+            case SYMBOL_TYPE_STRUCTURE:
+                retval->data.structure_type.struct_type = strtab_empty;
+                break;
+            case SYMBOL_TYPE_MEMBER:
+                retval->data.member_type.parent_struct = strtab_empty;
+                retval->data.member_type.struct_type   = strtab_empty;
+                break;
+            default:
+                break;
+        }
     }
 
     return retval;
@@ -99,9 +189,8 @@ static void formals_to_str(vector *formals, char *str) {
     if (NULL != formals) {
         size_t offset = 0;
 
-        vecnode *vn = formals->head;
-        while (NULL != vn) {
-            node *f = (node *)vn->data;
+        for (int idx = 0; idx < vector_length(formals); idx++) {
+            node *f = (node *)vector_get(formals, idx);
             if (NULL != f) {
                 char formal_str[MAX_CHILD_OBJ_STR] = {'\0'};
                 // Build string
@@ -115,8 +204,6 @@ static void formals_to_str(vector *formals, char *str) {
                 // Copy into str
                 strncpy(str + offset, formal_str, strlen(formal_str));
                 offset += strlen(formal_str);
-
-                vn = vn->next;
             }
         }
     }
@@ -126,9 +213,8 @@ static void members_to_str(vector *members, char *str) {
     if (NULL != members) {
         size_t offset = 0;
 
-        vecnode *vn = members->head;
-        while (NULL != vn) {
-            node *m = (node *)vn->data;
+        for (int idx = 0; idx < vector_length(members); idx++) {
+            node *m = (node *)vector_get(members, idx);
             if (NULL != m) {
                 char member_str[MAX_CHILD_OBJ_STR] = {'\0'};
                 // Build string
@@ -138,8 +224,6 @@ static void members_to_str(vector *members, char *str) {
                 // Copy into str
                 strncpy(str + offset, member_str, strlen(member_str));
                 offset += strlen(member_str);
-
-                vn = vn->next;
             }
         }
     }
@@ -153,97 +237,77 @@ void print_binding(const binding_t *binding) {
                 char formals_str[MAX_CHILD_OBJ_LIST_STR] = {'\0'};
                 formals_to_str(binding->data.function_type.formals, formals_str);
 
-                printf("%s\tFUNCTION\t%s\tis_array: %d (dimensions=%d)\tis_struct: %d "
-                       "(struct_type='%s')\n\tFormals (num_args: %d):\n%s",
-                       binding->name, type_to_str(binding->data.function_type.return_type),
-                       binding->data.function_type.is_array_type,
-                       binding->data.function_type.num_dimensions,
-                       binding->data.function_type.is_struct_type,
-                       binding->data.function_type.struct_type,
-                       binding->data.function_type.num_args, formals_str);
+                diag_printf("%s\tFUNCTION\t%s\tis_array: %d (dimensions=%d)\tis_struct: %d "
+                            "(struct_type='%s')\n\tFormals (num_args: %d):\n%s",
+                            binding->name, type_to_str(binding->data.function_type.return_type),
+                            binding->data.function_type.is_array_type,
+                            binding->data.function_type.num_dimensions,
+                            binding->data.function_type.is_struct_type,
+                            binding->data.function_type.struct_type,
+                            binding->data.function_type.num_args, formals_str);
                 break;
             case SYMBOL_TYPE_VARIABLE:
-                printf("%s\tVARIABLE\t%s\tis_array: %d (dimensions=%d)\tis_struct: %d "
-                       "(struct_type='%s')\n",
-                       binding->name, type_to_str(binding->data.variable_type.type),
-                       binding->data.variable_type.is_array_type,
-                       binding->data.variable_type.num_dimensions,
-                       binding->data.variable_type.is_struct_type,
-                       binding->data.variable_type.struct_type);
+                diag_printf("%s\tVARIABLE\t%s\tis_array: %d (dimensions=%d)\tis_struct: %d "
+                            "(struct_type='%s')\n",
+                            binding->name, type_to_str(binding->data.variable_type.type),
+                            binding->data.variable_type.is_array_type,
+                            binding->data.variable_type.num_dimensions,
+                            binding->data.variable_type.is_struct_type,
+                            binding->data.variable_type.struct_type);
                 break;
             case SYMBOL_TYPE_FORMAL:
-                printf("%s\tFORMAL\t%s\tis_array: %d (dimensions=%d)\tis_struct: %d "
-                       "(struct_type='%s')\n",
-                       binding->name, type_to_str(binding->data.variable_type.type),
-                       binding->data.variable_type.is_array_type,
-                       binding->data.variable_type.num_dimensions,
-                       binding->data.variable_type.is_struct_type,
-                       binding->data.variable_type.struct_type);
+                diag_printf("%s\tFORMAL\t%s\tis_array: %d (dimensions=%d)\tis_struct: %d "
+                            "(struct_type='%s')\n",
+                            binding->name, type_to_str(binding->data.variable_type.type),
+                            binding->data.variable_type.is_array_type,
+                            binding->data.variable_type.num_dimensions,
+                            binding->data.variable_type.is_struct_type,
+                            binding->data.variable_type.struct_type);
                 break;
             case SYMBOL_TYPE_STRUCTURE:
                 char members_str[MAX_CHILD_OBJ_LIST_STR] = {'\0'};
                 members_to_str(binding->data.structure_type.members, members_str);
 
-                printf("%s\tSTRUCTURE\tstruct_type='%s'\n\tMembers (num_members=%d):\n%s",
-                       binding->name, binding->data.structure_type.struct_type,
-                       binding->data.structure_type.num_members, members_str);
+                diag_printf("%s\tSTRUCTURE\tstruct_type='%s'\n\tMembers (num_members=%d):\n%s",
+                            binding->name, binding->data.structure_type.struct_type,
+                            binding->data.structure_type.num_members, members_str);
                 break;
             case SYMBOL_TYPE_MEMBER:
-                printf("%s\tMEMBER\t%s (parent_struct: '%s')\n", binding->name,
-                       type_to_str(binding->data.member_type.type),
-                       binding->data.member_type.parent_struct);
+                diag_printf("%s\tMEMBER\t%s (parent_struct: '%s')\n", binding->name,
+                            type_to_str(binding->data.member_type.type),
+                            binding->data.member_type.parent_struct);
                 break;
             case SYMBOL_TYPE_UNKNOWN:
             default:
                 log_error("Unknown binding type (type=%d)", binding->symbol_type);
         }
-        printf("-----------------------------------------------------------------------------------"
-               "-----------------\n");
+        diag_printf("------------------------------------------------------------------------------"
+                    "----------------------\n");
     }
 }
 
-void print_symbol_table(const symtab_t *st) {
-    if (st->level != 0) {
-        log_error("%s() must be called on scope 0", __FUNCTION__);
-    }
+// Prints the bindings of one open scope in the order they were declared
+static void print_scope(const symtab_t *st, unsigned int level) {
+    const scope_t *scope   = &st->scopes[level];
+    const unsigned int end = (level + 1 < st->depth) ? st->scopes[level + 1].mark : st->log_count;
 
-    printf("NAME\tSYMBOL TYPE\tDATA TYPE\tETC.\n");
-    printf("======================================================================================="
-           "=============\n");
-    printf("Scope: %d (name='%s')\n", st->level, st->name);
-    for (int row = 0; row < MAX_SLOTS; row++) {
-        if (NULL != st->table->slots[row]) {
-            if (st->table->slots[row]->count > 1) {
-                debug("Table slot %d has more than one entry", row);
-            } else {
-                const binding_t *b = (binding_t *)st->table->slots[row]->head->data;
-                print_binding(b);
-            }
-        }
+    diag_printf("Scope: %d (name='%s')\n", scope->level, scope->name);
+    for (unsigned int idx = scope->mark; idx < end; idx++) {
+        print_binding(st->log[idx]);
     }
-    printf("======================================================================================="
-           "=============\n\n\n");
-
-    symtab_t *tab = st->next;
-    while (NULL != tab) {
-        printf("==================================================================================="
-               "===="
-               "=============\n");
-        printf("Scope: %d (name='%s')\n", tab->level, tab->name);
-        for (int row = 0; row < MAX_SLOTS; row++) {
-            if (NULL != tab->table->slots[row]) {
-                if (tab->table->slots[row]->count > 1) {
-                    debug("Table slot %d has more than one entry", row);
-                } else {
-                    const binding_t *b = (binding_t *)tab->table->slots[row]->head->data;
-                    print_binding(b);
-                }
-            }
-        }
-        printf("==================================================================================="
-               "===="
-               "=============\n\n\n");
+    diag_printf("=================================================================================="
+                "==================\n\n\n");
+}
 
-        tab = tab->next;
+void print_symbol_table(const symtab_t *st) {
+    diag_printf("NAME\tSYMBOL TYPE\tDATA TYPE\tETC.\n");
+    diag_printf("=================================================================================="
+                "==================\n");
+    print_scope(st, 0);
+
+    for (unsigned int level = 1; level < st->depth; level++) {
+        diag_printf("=============================================================================="
+                    "======================\n");
+        print_scope(st, level);
     }
-}
\ No newline at end of file
+}
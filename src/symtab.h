@@ -9,6 +9,7 @@
 
 #include "ast.h"
 #include "hashtable.h"
+#include "strtab.h"
 #include "token.h"
 #include "vector.h"
 
@@ -25,8 +26,9 @@ typedef enum symbol_type_s {
 } symbol_type_t;
 
 typedef struct b_function_s {
+    type_id_t type_id; // The function's signature
     data_type return_type;
-    char struct_type[MAX_LITERAL];
+    const char *struct_type;
     bool is_array_type;
     bool is_struct_type;
     unsigned int num_dimensions;
@@ -36,8 +38,9 @@ typedef struct b_function_s {
 
 // Can be used for either variables or formal args.
 typedef struct b_variable_s {
+    type_id_t type_id;
     data_type type;
-    char struct_type[MAX_LITERAL];
+    const char *struct_type;
     bool is_array_type;
     bool is_struct_type;
     unsigned int num_dimensions;
@@ -45,23 +48,27 @@ typedef struct b_variable_s {
 
 typedef struct b_structure_s {
     data_type type; // Always D_STRUCT
-    char struct_type[MAX_LITERAL];
+    const char *struct_type;
     unsigned int num_members;
     vector *members; // vector of member_decl_t, one for each member
 } b_structure_t;
 
 typedef struct b_member_s {
     data_type type;
-    char parent_struct[MAX_LITERAL]; // The structure type that contains this member
-    char struct_type[MAX_LITERAL];   // Not yet implemented within AST
-    bool is_array_type;              // Not yet implemented within AST
-    bool is_struct_type;             // Not yet implemented within AST
-    unsigned int num_dimensions;     // Not yet implemented within AST
+    const char *parent_struct;   // The structure type that contains this member
+    const char *struct_type;     // Not yet implemented within AST
+    bool is_array_type;          // Not yet implemented within AST
+    bool is_struct_type;         // Not yet implemented within AST
+    unsigned int num_dimensions; // Not yet implemented within AST
 } b_member_t;
 
+// Names and struct types are interned in the program's string table (strtab.h), and bindings are
+// keyed by the id of their name
 typedef struct binding_s {
-    char name[MAX_LITERAL];
+    const char *name;
     symbol_type_t symbol_type;
+    unsigned int level;         // Level of the scope the binding was declared in
+    struct binding_s *shadowed; // Binding of the same name from an outer scope that this one hides
     union {
         b_function_t function_type;
         b_variable_t variable_type;
@@ -70,25 +77,58 @@ typedef struct binding_s {
     } data;
 } binding_t;
 
-typedef struct symtab_s {
+typedef struct scope_s {
     unsigned int level;
-    char name[MAX_LITERAL];
-    //    bool seen;
-    hashtable *table;
-    struct symtab_s *prev;
-    struct symtab_s *next;
+    const char *name;  // Interned. The function or structure the scope belongs to, if any.
+    unsigned int mark; // Length of the undo log when the scope was entered
+} scope_t;
+
+/* Symbol Table
+ *
+ *  A single map from each name to the innermost binding of it, however many scopes are open. A
+ *  binding points to the one it shadows, so each name has a stack of bindings with the visible one
+ *  on top, and a lookup is one probe whatever the depth.
+ *
+ *  Every binding is also appended to an undo log. Entering a scope marks the log; leaving it pops
+ *  the bindings added since the mark, puts back the ones they hid and frees them. */
+typedef struct symtab_s {
+    hashtable *table; // Name id -> innermost binding
+    binding_t **log;  // Every binding in scope, in the order they were inserted
+    unsigned int log_count;
+    unsigned int log_capacity;
+    scope_t *scopes; // Open scopes, outermost (global) first
+    unsigned int depth;
+    unsigned int scopes_capacity;
 } symtab_t;
 
 /* Symbol table interface */
+
+// Allocate a new symbol table with the global scope open
 symtab_t *symtab_new(void);
-void symtab_insert(symtab_t *st, binding_t *binding);
-binding_t *symtab_lookup(symtab_t *st, char *identifier, bool single_scope);
+
+// Free a symbol table and every binding still in it
 void symtab_free(symtab_t *st);
 
-binding_t *mk_binding(symbol_type_t);
+// Open a scope within the current one. name is interned, or strtab_empty.
+void symtab_enter(symtab_t *st, const char *name);
 
-// Hashtable comparison callback. Tries to find match using binding_t*
-bool ht_compare_binding(vecnode *vn, void *key);
+// Close the current scope and free the bindings declared within it
+void symtab_leave(symtab_t *st);
+
+// The innermost open scope
+scope_t *symtab_scope(symtab_t *st);
+
+// Add a binding to the current scope. The symbol table owns it from then on.
+void symtab_insert(symtab_t *st, binding_t *binding);
+
+// Find the binding that identifier refers to, in the current scope only if single_scope is set.
+// identifier must be interned in the program's string table.
+binding_t *symtab_lookup(symtab_t *st, const char *identifier, bool single_scope);
+
+// Like symtab_lookup(), but skips the bindings of the current scope
+binding_t *symtab_lookup_enclosing(symtab_t *st, const char *identifier);
+
+binding_t *mk_binding(symbol_type_t);
 
 void print_binding(const binding_t *);
 void print_symbol_table(const symtab_t *);
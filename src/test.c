@@ -6,42 +6,1077 @@
 
 #include "test.h"
 
+#include <inttypes.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+#include "astcache.h"
+#include "driver.h"
+#include "error.h"
 #include "hashtable.h"
+#include "lexer.h"
+#include "parser.h"
+#include "scan.h"
+#include "server.h"
 #include "symtab.h"
+#include "token.h"
+#include "typechecker.h"
 #include "vector.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
 static void print_header() { printf("Running internal tests.......\n"); }
 
-static void print_string_vec(vector *v) {
-    if (v != NULL) {
-        vecnode *curr = v->head;
+// Layout of a token and its list node from before tokens were stored contiguously and pointed into
+// the source buffer, kept for comparison
+typedef struct {
+    token_type type;
+    char literal[MAX_LITERAL];
+    char line_str[4096];
+    unsigned int line;
+    unsigned int col;
+} legacy_token;
 
-        printf("Length: %d\n", vector_length(v));
+typedef struct legacy_t_list {
+    legacy_token *tok;
+    struct legacy_t_list *prev;
+    struct legacy_t_list *next;
+} legacy_t_list;
+
+// Writes count copies of stmt to a new temporary .lb file. The path is written into path, which
+// the caller must unlink when finished.
+static void write_bench_file(char *path, size_t len, const char *stmt, int count) {
+    snprintf(path, len, "/tmp/lbasic_bench_XXXXXX.lb");
+
+    int fd = mkstemps(path, 3);
+    if (fd < 0) {
+        log_error("Unable to create benchmark file");
+    }
+
+    FILE *fp = fdopen(fd, "w");
+    if (fp == NULL) {
+        log_error("Unable to open benchmark file for writing");
+    }
+
+    for (int i = 0; i < count; i++) {
+        fputs(stmt, fp);
+    }
+
+    fclose(fp);
+}
+
+static void bench_token_memory(void) {
+    lexer_t lexer;
+    char path[64];
+    write_bench_file(path, sizeof(path), "int x := 1;\n", 2000);
+
+    t_array *tokens          = lex(&lexer, path, NULL);
+    const unsigned int count = tokens->count;
+
+    const size_t before = sizeof(legacy_token) + sizeof(legacy_t_list);
+    const size_t after  = sizeof(token);
+
+    printf("Token memory (%u tokens):\n", count);
+    printf("    before: %5zu bytes/token (%zu KB total)\n", before, (before * count) / 1024);
+    printf("    after:  %5zu bytes/token (%zu KB total)\n", after, (after * count) / 1024);
+
+    t_array_free(tokens);
+    unlink(path);
+}
+
+// Lexes programs of increasing size. Time per token should stay flat as the programs grow.
+static void bench_lex_scaling(void) {
+    lexer_t lexer;
+    // 50 statements of 4 tokens each per line
+    char line[512] = {'\0'};
+    for (int i = 0; i < 50; i++) {
+        strcat(line, "x := 1; ");
+    }
+    strcat(line, "\n");
+
+    const int sizes[] = {10000, 100000, 1000000};
+
+    printf("Lexer scaling:\n");
+    for (int i = 0; i < 3; i++) {
+        char path[64];
+        write_bench_file(path, sizeof(path), line, sizes[i] / 200);
+
+        const double start = now_ms();
+        t_array *tokens    = lex(&lexer, path, NULL);
+        const double ms    = now_ms() - start;
+
+        printf("    %8u tokens: %9.2f ms (%6.1f ns/token)\n", tokens->count, ms,
+               (ms * 1000000.0) / tokens->count);
+
+        t_array_free(tokens);
+        unlink(path);
+    }
+}
+
+// Lexes long string literals and identifiers. The cost per byte should not depend on how long each
+// lexeme is.
+static void bench_lex_long_lexemes(void) {
+    lexer_t lexer;
+    const int lengths[] = {16, 256, 1024};
+
+    printf("Lexer long lexemes (1 MB of source each):\n");
+    for (int i = 0; i < 3; i++) {
+        const int len = lengths[i];
+        char stmt[2 * 1024 + 64];
+
+        // <identifier> := "<literal>";
+        memset(stmt, 'a', len);
+        snprintf(stmt + len, sizeof(stmt) - len, " := \"");
+        const size_t quote = strlen(stmt);
+        memset(stmt + quote, 'b', len);
+        snprintf(stmt + quote + len, sizeof(stmt) - quote - len, "\";\n");
+
+        char path[64];
+        const int count = (1024 * 1024) / strlen(stmt);
+        write_bench_file(path, sizeof(path), stmt, count);
+
+        const double start = now_ms();
+        t_array *tokens    = lex(&lexer, path, NULL);
+        const double ms    = now_ms() - start;
+
+        printf("    %4d byte lexemes: %9.2f ms (%6.2f ns/byte)\n", len, ms,
+               (ms * 1000000.0) / tokens->src->length);
+
+        t_array_free(tokens);
+        unlink(path);
+    }
+}
+
+// Lexes a file made mostly of keywords and one made of identifiers that look like keywords (same
+// length and first character), which both have to go through keyword recognition
+static void bench_lex_keywords(void) {
+    lexer_t lexer;
+    const char *files[][2] = {
+        {"keywords", "if x then return y else while z end for i to n goto l struct int\n"},
+        {"identifiers", "iq x thin rotund y elsa whale z ens fob i tx n gate l strict ink\n"},
+    };
+
+    printf("Lexer keyword recognition:\n");
+    for (int i = 0; i < 2; i++) {
+        char path[64];
+        write_bench_file(path, sizeof(path), files[i][1], 20000);
+
+        const double start = now_ms();
+        t_array *tokens    = lex(&lexer, path, NULL);
+        const double ms    = now_ms() - start;
+
+        printf("    %-12s %8u tokens: %9.2f ms (%6.1f ns/token)\n", files[i][0], tokens->count, ms,
+               (ms * 1000000.0) / tokens->count);
+
+        t_array_free(tokens);
+        unlink(path);
+    }
+}
+
+// Lexes a program that is all comments, one that mixes comments and code, and one in the style of
+// test/longident.lb (1 KB identifiers and string literals) with each set of scanners this CPU
+// supports, in MB/s of source
+static void bench_lex_scanners(void) {
+    lexer_t lexer;
+    const char *comment = "' A comment that runs on for a while, as comments in real programs do\n";
+
+    char mixed_stmt[256];
+    snprintf(mixed_stmt, sizeof(mixed_stmt), "%s    x := x + 1 ' increment\n", comment);
+
+    char longident_stmt[2 * 1024 + 64];
+    memset(longident_stmt, 'a', 1024);
+    snprintf(longident_stmt + 1024, sizeof(longident_stmt) - 1024, " := \"");
+    const size_t quote = strlen(longident_stmt);
+    memset(longident_stmt + quote, 'a', 1024);
+    snprintf(longident_stmt + quote + 1024, sizeof(longident_stmt) - quote - 1024, "\"\n");
+
+    const char *names[3] = {"comments", "mixed", "longident"};
+    const char *stmts[3] = {comment, mixed_stmt, longident_stmt};
+
+    printf("Lexer scanners (16 MB of source each):\n");
+    for (int i = 0; i < 3; i++) {
+        char path[64];
+        write_bench_file(path, sizeof(path), stmts[i], (16 * 1024 * 1024) / strlen(stmts[i]));
+
+        const scan_ops_t *prev = NULL;
+        for (scan_impl_t impl = SCAN_SCALAR; impl <= SCAN_AVX2; impl++) {
+            // Skip the scanners this CPU does not support, which fall back to the previous ones
+            const scan_ops_t *ops = scan_init(impl);
+            if (ops == prev) {
+                continue;
+            }
+            prev = ops;
+
+            const double start = now_ms();
+            t_array *tokens    = lex(&lexer, path, NULL);
+            const double ms    = now_ms() - start;
+
+            printf("    %-10s %-7s %9.2f ms (%7.1f MB/s)\n", names[i], ops->name, ms,
+                   (tokens->src->length / (1024.0 * 1024.0)) / (ms / 1000.0));
+
+            t_array_free(tokens);
+        }
+
+        unlink(path);
+    }
+
+    scan_init(SCAN_BEST);
+}
+
+// Parses a large program into an arena. Each node and vector element used to be a malloc() of its
+// own and was never freed; now they are carved out of a few large blocks that are freed together.
+static void bench_parse_arena(void) {
+    lexer_t lexer;
+    parser_t parser;
+    char path[64];
+    write_bench_file(path, sizeof(path), "x := (a + 1) * b;\n", 10000);
+
+    arena_t *arena  = arena_new();
+    t_array *tokens = lex(&lexer, path, strtab_new(arena));
+
+    // The parser's debug messages would swamp the results
+    FILE *null_out = fopen("/dev/null", "w");
+    diag_redirect(null_out);
+
+    double start          = now_ms();
+    node *program         = parse(&parser, tokens, arena);
+    const double parse_ms = now_ms() - start;
+
+    diag_redirect(NULL);
+    fclose(null_out);
+
+    printf("Parse into arena (%d statements):\n", vector_length(program->data.program.statements));
+    printf("    parse:    %9.2f ms (%u allocations from %u blocks, %zu KB)\n", parse_ms,
+           arena->count, arena->num_blocks, arena->reserved / 1024);
+
+    start = now_ms();
+    arena_free(arena);
+    printf("    teardown: %9.2f ms\n", now_ms() - start);
+
+    t_array_free(tokens);
+    unlink(path);
+}
+
+// Parses a large program, caches its AST, and loads it back. A warm build only pays for the load.
+static void bench_ast_cache(void) {
+    lexer_t lexer;
+    parser_t parser;
+    char path[64];
+    char dir[] = "/tmp/lbasic_bench_cache_XXXXXX";
+    write_bench_file(path, sizeof(path),
+                     "x := (a + 1) * b;\nif (x > 2) then\n    y := f(x, \"s\");\nend\n", 10000);
+
+    if (mkdtemp(dir) == NULL) {
+        log_error("Unable to create a directory for the AST cache benchmark");
+    }
+
+    FILE *null_out = fopen("/dev/null", "w");
+    diag_redirect(null_out);
+
+    double start          = now_ms();
+    arena_t *parse_arena  = arena_new();
+    t_array *tokens       = lex(&lexer, path, strtab_new(parse_arena));
+    node *program         = parse(&parser, tokens, parse_arena);
+    const double parse_ms = now_ms() - start;
+    const size_t length   = tokens->src->length;
+    const uint64_t key    = ast_cache_key(tokens->src);
+
+    start = now_ms();
+    ast_cache_store(dir, key, length, program);
+    const double store_ms = now_ms() - start;
+
+    start                = now_ms();
+    arena_t *load_arena  = arena_new();
+    node *loaded         = ast_cache_load(dir, key, length, load_arena);
+    const double load_ms = now_ms() - start;
+
+    diag_redirect(NULL);
+    fclose(null_out);
+
+    printf("AST cache (%d statements):\n", vector_length(program->data.program.statements));
+    printf("    lex + parse: %9.2f ms\n", parse_ms);
+    printf("    store:       %9.2f ms\n", store_ms);
+    printf("    load:        %9.2f ms (%s)\n", load_ms, (loaded != NULL) ? "ok" : "FAILED");
+
+    arena_free(load_arena);
+    arena_free(parse_arena);
+    t_array_free(tokens);
+
+    char cache_file[PATH_MAX];
+    snprintf(cache_file, sizeof(cache_file), "%s/%016" PRIx64 ".ast", dir, key);
+    unlink(cache_file);
+    rmdir(dir);
+    unlink(path);
+}
+
+// Parses a large program of declarations, loops and branches over and over. The parser used to copy
+// each token it stepped onto into its lookahead; now it only points to it.
+static void bench_parse_throughput(void) {
+    lexer_t lexer;
+    parser_t parser;
+    char path[64];
+    const char *stmts = "func f(int n, float s) -> int\n"
+                        "then\n"
+                        "    int total := 0;\n"
+                        "    while (n > 0) then\n"
+                        "        if ((n * 2) >= (total + 1)) then\n"
+                        "            total := total + n;\n"
+                        "        else then\n"
+                        "            total := g(total, s, \"label\");\n"
+                        "        end\n"
+                        "        n := n - 1;\n"
+                        "    end\n"
+                        "    return total;\n"
+                        "end\n";
+    const int rounds  = 20;
+    write_bench_file(path, sizeof(path), stmts, 2000);
+
+    arena_t *names  = arena_new();
+    t_array *tokens = lex(&lexer, path, strtab_new(names));
+
+    const double start = now_ms();
+    for (int round = 0; round < rounds; round++) {
+        arena_t *arena = arena_new();
+        parse(&parser, tokens, arena);
+        arena_free(arena);
+    }
+    const double parse_ms = now_ms() - start;
+
+    const double num_tokens = (double)tokens->count * rounds;
+
+    printf("Parse throughput (%u tokens, %d rounds):\n", tokens->count, rounds);
+    printf("    parse:    %9.2f ms (%.1fM tokens/s, %zu bytes no longer copied per step)\n",
+           parse_ms, num_tokens / (parse_ms * 1000.0), sizeof(token));
+
+    t_array_free(tokens);
+    arena_free(names);
+    unlink(path);
+}
+
+// Parses test/parsetest1.lb and test/parsetest3.lb, the two that parse, scaled up, and reports how
+// much memory their AST takes
+static void bench_ast_memory(void) {
+    const char *inputs[] = {"test/parsetest1.lb", "test/parsetest3.lb"};
+    const int copies     = 1000;
+
+    printf("AST memory (sizeof(node) = %zu bytes):\n", sizeof(node));
+    for (int i = 0; i < 2; i++) {
+        source_t *src = source_open(inputs[i]);
+        if (src == NULL) {
+            printf("    %s: unable to open (run from the repository root)\n", inputs[i]);
+            continue;
+        }
+
+        // Each copy ends with a newline, so that a trailing comment does not swallow the next one
+        char *program = (char *)malloc(src->length + 2);
+        memcpy(program, src->buffer, src->length);
+        program[src->length]     = '\n';
+        program[src->length + 1] = '\0';
+        source_free(src);
+
+        lexer_t lexer;
+        parser_t parser;
+        char path[64];
+        write_bench_file(path, sizeof(path), program, copies);
+        free(program);
+
+        arena_t *arena  = arena_new();
+        t_array *tokens = lex(&lexer, path, strtab_new(arena));
+
+        FILE *null_out = fopen("/dev/null", "w");
+        diag_redirect(null_out);
+        parse(&parser, tokens, arena);
+        diag_redirect(NULL);
+        fclose(null_out);
+
+        printf("    %s x %d: %u allocations, %zu KB used, %zu KB reserved\n", inputs[i], copies,
+               arena->count, arena->allocated / 1024, arena->reserved / 1024);
+
+        arena_free(arena);
+        t_array_free(tokens);
+        unlink(path);
+    }
+}
+
+// A statement list as it was before vectors were contiguous, kept for comparison
+typedef struct legacy_vecnode {
+    void *data;
+    struct legacy_vecnode *next;
+} legacy_vecnode;
+
+// Builds the body of a 1M-statement program and walks it, once as a linked list with its nodes
+// allocated between the statements (as the parser used to leave them) and once as a vector
+static void bench_vector_iteration(void) {
+    const int count = 1000000;
 
-        if (vector_length(v) > 0) {
-            while (curr != NULL) {
-                printf("%s\n", (char *)curr->data);
+    arena_t *arena       = arena_new();
+    vector *body         = mk_vector(arena);
+    legacy_vecnode *head = NULL;
+    legacy_vecnode *tail = NULL;
 
-                curr = curr->next;
+    for (int idx = 0; idx < count; idx++) {
+        legacy_vecnode *vn = (legacy_vecnode *)arena_alloc(arena, sizeof(legacy_vecnode));
+        vn->data           = mk_node(arena, N_EMPTY_EXPR);
+
+        if (head == NULL) {
+            head = vn;
+        } else {
+            tail->next = vn;
+        }
+        tail = vn;
+    }
+
+    double start = now_ms();
+    for (legacy_vecnode *vn = head; vn != NULL; vn = vn->next) {
+        vector_add(body, vn->data);
+    }
+    const double vector_add_ms = now_ms() - start;
+
+    // Each walk reads every statement's type, as the typechecker's dispatch does
+    unsigned long list_sum = 0;
+    start                  = now_ms();
+    for (legacy_vecnode *vn = head; vn != NULL; vn = vn->next) {
+        list_sum += ((node *)vn->data)->type;
+    }
+    const double list_ms = now_ms() - start;
+
+    unsigned long vector_sum = 0;
+    start                    = now_ms();
+    for (int idx = 0; idx < vector_length(body); idx++) {
+        vector_sum += ((node *)vector_get(body, idx))->type;
+    }
+    const double vector_ms = now_ms() - start;
+
+    printf("Statement list iteration (%d statements%s):\n", vector_length(body),
+           (list_sum == vector_sum) ? "" : ", MISMATCH");
+    printf("    linked list walk: %8.2f ms (%5.2f ns/statement)\n", list_ms,
+           (list_ms * 1000000.0) / count);
+    printf("    vector walk:      %8.2f ms (%5.2f ns/statement)\n", vector_ms,
+           (vector_ms * 1000000.0) / count);
+    printf("    vector add:       %8.2f ms (%5.2f ns/statement)\n", vector_add_ms,
+           (vector_add_ms * 1000000.0) / count);
+
+    arena_free(arena);
+}
+
+// The hash table as it was before it was open addressed: a fixed 1024 buckets, each a list of the
+// elements that hash to it, and no resizing. Kept for comparison.
+#define LEGACY_HT_SLOTS 1024
+
+typedef struct legacy_ht_entry {
+    uint32_t key;
+    void *data;
+} legacy_ht_entry;
+
+typedef struct legacy_hashtable {
+    vector *slots[LEGACY_HT_SLOTS];
+    arena_t *arena; // Buckets and entries
+} legacy_hashtable;
+
+static void legacy_ht_insert(legacy_hashtable *ht, uint32_t key, uint32_t hash, void *data) {
+    legacy_ht_entry *entry = (legacy_ht_entry *)arena_alloc(ht->arena, sizeof(legacy_ht_entry));
+    entry->key             = key;
+    entry->data            = data;
+
+    if (ht->slots[hash % LEGACY_HT_SLOTS] == NULL) {
+        ht->slots[hash % LEGACY_HT_SLOTS] = mk_vector(ht->arena);
+    }
+
+    vector_add(ht->slots[hash % LEGACY_HT_SLOTS], entry);
+}
+
+static void *legacy_ht_lookup(legacy_hashtable *ht, uint32_t key, uint32_t hash) {
+    vector *bucket = ht->slots[hash % LEGACY_HT_SLOTS];
+
+    for (int idx = 0; idx < vector_length(bucket); idx++) {
+        legacy_ht_entry *entry = (legacy_ht_entry *)vector_get(bucket, idx);
+        if (entry->key == key) {
+            return entry->data;
+        }
+    }
+
+    return NULL;
+}
+
+// Spreads consecutive keys over the whole range, as FNV-1a does for names (MurmurHash3 finalizer)
+static uint32_t bench_hash(uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6bU;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35U;
+    key ^= key >> 16;
+
+    return key;
+}
+
+// Frees a table whose elements' data is not heap memory, leaving the data alone
+static void free_table(hashtable *ht) {
+    free(ht->slots);
+    free(ht);
+}
+
+// xorshift32. Fixed seeds keep any failure reproducible.
+static uint32_t next_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+typedef enum fuzz_op { FUZZ_SET = 0, FUZZ_LOOKUP = 1, FUZZ_REMOVE = 2 } fuzz_op;
+
+// Runs num_ops random operations on keys below num_keys against the hash table and against a
+// plain array indexed by key, and counts the operations whose results differ. With grouped set,
+// every 16 consecutive keys share one hash, so lookups can only tell them apart by the key itself.
+static unsigned int fuzz_hashtable(uint32_t num_ops, uint32_t num_keys, bool grouped,
+                                   uint32_t seed, double *ht_ms, double *ref_ms) {
+    uint32_t *ops        = (uint32_t *)malloc(num_ops * sizeof(uint32_t));
+    uintptr_t *ht_out    = (uintptr_t *)malloc(num_ops * sizeof(uintptr_t));
+    uintptr_t *ref_out   = (uintptr_t *)malloc(num_ops * sizeof(uintptr_t));
+    uintptr_t *reference = (uintptr_t *)calloc(num_keys, sizeof(uintptr_t));
+    hashtable *ht        = ht_new();
+
+    // Each operation packs its kind into the low two bits and its key above them. Sets and lookups
+    // are twice as common as removals, so the table fills up over time.
+    for (uint32_t idx = 0; idx < num_ops; idx++) {
+        const uint32_t r = next_random(&seed) & 0xff;
+        fuzz_op kind     = FUZZ_REMOVE;
+
+        if (r < 102) {
+            kind = FUZZ_SET;
+        } else if (r < 204) {
+            kind = FUZZ_LOOKUP;
+        }
+
+        ops[idx] = ((next_random(&seed) % num_keys) << 2) | kind;
+    }
+
+    double start = now_ms();
+    for (uint32_t idx = 0; idx < num_ops; idx++) {
+        const uint32_t key  = ops[idx] >> 2;
+        const uint32_t hash = grouped ? bench_hash(key / 16) : bench_hash(key);
+
+        // An element's data is the number of the operation that set it, plus one so it is not NULL
+        switch ((fuzz_op)(ops[idx] & 3)) {
+            case FUZZ_SET:
+                ht_out[idx] = (uintptr_t)ht_remove(ht, key, hash);
+                ht_insert(ht, key, hash, (void *)(uintptr_t)(idx + 1));
+                break;
+            case FUZZ_LOOKUP:
+                ht_out[idx] = (uintptr_t)ht_lookup(ht, key, hash);
+                break;
+            case FUZZ_REMOVE:
+                ht_out[idx] = (uintptr_t)ht_remove(ht, key, hash);
+                break;
+        }
+    }
+    *ht_ms = now_ms() - start;
+
+    start = now_ms();
+    for (uint32_t idx = 0; idx < num_ops; idx++) {
+        const uint32_t key = ops[idx] >> 2;
+
+        ref_out[idx] = reference[key];
+        switch ((fuzz_op)(ops[idx] & 3)) {
+            case FUZZ_SET:
+                reference[key] = idx + 1;
+                break;
+            case FUZZ_LOOKUP:
+                break;
+            case FUZZ_REMOVE:
+                reference[key] = 0;
+                break;
+        }
+    }
+    *ref_ms = now_ms() - start;
+
+    unsigned int mismatches = 0;
+    for (uint32_t idx = 0; idx < num_ops; idx++) {
+        mismatches += (ht_out[idx] != ref_out[idx]);
+    }
+
+    // Whatever is left must match too
+    int remaining = 0;
+    for (uint32_t key = 0; key < num_keys; key++) {
+        const uint32_t hash = grouped ? bench_hash(key / 16) : bench_hash(key);
+
+        mismatches += ((uintptr_t)ht_lookup(ht, key, hash) != reference[key]);
+        remaining += (reference[key] != 0);
+    }
+    mismatches += (remaining != ht->num_values);
+
+    free_table(ht);
+    free(reference);
+    free(ref_out);
+    free(ht_out);
+    free(ops);
+
+    return mismatches;
+}
+
+// Differential runs of the hash table against a plain array: few keys reused over and over, many
+// keys, and many keys that share hashes
+static const struct {
+    const char *name;
+    uint32_t num_keys;
+    bool grouped;
+} fuzz_configs[] = {
+    {"1000 keys", 1000, false},
+    {"64K keys", 65536, false},
+    {"64K keys, shared hashes", 65536, true},
+};
+
+// Runs 4M random operations of each configuration and reports ns/op for the hash table and for
+// the array it is checked against
+static void bench_hashtable_fuzz(void) {
+    const uint32_t num_ops = 4000000;
+
+    printf("Hash table differential (%u random operations each, ns/op):\n", num_ops);
+    for (int i = 0; i < 3; i++) {
+        double ht_ms  = 0.0;
+        double ref_ms = 0.0;
+        const unsigned int mismatches =
+            fuzz_hashtable(num_ops, fuzz_configs[i].num_keys, fuzz_configs[i].grouped,
+                           0x9e3779b9U + i, &ht_ms, &ref_ms);
+
+        printf("    %-24s hashtable %6.1f, array %5.1f, %u mismatches\n", fuzz_configs[i].name,
+               (ht_ms * 1000000.0) / num_ops, (ref_ms * 1000000.0) / num_ops, mismatches);
+    }
+}
+
+// Fills tables of 10 to 1M elements and looks each one up, with the table as it is and as it was.
+// Small tables are filled and searched many times over, so each row does about 1M of each.
+static void bench_hashtable_scaling(void) {
+    const uint32_t sizes[] = {10, 100, 1000, 10000, 100000, 1000000};
+    const uint32_t total   = 1000000;
+
+    printf("Hash table scaling (ns per insert / lookup; empty table: %zu bytes, was %zu):\n",
+           sizeof(hashtable) + HT_INITIAL_CAPACITY * sizeof(ht_entry_t), sizeof(legacy_hashtable));
+
+    for (int i = 0; i < 6; i++) {
+        const uint32_t n      = sizes[i];
+        const uint32_t rounds = total / n;
+        hashtable *ht         = NULL;
+        legacy_hashtable *old = NULL;
+        uint32_t found        = 0;
+
+        // The elements' data is never dereferenced, and the tables are freed without it
+        double start = now_ms();
+        for (uint32_t round = 0; round < rounds; round++) {
+            if (ht != NULL) {
+                free_table(ht);
+            }
+
+            ht = ht_new();
+            for (uint32_t key = 0; key < n; key++) {
+                ht_insert(ht, key, bench_hash(key), (void *)(uintptr_t)(key + 1));
+            }
+        }
+        const double insert_ms = now_ms() - start;
+
+        start = now_ms();
+        for (uint32_t round = 0; round < rounds; round++) {
+            for (uint32_t key = 0; key < n; key++) {
+                found += (ht_lookup(ht, key, bench_hash(key)) != NULL);
+            }
+        }
+        const double lookup_ms = now_ms() - start;
+
+        start = now_ms();
+        for (uint32_t round = 0; round < rounds; round++) {
+            if (old != NULL) {
+                arena_free(old->arena);
+                free(old);
+            }
+
+            old        = (legacy_hashtable *)calloc(1, sizeof(legacy_hashtable));
+            old->arena = arena_new();
+            for (uint32_t key = 0; key < n; key++) {
+                legacy_ht_insert(old, key, bench_hash(key), (void *)(uintptr_t)(key + 1));
+            }
+        }
+        const double legacy_insert_ms = now_ms() - start;
+
+        start = now_ms();
+        for (uint32_t round = 0; round < rounds; round++) {
+            for (uint32_t key = 0; key < n; key++) {
+                found += (legacy_ht_lookup(old, key, bench_hash(key)) != NULL);
             }
         }
+        const double legacy_lookup_ms = now_ms() - start;
+
+        const double ops = (double)n * rounds;
+
+        printf("    %7u elements: %6.1f / %6.1f ns, was %6.1f / %8.1f ns (%u slots)%s\n", n,
+               (insert_ms * 1000000.0) / ops, (lookup_ms * 1000000.0) / ops,
+               (legacy_insert_ms * 1000000.0) / ops, (legacy_lookup_ms * 1000000.0) / ops,
+               ht->capacity, (found == 2 * ops) ? "" : " MISSING");
+
+        free_table(ht);
+        arena_free(old->arena);
+        free(old);
+    }
+}
+
+// A scope as symbol tables used to be built: a table of its own, linked to the scope around it
+typedef struct legacy_scope_s {
+    hashtable *table;
+    struct legacy_scope_s *prev;
+} legacy_scope;
+
+// Lookup as it was before names were interned: hash the name, then compare it byte by byte with
+// each binding in its bucket, at every scope on the way out. Kept for comparison.
+static binding_t *legacy_lookup(legacy_scope *scope, const char *identifier) {
+    for (; scope != NULL; scope = scope->prev) {
+        uint32_t hash = 2166136261U;
+        for (size_t i = 0; i < strlen(identifier); i++) {
+            hash ^= (uint8_t)identifier[i];
+            hash *= 16777619;
+        }
+
+        const hashtable *ht     = scope->table;
+        const unsigned int mask = ht->capacity - 1;
+
+        for (unsigned int slot = hash & mask; ht->slots[slot].data; slot = (slot + 1) & mask) {
+            binding_t *b = (binding_t *)ht->slots[slot].data;
+            if (strcmp(b->name, identifier) == 0) {
+                return b;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// Lookup once names were interned, but with a table per scope to probe on the way out
+static binding_t *chained_lookup(legacy_scope *scope, const char *identifier) {
+    for (; scope != NULL; scope = scope->prev) {
+        binding_t *b = ht_lookup(scope->table, strtab_id(identifier), strtab_hash_of(identifier));
+        if (b != NULL) {
+            return b;
+        }
+    }
+
+    return NULL;
+}
+
+// The same probe as symtab_lookup() without its trace check, which would blur the difference being
+// measured
+static binding_t *flat_lookup(symtab_t *st, const char *identifier) {
+    return ht_lookup(st->table, strtab_id(identifier), strtab_hash_of(identifier));
+}
+
+// Looks up each of 1000 global variables from 8 scopes further in: by string and by id through a
+// chain of per-scope tables, as names used to be looked up, and with one probe of the flat table.
+// Then times entering a scope, declaring a variable in it and leaving it again, both ways.
+static void bench_symtab_lookup(void) {
+    const unsigned int num_names = 1000;
+    const unsigned int depth     = 8;
+    const unsigned int rounds    = 200;
+    const unsigned int scopes    = 200000;
+
+    arena_t *arena       = arena_new();
+    strtab_t *names      = strtab_new(arena);
+    const char **ids     = (const char **)malloc(num_names * sizeof(const char *));
+    symtab_t *st         = symtab_new();
+    legacy_scope *global = (legacy_scope *)calloc(1, sizeof(legacy_scope));
+    legacy_scope *scope  = global;
+    unsigned int found   = 0;
+
+    // Each binding and scope would print a trace message if symtab tracing is on
+    FILE *null_out = fopen("/dev/null", "w");
+    diag_redirect(null_out);
+
+    global->table = ht_new();
+    for (unsigned int idx = 0; idx < num_names; idx++) {
+        char name[32];
+        snprintf(name, sizeof(name), "global_variable_%u", idx);
+
+        ids[idx]     = strtab_intern(names, name, strlen(name));
+        binding_t *b = mk_binding(SYMBOL_TYPE_VARIABLE);
+        b->name      = ids[idx];
+        ht_insert(global->table, strtab_id(b->name), strtab_hash_of(b->name), b);
+
+        binding_t *flat = mk_binding(SYMBOL_TYPE_VARIABLE);
+        flat->name      = ids[idx];
+        symtab_insert(st, flat);
+    }
+
+    for (unsigned int level = 1; level <= depth; level++) {
+        legacy_scope *inner = (legacy_scope *)calloc(1, sizeof(legacy_scope));
+        inner->table        = ht_new();
+        inner->prev         = scope;
+        scope               = inner;
+
+        symtab_enter(st, NULL);
+    }
+
+    double start = now_ms();
+    for (unsigned int round = 0; round < rounds; round++) {
+        for (unsigned int idx = 0; idx < num_names; idx++) {
+            found += (legacy_lookup(scope, ids[idx]) != NULL);
+        }
+    }
+    const double legacy_ms = now_ms() - start;
+
+    start = now_ms();
+    for (unsigned int round = 0; round < rounds; round++) {
+        for (unsigned int idx = 0; idx < num_names; idx++) {
+            found += (chained_lookup(scope, ids[idx]) != NULL);
+        }
+    }
+    const double chained_ms = now_ms() - start;
+
+    start = now_ms();
+    for (unsigned int round = 0; round < rounds; round++) {
+        for (unsigned int idx = 0; idx < num_names; idx++) {
+            found += (flat_lookup(st, ids[idx]) != NULL);
+        }
+    }
+    const double flat_ms = now_ms() - start;
+
+    // Entering and leaving a block that declares one variable, shadowing a global
+    start = now_ms();
+    for (unsigned int idx = 0; idx < scopes; idx++) {
+        legacy_scope inner = {.table = ht_new(), .prev = scope};
+        binding_t *b       = mk_binding(SYMBOL_TYPE_VARIABLE);
+        b->name            = ids[idx % num_names];
+        ht_insert(inner.table, strtab_id(b->name), strtab_hash_of(b->name), b);
+        ht_free(&inner.table);
+    }
+    const double chained_scope_ms = now_ms() - start;
+
+    start = now_ms();
+    for (unsigned int idx = 0; idx < scopes; idx++) {
+        symtab_enter(st, NULL);
+        binding_t *b = mk_binding(SYMBOL_TYPE_VARIABLE);
+        b->name      = ids[idx % num_names];
+        symtab_insert(st, b);
+        symtab_leave(st);
+    }
+    const double flat_scope_ms = now_ms() - start;
+
+    diag_redirect(NULL);
+    fclose(null_out);
+
+    const double lookups = (double)num_names * rounds;
+
+    printf("Symbol table lookup (%u names, %u scopes deep, %u of %.0f found):\n", num_names, depth,
+           found, 3 * lookups);
+    printf("    by string, chained: %9.2f ms (%6.1f ns/lookup)\n", legacy_ms,
+           (legacy_ms * 1000000.0) / lookups);
+    printf("    by id, chained:     %9.2f ms (%6.1f ns/lookup)\n", chained_ms,
+           (chained_ms * 1000000.0) / lookups);
+    printf("    by id, flat:        %9.2f ms (%6.1f ns/lookup)\n", flat_ms,
+           (flat_ms * 1000000.0) / lookups);
+    printf("Scope enter, declare and leave (%u scopes):\n", scopes);
+    printf("    chained:            %9.2f ms (%6.1f ns/scope)\n", chained_scope_ms,
+           (chained_scope_ms * 1000000.0) / scopes);
+    printf("    flat:               %9.2f ms (%6.1f ns/scope)\n", flat_scope_ms,
+           (flat_scope_ms * 1000000.0) / scopes);
+
+    for (legacy_scope *prev = NULL; scope != NULL; scope = prev) {
+        prev = scope->prev;
+        ht_free(&scope->table);
+        free(scope);
+    }
+
+    symtab_free(st);
+    free(ids);
+    arena_free(arena);
+}
+
+// Typechecks programs of the same size made of ever deeper expressions. Checking an operator used
+// to walk each of its operands again to find their types, so the time per node grew with the
+// depth; now each node's type is resolved once and read from the node after that.
+static void bench_typecheck_depth(void) {
+    const int depths[] = {4, 16, 64, 256};
+    const int nodes    = 100000;
+
+    printf("Typecheck depth (%d operators per program):\n", nodes);
+    for (int i = 0; i < 4; i++) {
+        // x := ((x + 1) + 1) ... + 1;
+        char *expr = (char *)malloc((depths[i] * 8) + 16);
+        strcpy(expr, "x := ");
+        for (int d = 0; d < depths[i]; d++) {
+            strcat(expr, "(");
+        }
+        strcat(expr, "x");
+        for (int d = 0; d < depths[i]; d++) {
+            strcat(expr, " + 1)");
+        }
+        strcat(expr, ";\n");
+
+        lexer_t lexer;
+        parser_t parser;
+        typechecker_t tc;
+        char path[64];
+        write_bench_file(path, sizeof(path), "int x := 0;\n", 1);
+
+        FILE *fp = fopen(path, "a");
+        for (int stmt = 0; stmt < nodes / depths[i]; stmt++) {
+            fputs(expr, fp);
+        }
+        fclose(fp);
+        free(expr);
+
+        arena_t *arena  = arena_new();
+        t_array *tokens = lex(&lexer, path, strtab_new(arena));
+
+        FILE *null_out = fopen("/dev/null", "w");
+        diag_redirect(null_out);
+        node *program = parse(&parser, tokens, arena);
+
+        const double start = now_ms();
+        typecheck(&tc, program);
+        const double ms = now_ms() - start;
+
+        diag_redirect(NULL);
+        fclose(null_out);
+
+        printf("    depth %4d: %9.2f ms (%6.1f ns/operator, %u types)\n", depths[i], ms,
+               (ms * 1000000.0) / nodes, tc.types->count);
+
+        symtab_free(tc.symbol_table);
+        arena_free(arena);
+        t_array_free(tokens);
+        unlink(path);
+    }
+}
+
+// Compiles a batch of programs on 1, 2, 4... threads, up to one per online CPU. Wall time should
+// fall close to linearly with the number of threads.
+static void bench_driver_scaling(void) {
+    char path[64];
+    const char *stmt = "if (true) then\n    int x := 1;\n    x := x * 2 + 1;\nend\n";
+    write_bench_file(path, sizeof(path), stmt, 500);
+
+    // The same program many times over, so every thread has the same amount of work
+    const unsigned int count = 32;
+    char *paths[count];
+    for (unsigned int idx = 0; idx < count; idx++) {
+        paths[idx] = path;
+    }
+
+    const long online       = sysconf(_SC_NPROCESSORS_ONLN);
+    const unsigned int cpus = (online > 0) ? (unsigned int)online : 1;
+    unsigned int jobs       = 1;
+    double base_ms          = 0.0;
+
+    printf("Driver scaling (%u programs, %u CPUs):\n", count, cpus);
+    for (;;) {
+        const double start = now_ms();
+        const int status   = compile_files(paths, count, jobs, NULL);
+        const double ms    = now_ms() - start;
+
+        if (jobs == 1) {
+            base_ms = ms;
+        }
+
+        printf("    %3u threads: %9.2f ms (%5.2fx)%s\n", jobs, ms, base_ms / ms,
+               (status != 0) ? " FAILED" : "");
+
+        if (jobs == cpus) {
+            break;
+        }
+
+        // Always finish with every CPU busy, whether or not their number is a power of two
+        jobs = (jobs * 2 < cpus) ? jobs * 2 : cpus;
+    }
+
+    unlink(path);
+}
+
+void run_benchmarks(void) {
+    printf("Running benchmarks.......\n");
+
+    bench_token_memory();
+    bench_lex_scaling();
+    bench_lex_long_lexemes();
+    bench_lex_keywords();
+    bench_lex_scanners();
+    bench_parse_arena();
+    bench_parse_throughput();
+    bench_ast_cache();
+    bench_ast_memory();
+    bench_vector_iteration();
+    bench_hashtable_scaling();
+    bench_hashtable_fuzz();
+    bench_symtab_lookup();
+    bench_typecheck_depth();
+    bench_driver_scaling();
+}
+
+static void print_string_vec(vector *v) {
+    if (v != NULL) {
+        printf("Length: %d\n", vector_length(v));
+
+        for (int idx = 0; idx < vector_length(v); idx++) {
+            printf("%s\n", (char *)vector_get(v, idx));
+        }
         printf("==============\n");
     } else {
         printf("Cannot print NULL vector\n");
     }
 }
 
+// Compiles program, which is expected to fail, and throws its diagnostics away. Returns the status
+// it failed with, and leaves the number of errors it reported in *num_errors.
+static int count_errors(const char *program, unsigned int *num_errors) {
+    char path[64];
+    write_bench_file(path, sizeof(path), program, 1);
+
+    lexer_t lexer;
+    parser_t parser  = {0};
+    typechecker_t tc = {0};
+    arena_t *arena   = arena_new();
+    t_array *tokens  = lex(&lexer, path, strtab_new(arena));
+    FILE *sink       = fopen("/dev/null", "w");
+    error_trap_t trap;
+
+    diag_redirect(sink);
+    error_set_trap(&trap);
+    if (setjmp(trap.env) == 0) {
+        typecheck(&tc, parse(&parser, tokens, arena));
+        trap.status = 0;
+    }
+    error_set_trap(NULL);
+    diag_redirect(NULL);
+
+    *num_errors = parser.num_errors + tc.num_errors;
+
+    if (tc.symbol_table != NULL) {
+        symtab_free(tc.symbol_table);
+    }
+    fclose(sink);
+    t_array_free(tokens);
+    arena_free(arena);
+    unlink(path);
+
+    return trap.status;
+}
+
+static void *run_server(void *arg) {
+    server_run((server_t *)arg);
+
+    return NULL;
+}
+
 void run_tests(void) {
     print_header();
 
     // Begin internal unit test environment below
     printf("Running vector tests.....\n");
 
-    vector *v = mk_vector();
+    vector *v = mk_vector(NULL);
 
     char *val1 = (char *)malloc(sizeof(char) * 5);
     snprintf(val1, 5, "va1");
@@ -101,8 +1136,9 @@ void run_tests(void) {
 
     print_string_vec(v);
 
-    vecnode *vn = vector_pop_head(v);
-    printf("Popped %s from head\n", (char *)vn->data);
+    char *popped = (char *)vector_pop_head(v);
+    printf("Popped %s from head\n", popped);
+    free(popped);
 
     print_string_vec(v);
 
@@ -125,9 +1161,16 @@ void run_tests(void) {
         char *alice = calloc(6, sizeof(char));
         snprintf(alice, 6, "alice");
 
-        ht_insert(ht, "liam", liam);
-        ht_insert(ht, "bob", bob);
-        ht_insert(ht, "alice", alice);
+        // Keys are the ids of interned names, which hash as the names themselves did
+        arena_t *key_arena  = arena_new();
+        strtab_t *keys      = strtab_new(key_arena);
+        const char *k_liam  = strtab_intern(keys, "liam", strlen("liam"));
+        const char *k_bob   = strtab_intern(keys, "bob", strlen("bob"));
+        const char *k_alice = strtab_intern(keys, "alice", strlen("alice"));
+
+        ht_insert(ht, strtab_id(k_liam), strtab_hash_of(k_liam), liam);
+        ht_insert(ht, strtab_id(k_bob), strtab_hash_of(k_bob), bob);
+        ht_insert(ht, strtab_id(k_alice), strtab_hash_of(k_alice), alice);
 
         char *foo = calloc(4, sizeof(char));
         snprintf(foo, 4, "foo");
@@ -135,11 +1178,106 @@ void run_tests(void) {
         char *bar = calloc(4, sizeof(char));
         snprintf(bar, 4, "bar");
 
-        ht_insert(ht, "alice", foo);
-        ht_insert(ht, "alice", bar);
+        ht_insert(ht, strtab_id(k_alice), strtab_hash_of(k_alice), foo);
+        ht_insert(ht, strtab_id(k_alice), strtab_hash_of(k_alice), bar);
 
         ht_print(ht);
+
+        // The earliest insertion of a key is found first, and the next one once it is removed
+        const uint32_t id_alice   = strtab_id(k_alice);
+        const uint32_t hash_alice = strtab_hash_of(k_alice);
+        const char *first         = ht_lookup(ht, id_alice, hash_alice);
+        char *removed             = ht_remove(ht, id_alice, hash_alice);
+
+        printf("alice: %s, removed %s, now %s\n", first, removed,
+               (char *)ht_lookup(ht, id_alice, hash_alice));
+        free(removed);
+
+        free(ht_remove(ht, strtab_id(k_bob), strtab_hash_of(k_bob)));
+        printf("bob removed: %s, liam: %s\n",
+               (ht_lookup(ht, strtab_id(k_bob), strtab_hash_of(k_bob)) == NULL) ? "ok" : "FAILED",
+               (char *)ht_lookup(ht, strtab_id(k_liam), strtab_hash_of(k_liam)));
+
         ht_free(&ht);
+        arena_free(key_arena);
+
+        // Few distinct hashes make for long probe sequences, which removal must keep intact while
+        // the table grows around them
+        const uint32_t num_keys = 1000;
+        hashtable *probes       = ht_new();
+        bool probes_ok          = true;
+
+        for (uint32_t key = 0; key < num_keys; key++) {
+            uint32_t *data = (uint32_t *)malloc(sizeof(uint32_t));
+            *data          = key;
+            ht_insert(probes, key, key % 7, data);
+        }
+
+        for (uint32_t key = 0; key < num_keys; key += 2) {
+            free(ht_remove(probes, key, key % 7));
+        }
+
+        for (uint32_t key = 0; key < num_keys; key++) {
+            const uint32_t *data = (uint32_t *)ht_lookup(probes, key, key % 7);
+            if ((key % 2 == 0) ? (data != NULL) : (data == NULL || *data != key)) {
+                probes_ok = false;
+            }
+        }
+
+        printf("probes: %d of %u left in %u slots: %s\n", probes->num_values, num_keys,
+               probes->capacity, probes_ok ? "ok" : "FAILED");
+        ht_free(&probes);
+
+        // A name that only shares its slot with a binding must not resolve to that binding
+        arena_t *scope_arena = arena_new();
+        strtab_t *names      = strtab_new(scope_arena);
+        symtab_t *st         = symtab_new();
+        binding_t *x         = mk_binding(SYMBOL_TYPE_VARIABLE);
+        const char *other    = NULL;
+
+        x->name = strtab_intern(names, "x", strlen("x"));
+        symtab_insert(st, x);
+
+        const unsigned int mask = st->table->capacity - 1;
+        int suffix              = 0;
+        do {
+            char name[16];
+            snprintf(name, sizeof(name), "y%d", suffix++);
+            other = strtab_intern(names, name, strlen(name));
+        } while ((strtab_hash_of(other) & mask) != (strtab_hash_of(x->name) & mask));
+
+        printf("'%s' shares a slot with 'x': %s\n", other,
+               (symtab_lookup(st, other, true) == NULL) ? "ok" : "FAILED");
+
+        // An inner binding hides an outer one of the same name until its scope is left
+        binding_t *inner_x = mk_binding(SYMBOL_TYPE_VARIABLE);
+        inner_x->name      = x->name;
+
+        symtab_enter(st, NULL);
+        const bool outer_seen = (symtab_lookup(st, x->name, false) == x) &&
+                                (symtab_lookup(st, x->name, true) == NULL);
+        symtab_insert(st, inner_x);
+        const bool inner_seen = (symtab_lookup(st, x->name, true) == inner_x) &&
+                                (symtab_lookup_enclosing(st, x->name) == x);
+        symtab_leave(st);
+        const bool outer_back = (symtab_lookup(st, x->name, true) == x);
+
+        printf("shadowing: %s\n", (outer_seen && inner_seen && outer_back) ? "ok" : "FAILED");
+
+        symtab_free(st);
+        arena_free(scope_arena);
+
+        // A shorter differential run than the benchmark's, with every configuration
+        for (int i = 0; i < 3; i++) {
+            double ht_ms  = 0.0;
+            double ref_ms = 0.0;
+            const unsigned int mismatches =
+                fuzz_hashtable(200000, fuzz_configs[i].num_keys, fuzz_configs[i].grouped,
+                               0x9e3779b9U + i, &ht_ms, &ref_ms);
+
+            printf("differential, %s: %s\n", fuzz_configs[i].name,
+                   (mismatches == 0) ? "ok" : "FAILED");
+        }
 
         /*
         binding_t *b1 = mk_binding(SYMBOL_TYPE_VARIABLE);
@@ -169,4 +1307,388 @@ void run_tests(void) {
         }
         */
     }
+
+    printf("Running keyword tests................\n");
+
+    // In the order of the keyword token types, starting at T_AND, then some near misses
+    const char *keywords = "and or func for while to end struct true false nil int bool string "
+                           "float void goto if then else return andy o fun whilst ends";
+
+    char kw_path[64];
+    write_bench_file(kw_path, sizeof(kw_path), keywords, 1);
+
+    lexer_t lexer;
+    t_array *kw_tokens = lex(&lexer, kw_path, NULL);
+    for (unsigned int i = 0; i < kw_tokens->count - 1; i++) {
+        const token_type expected = (i <= T_RETURN - T_AND) ? (token_type)(T_AND + i) : T_IDENT;
+        char literal[MAX_LITERAL];
+
+        token_literal(kw_tokens->src, &kw_tokens->toks[i], literal, sizeof(literal));
+        printf("%-8s %s\n", literal, (kw_tokens->toks[i].type == expected) ? "ok" : "FAILED");
+    }
+
+    t_array_free(kw_tokens);
+    unlink(kw_path);
+
+    printf("Running reentrancy tests................\n");
+
+    // Two programs compiled one after the other in the same process must not see each other
+    const char *programs[2] = {"int x := 1;\n", "int y := 2;\nint z := 3;\n"};
+    for (int i = 0; i < 2; i++) {
+        char prog_path[64];
+        write_bench_file(prog_path, sizeof(prog_path), programs[i], 1);
+
+        lexer_t prog_lexer;
+        parser_t prog_parser;
+        arena_t *prog_arena  = arena_new();
+        t_array *prog_tokens = lex(&prog_lexer, prog_path, strtab_new(prog_arena));
+        node *program        = parse(&prog_parser, prog_tokens, prog_arena);
+
+        printf("program %d: %u tokens, %d statements (expected %d)\n", i, prog_tokens->count,
+               vector_length(program->data.program.statements), i + 1);
+
+        t_array_free(prog_tokens);
+        arena_free(prog_arena);
+        unlink(prog_path);
+    }
+
+    printf("Running typechecker tests................\n");
+
+    // Every operand of an operator is annotated with its type, and resolving a type again reads
+    // the annotation rather than adding to the table
+    char tc_path[64];
+    const char *tc_program_src = "int x := 1;\nfloat f := 2.5;\n"
+                                 "bool b := (((x * 2) + f) > f) == (!false);\n";
+    write_bench_file(tc_path, sizeof(tc_path), tc_program_src, 1);
+
+    lexer_t tc_lexer;
+    parser_t tc_parser;
+    typechecker_t tc;
+    arena_t *tc_arena  = arena_new();
+    t_array *tc_tokens = lex(&tc_lexer, tc_path, strtab_new(tc_arena));
+    node *tc_program   = parse(&tc_parser, tc_tokens, tc_arena);
+
+    typecheck(&tc, tc_program);
+
+    const node *b_decl  = vector_get(tc_program->data.program.statements, 2);
+    const node *equal   = b_decl->data.var_decl.value;
+    const node *compare = equal->data.bin_op_expr.lhs;
+    const node *sum     = compare->data.bin_op_expr.lhs;
+    const node *product = sum->data.bin_op_expr.lhs;
+    const node *x_ident = product->data.bin_op_expr.lhs;
+    const node *not_val = equal->data.bin_op_expr.rhs;
+
+    const bool annotated = (typetab_get(tc.types, equal->type_id)->datatype == D_BOOLEAN) &&
+                           (typetab_get(tc.types, compare->type_id)->datatype == D_BOOLEAN) &&
+                           (typetab_get(tc.types, sum->type_id)->datatype == D_FLOAT) &&
+                           (typetab_get(tc.types, product->type_id)->datatype == D_INTEGER) &&
+                           (typetab_get(tc.types, x_ident->type_id)->datatype == D_INTEGER) &&
+                           (typetab_get(tc.types, not_val->type_id)->datatype == D_BOOLEAN);
+
+    printf("annotated: %s\ttypes: %u\n", annotated ? "ok" : "FAILED", tc.types->count);
+
+    // A type is interned once however it is built, so equal types have equal ids
+    typetab_t *types          = tc.types;
+    const char *person        = strtab_intern(tc.names, "person", strlen("person"));
+    const type_id_t integer   = typetab_primitive(D_INTEGER);
+    const type_id_t matrix    = typetab_array(types, integer, 2);
+    const type_id_t nested    = typetab_array(types, typetab_array(types, integer, 1), 1);
+    const type_id_t people    = typetab_array(types, typetab_struct(types, person), 1);
+    const type_id_t params[2] = {matrix, people};
+    const type_id_t sig       = typetab_function(types, typetab_primitive(D_FLOAT), params, 2);
+    const unsigned int before = types->count;
+
+    const type_id_t again[2] = {nested, typetab_array(types, typetab_struct(types, person), 1)};
+    const bool interned =
+        (matrix == nested) && (typetab_struct(types, person) == typetab_struct(types, person)) &&
+        (sig == typetab_function(types, typetab_primitive(D_FLOAT), again, 2)) &&
+        (sig != typetab_function(types, typetab_primitive(D_INTEGER), again, 2)) &&
+        (matrix != typetab_array(types, integer, 3)) &&
+        (types->count == before + 2);
+
+    char sig_name[MAX_TYPE_NAME];
+    typetab_name(types, sig, sig_name, sizeof(sig_name));
+
+    printf("interned: %s\t%s\n", interned ? "ok" : "FAILED", sig_name);
+
+    symtab_free(tc.symbol_table);
+    t_array_free(tc_tokens);
+    arena_free(tc_arena);
+    unlink(tc_path);
+
+    printf("Running error recovery tests................\n");
+
+    // Each broken statement is reported, in blocks too, and the parse goes on after it
+    const char *syntax_errors_src = "int a := (1;\nint b := 2;\nint c := (3;\n"
+                                    "func f(int n) -> int\nthen\n    int d := (4;\n"
+                                    "    return n;\nend\nint e := (5;\n";
+    unsigned int num_errors = 0;
+    int error_status        = count_errors(syntax_errors_src, &num_errors);
+
+    printf("syntax errors: %s\t%u\n",
+           ((error_status == PARSER_ERROR_SYNTAX_ERROR) && (num_errors == 4)) ? "ok" : "FAILED",
+           num_errors);
+
+    // A statement or expression that never got started is reported too, and the parse goes on
+    const char *missing_src = "int a := ;\nx;\nint b := 2;\nint c := (3;\n";
+    error_status            = count_errors(missing_src, &num_errors);
+
+    printf("missing expressions: %s\t%u\n",
+           ((error_status == PARSER_ERROR_SYNTAX_ERROR) && (num_errors == 3)) ? "ok" : "FAILED",
+           num_errors);
+
+    // An undeclared identifier is reported once, not again by every expression it is part of
+    const char *type_errors_src = "int a := true;\nstring b := 1;\nint c := d + 1;\nint e := a;\n";
+    error_status                = count_errors(type_errors_src, &num_errors);
+
+    printf("type errors: %s\t%u\n",
+           ((error_status == TYPE_ERROR) && (num_errors == 3)) ? "ok" : "FAILED", num_errors);
+
+    // The compile stops once it reaches the limit
+    error_limit  = 2;
+    error_status = count_errors(syntax_errors_src, &num_errors);
+    error_limit  = DEFAULT_ERROR_LIMIT;
+
+    printf("error limit: %s\t%u\n",
+           ((error_status == PARSER_ERROR_SYNTAX_ERROR) && (num_errors == 2)) ? "ok" : "FAILED",
+           num_errors);
+
+    printf("Running source tests................\n");
+
+    // A file that exactly fills a page leaves no slack in the mapping for the null terminator
+    char path[64];
+    const long page = sysconf(_SC_PAGESIZE);
+    write_bench_file(path, sizeof(path), "x", page);
+
+    source_t *src = source_open(path);
+    if (src != NULL) {
+        printf("length: %zu (page size: %ld)\tmapped: %d\tterminated: %d\tlines: %u\n",
+               src->length, page, src->mapped, src->buffer[src->length] == '\0', src->num_lines);
+        source_free(src);
+    } else {
+        printf("source_open failed!\n");
+    }
+
+    unlink(path);
+    printf("Running trace tests................\n");
+
+    // A list sets the categories it names, and a malformed one changes nothing
+    trace_level_t saved_levels[NUM_TRACE_CATEGORIES];
+    memcpy(saved_levels, trace_levels, sizeof(saved_levels));
+
+    const bool spec_ok = trace_configure("all=off,symtab,parser=verbose,typecheck=1");
+    const bool levels_ok = (trace_levels[TRACE_LEXER] == TRACE_OFF) &&
+                           (trace_levels[TRACE_SYMTAB] == TRACE_DEBUG) &&
+                           (trace_levels[TRACE_PARSER] == TRACE_VERBOSE) &&
+                           (trace_levels[TRACE_TYPECHECK] == TRACE_INFO);
+    const bool bad_rejected = !trace_configure("symtab=loud") && !trace_configure("codegen");
+    const bool kept         = (trace_levels[TRACE_SYMTAB] == TRACE_DEBUG);
+
+    printf("trace levels: %s\n", (spec_ok && levels_ok && bad_rejected && kept) ? "ok" : "FAILED");
+    memcpy(trace_levels, saved_levels, sizeof(saved_levels));
+
+    printf("Running arena tests................\n");
+
+    // Allocations are zeroed and aligned for any type, and requests larger than a block still fit
+    arena_t *arena     = arena_new();
+    bool arena_ok      = true;
+    const size_t sizes = 1000;
+    for (size_t i = 1; i <= sizes; i++) {
+        unsigned char *p = (unsigned char *)arena_alloc(arena, i);
+
+        arena_ok = arena_ok && (((uintptr_t)p % _Alignof(max_align_t)) == 0);
+        for (size_t j = 0; j < i; j++) {
+            arena_ok = arena_ok && (p[j] == 0);
+        }
+        memset(p, 0xff, i);
+    }
+
+    char *big = (char *)arena_alloc(arena, 4 * ARENA_BLOCK_SIZE);
+    memset(big, 'x', 4 * ARENA_BLOCK_SIZE);
+
+    printf("allocations: %u\tblocks: %u\tzeroed and aligned: %d\n", arena->count,
+           arena->num_blocks, arena_ok);
+    arena_free(arena);
+
+    printf("Running driver tests................\n");
+
+    // An error in one program of a batch is reported for that program and leaves the others be
+    const char *batch_programs[3] = {"int a := 1;\n", "int b := (1;\n", "int c := d;\n"};
+    char batch_paths[3][64];
+    char *batch[3];
+    for (int i = 0; i < 3; i++) {
+        write_bench_file(batch_paths[i], sizeof(batch_paths[i]), batch_programs[i], 1);
+        batch[i] = batch_paths[i];
+    }
+
+    const int status = compile_files(batch, 3, 2, NULL);
+    printf("batch status: %d (expected %d)\n", status, PARSER_ERROR_SYNTAX_ERROR);
+
+    for (int i = 0; i < 3; i++) {
+        unlink(batch_paths[i]);
+    }
+
+    printf("Running server tests................\n");
+
+    // A program is compiled once, and then only again once its source has changed
+    char socket_path[64];
+    char server_prog_path[64];
+    snprintf(socket_path, sizeof(socket_path), "/tmp/lbasic_test_%d.sock", (int)getpid());
+    write_bench_file(server_prog_path, sizeof(server_prog_path), "int a := 1;\n", 1);
+
+    server_t server;
+    pthread_t server_thread;
+    server_open(&server, socket_path, NULL);
+    pthread_create(&server_thread, NULL, run_server, &server);
+
+    char *requests[2]      = {server_prog_path, server_prog_path};
+    const int first_status = server_request(socket_path, requests, 2, NULL);
+
+    FILE *changed = fopen(server_prog_path, "w");
+    fputs("int a := (1;\n", changed);
+    fclose(changed);
+
+    const int changed_status = server_request(socket_path, requests, 1, NULL);
+
+    // The same text under a name a program may not have is not answered from the cache
+    char misnamed_path[sizeof(server_prog_path) + 4];
+    snprintf(misnamed_path, sizeof(misnamed_path), "%s.txt", server_prog_path);
+    FILE *misnamed = fopen(misnamed_path, "w");
+    fputs("int a := (1;\n", misnamed);
+    fclose(misnamed);
+
+    char *misnamed_request[1] = {misnamed_path};
+    const int misnamed_status = server_request(socket_path, misnamed_request, 1, NULL);
+
+    server_stop(socket_path);
+    pthread_join(server_thread, NULL);
+
+    const bool served = (first_status == 0) && (changed_status == PARSER_ERROR_SYNTAX_ERROR) &&
+                        (misnamed_status != 0) &&
+                        (misnamed_status != PARSER_ERROR_SYNTAX_ERROR) && (server.hits == 1) &&
+                        (server.misses == 2);
+
+    printf("server: %s\thits: %u\tmisses: %u\n", served ? "ok" : "FAILED", server.hits,
+           server.misses);
+    unlink(misnamed_path);
+    unlink(server_prog_path);
+
+    printf("Running AST cache tests................\n");
+
+    // A program compiles the same whether its AST was parsed, or loaded from the cache
+    char cache_dir[]      = "/tmp/lbasic_cache_XXXXXX";
+    const char *saved_dir = ast_cache_dir;
+    char cache_prog_path[64];
+    write_bench_file(cache_prog_path, sizeof(cache_prog_path),
+                     "int a := 1;\nstring s := \"one\";\nint b := s;\n", 1);
+
+    if (mkdtemp(cache_dir) == NULL) {
+        log_error("Unable to create a directory for the AST cache tests");
+    }
+
+    compile_result_t uncached, stored, loaded;
+    ast_cache_dir = NULL;
+    compile_kept(cache_prog_path, NULL, &uncached);
+    ast_cache_dir = cache_dir;
+    compile_kept(cache_prog_path, NULL, &stored);
+    compile_kept(cache_prog_path, NULL, &loaded);
+    ast_cache_dir = saved_dir;
+
+    const bool same_output = (stored.status == uncached.status) &&
+                             (loaded.status == uncached.status) &&
+                             (stored.output_len == uncached.output_len) &&
+                             (loaded.output_len == uncached.output_len) &&
+                             (memcmp(loaded.output, uncached.output, uncached.output_len) == 0);
+
+    // The cached names are interned in the loaded program's string table
+    source_t *cache_src  = source_open(cache_prog_path);
+    const uint64_t key   = ast_cache_key(cache_src);
+    arena_t *cache_arena = arena_new();
+    node *cached         = ast_cache_load(cache_dir, key, cache_src->length, cache_arena);
+    bool loaded_ok = (cached != NULL) && (vector_length(cached->data.program.statements) == 3);
+
+    if (loaded_ok) {
+        const node *first = vector_get(cached->data.program.statements, 0);
+        loaded_ok =
+            (first->data.var_decl.name == strtab_intern(cached->data.program.names, "a", 1));
+    }
+
+    // A program whose length differs is not given another's AST
+    const bool mismatch_ok =
+        (ast_cache_load(cache_dir, key, cache_src->length + 1, cache_arena) == NULL);
+
+    printf("ast cache: %s\tstatus: %d (expected %d)\n",
+           (same_output && loaded_ok && mismatch_ok) ? "ok" : "FAILED", loaded.status, TYPE_ERROR);
+
+    arena_free(cache_arena);
+    source_free(cache_src);
+    compile_result_free(&uncached);
+    compile_result_free(&stored);
+    compile_result_free(&loaded);
+
+    char cache_file[PATH_MAX];
+    snprintf(cache_file, sizeof(cache_file), "%s/%016" PRIx64 ".ast", cache_dir, key);
+    unlink(cache_file);
+
+    // A cache file damaged anywhere is turned away, or loads as a tree that can be checked. Either
+    // way the program compiles to the type error for the undeclared 'q' it has, and nothing else;
+    // here every byte of a file is damaged in turn.
+    char damaged_prog_path[64];
+    write_bench_file(damaged_prog_path, sizeof(damaged_prog_path),
+                     "struct point then\n    int x;\n    float y;\nend\n"
+                     "func f(int n, struct point p) -> int\nthen\n"
+                     "    while (n > 0) then\n        if ((n * 2) >= p.x) then\n"
+                     "            n := n - 1;\n        else then\n"
+                     "            println(\"done\");\n        end\n    end\n"
+                     "    return -n;\nend\nbool b := not (f(3, q) == 1);\n",
+                     1);
+
+    compile_result_t damaged;
+    ast_cache_dir = cache_dir;
+    compile_kept(damaged_prog_path, NULL, &damaged);
+    compile_result_free(&damaged);
+
+    source_t *damaged_src = source_open(damaged_prog_path);
+    snprintf(cache_file, sizeof(cache_file), "%s/%016" PRIx64 ".ast", cache_dir,
+             ast_cache_key(damaged_src));
+    source_free(damaged_src);
+
+    // A file that is turned away is written again, so the damaged one is written out each time
+    FILE *cache_fp      = fopen(cache_file, "rb");
+    char *cache_image   = (char *)malloc(64 * 1024);
+    const size_t length = (cache_fp != NULL) ? fread(cache_image, 1, 64 * 1024, cache_fp) : 0;
+    unsigned int loads  = 0;
+    unsigned int wrong  = 0; // Compiles that ended other than in the type error
+
+    if (cache_fp != NULL) {
+        fclose(cache_fp);
+    }
+
+    for (size_t pos = 0; pos < length; pos++) {
+        cache_image[pos] ^= 0xff;
+
+        cache_fp = fopen(cache_file, "wb");
+        fwrite(cache_image, 1, length, cache_fp);
+        fclose(cache_fp);
+
+        compile_kept(damaged_prog_path, NULL, &damaged);
+        if (damaged.status != TYPE_ERROR) {
+            wrong++;
+        }
+        compile_result_free(&damaged);
+
+        cache_image[pos] ^= 0xff;
+        loads++;
+    }
+
+    ast_cache_dir = saved_dir;
+
+    printf("damaged ast cache: %s\t%u bytes\t%u wrong statuses\n",
+           ((loads > 0) && (wrong == 0)) ? "ok" : "FAILED", loads, wrong);
+
+    free(cache_image);
+    unlink(cache_file);
+    unlink(damaged_prog_path);
+    rmdir(cache_dir);
+    unlink(cache_prog_path);
 }
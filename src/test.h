@@ -2,5 +2,6 @@
 #define TEST_H
 
 void run_tests(void);
+void run_benchmarks(void);
 
 #endif
@@ -5,103 +5,149 @@
  */
 
 #include "token.h"
+#include "error.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static unsigned int token_count = 0;
+#define T_ARRAY_INITIAL_CAPACITY 256
 
-t_list *t_list_new(void) {
-    t_list *new = (t_list *)malloc(sizeof(t_list) + 1);
-    memset(new, 0, sizeof(t_list));
-    new->next = NULL;
-    new->prev = NULL;
+t_array *t_array_new(source_t *src) {
+    t_array *retval = (t_array *)calloc(1, sizeof(t_array));
 
-    token *tok = (token *)malloc(sizeof(token));
-    memset(tok->literal, 0, MAX_LITERAL);
-    memset(tok->line_str, 0, MAX_LINE);
-    strncpy(tok->literal, "HEAD", sizeof(tok->literal));
+    if (retval != NULL) {
+        retval->toks = (token *)malloc(T_ARRAY_INITIAL_CAPACITY * sizeof(token));
 
-    tok->type = T_HEAD;
-    tok->line = 0;
-    tok->col  = 0;
-
-    new->tok = tok;
-
-    return new;
-}
+        if (retval->toks == NULL) {
+            free(retval);
+            return NULL;
+        }
 
-void t_list_free(t_list *lst) {
-    // Seek to end
-    while (lst->next != NULL) {
-        lst = lst->next;
+        retval->count    = 0;
+        retval->capacity = T_ARRAY_INITIAL_CAPACITY;
+        retval->src      = src;
     }
 
-    // Walk back up the list
-    while (lst->prev != NULL) {
-        lst = lst->prev;
+    return retval;
+}
 
-        free(lst->next->tok);
-        free(lst->next);
-    }
+void t_array_free(t_array *arr) {
+    if (arr != NULL) {
+        source_free(arr->src);
 
-    if (lst != NULL) {
-        free(lst);
+        free(arr->toks);
+        free(arr);
     }
 }
 
-void t_list_append(t_list *lst, t_list *new_tok) {
-    if (lst != NULL) {
-        if (new_tok != NULL) {
-            while (lst->next != NULL) {
-                lst = t_list_next(lst);
-            }
+// Appends a copy of tok, doubling the capacity of the array when it is full
+void t_array_append(t_array *arr, const token *tok) {
+    if (arr != NULL) {
+        if (tok != NULL) {
+            if (arr->count == arr->capacity) {
+                const unsigned int new_capacity = arr->capacity * 2;
+                token *new_toks = (token *)realloc(arr->toks, new_capacity * sizeof(token));
 
-            if (lst->next == NULL) {
-                new_tok->prev = lst;
-                new_tok->next = NULL;
+                if (new_toks == NULL) {
+                    log_error("Unable to grow token array to %u tokens", new_capacity);
+                }
 
-                lst->next = new_tok;
-
-                token_count++;
+                arr->toks     = new_toks;
+                arr->capacity = new_capacity;
             }
+
+            arr->toks[arr->count++] = *tok;
         } else {
-            printf("ERROR: Cannot access new_tok\n");
+            diag_printf("ERROR: Cannot access tok\n");
         }
     } else {
-        printf("ERROR: Cannot access lst\n");
+        diag_printf("ERROR: Cannot access arr\n");
     }
 }
 
-t_list *t_list_next(t_list *lst) {
-    if (lst == NULL) {
-        return NULL;
-    } else {
-        return lst->next;
+void print_tokens(t_array *arr) {
+    if (arr != NULL) {
+        char literal[MAX_LITERAL];
+
+        for (unsigned int idx = 0; idx < arr->count; idx++) {
+            const token *tok = &arr->toks[idx];
+
+            diag_printf("Type: %d\n", tok->type);
+            diag_printf("Literal: %s\n", token_literal(arr->src, tok, literal, sizeof(literal)));
+            diag_printf("Line: %d\n", tok->line);
+        }
+
+        diag_printf("\nNum tokens: %u\n\n", arr->count);
     }
 }
 
-t_list *t_list_prev(t_list *lst) {
-    if (lst == NULL) {
-        printf("null element\n");
-        return NULL;
+char *token_literal(const source_t *src, const token *tok, char *buf, size_t len) {
+    if (buf == NULL || len == 0) {
+        return buf;
+    }
+
+    // These tokens have no text within the source buffer
+    if (tok->type == T_HEAD) {
+        snprintf(buf, len, "HEAD");
+    } else if (tok->type == T_EOF) {
+        snprintf(buf, len, "EOF");
     } else {
-        return lst->prev;
+        const size_t n = (tok->length < len - 1) ? tok->length : len - 1;
+
+        memcpy(buf, src->buffer + tok->offset, n);
+        buf[n] = '\0';
     }
+
+    return buf;
 }
 
-void print_list(t_list *lst) {
-    if (lst != NULL) {
-        t_list *lst_ptr = lst;
+char *token_string_value(const source_t *src, const token *tok, char *buf, size_t len) {
+    const char *span = src->buffer + tok->offset;
 
-        while (lst_ptr != NULL) {
-            printf("Type: %d\n", lst_ptr->tok->type);
-            printf("Literal: %s\n", lst_ptr->tok->literal);
-            printf("Line: %d\n", lst_ptr->tok->line);
+    // Most literals contain no escapes, and those are a plain copy of the span
+    if (buf == NULL || len == 0 || memchr(span, '\\', tok->length) == NULL) {
+        return token_literal(src, tok, buf, len);
+    }
 
-            lst_ptr = t_list_next(lst_ptr);
+    size_t n = 0;
+    for (unsigned int i = 0; (i < tok->length) && (n < len - 1); i++) {
+        char c = span[i];
+
+        if ((c == '\\') && (i + 1 < tok->length)) {
+            switch (span[++i]) {
+                case 'n':
+                    c = '\n';
+                    break;
+                case 't':
+                    c = '\t';
+                    break;
+                case 'r':
+                    c = '\r';
+                    break;
+                case '"':
+                    c = '"';
+                    break;
+                case '\\':
+                    c = '\\';
+                    break;
+                default:
+                    // Unknown escapes are kept as written
+                    i--;
+            }
         }
 
-        printf("\nNum tokens: %u\n\n", token_count);
+        buf[n++] = c;
+    }
+    buf[n] = '\0';
+
+    return buf;
+}
+
+const char *token_line(const source_t *src, const token *tok, size_t *len) {
+    if (tok->type == T_HEAD || tok->type == T_EOF) {
+        *len = 0;
+        return "";
     }
+
+    return source_line(src, tok->line, len);
 }
@@ -7,7 +7,10 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
-#include "vector.h" /* line_t, vector */
+#include "source.h"
+#include "strtab.h"
+
+#include <stddef.h>
 
 // Accounting for null byte
 #define MAX_LITERAL 1024 + 1
@@ -69,25 +72,39 @@ typedef enum {
     NTOKENS
 } token_type;
 
+/* Tokens do not own their text. Each one records where its lexeme lives within the source
+ * buffer, and the lexeme or the line it appears on is recovered from there when needed. */
 typedef struct {
     token_type type;
-    char literal[MAX_LITERAL];
-    char line_str[MAX_LINE];
+    unsigned int offset; // Byte offset of the lexeme within the source buffer
+    unsigned int length; // Length of the lexeme in bytes
     unsigned int line;
     unsigned int col;
+    unsigned int name; // Identifiers and string literals: id of the interned text, otherwise 0
 } token;
 
-typedef struct t_list {
-    token *tok;
-    struct t_list *prev;
-    struct t_list *next;
-} t_list;
+// Growable, contiguous array of tokens in source order
+typedef struct t_array {
+    token *toks;
+    unsigned int count;
+    unsigned int capacity;
+    source_t *src;   // Source buffer the tokens point into. Owned by the array.
+    strtab_t *names; // Where the tokens' names are interned. Not owned by the array.
+} t_array;
+
+t_array *t_array_new(source_t *src);
+void t_array_free(t_array *arr);
+void t_array_append(t_array *arr, const token *tok);
+void print_tokens(t_array *arr);
+
+// Copies the lexeme of tok out of src into buf (always null-terminated) and returns buf
+char *token_literal(const source_t *src, const token *tok, char *buf, size_t len);
+
+// Like token_literal, but decodes escape sequences (\n, \t, \r, \", \\) within a string literal.
+// Literals without a backslash are copied as they are.
+char *token_string_value(const source_t *src, const token *tok, char *buf, size_t len);
 
-t_list *t_list_new(void);
-void t_list_free(t_list *lst);
-void t_list_append(t_list *lst, t_list *new_tok);
-t_list *t_list_next(t_list *lst);
-t_list *t_list_prev(t_list *lst);
-void print_list(t_list *lst);
+// Returns a pointer to the line of src that tok was found on and stores its length in len
+const char *token_line(const source_t *src, const token *tok, size_t *len);
 
 #endif // TOKEN_H
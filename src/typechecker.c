@@ -10,7 +10,6 @@
 #include "error.h"
 #include "symtab.h"
 
-#include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
@@ -27,53 +26,95 @@
 static char builtins[N_BUILTINS][MAX_LITERAL] = {"print", "println", "printint", "printfloat"};
 static data_type builtin_types[N_BUILTINS]    = {D_STRING, D_STRING, D_INTEGER, D_FLOAT};
 
-// Overall symbol table data structure
-static symtab_t *symbol_table = NULL;
-
-// Pointer to the current scope
-static symtab_t *curr_scope = NULL;
-
-static void do_typecheck(node *ast);
-static void typecheck_program(node *ast);
-static void typecheck_block_stmt(node *ast);
-static void typecheck_var_decl(node *ast);
-static void typecheck_func_decl(node *ast);
-static void typecheck_call_expr(node *ast);
-static void typecheck_formal(node *ast);
-static void typecheck_ident(node *ast);
-static void typecheck_binop_expr(node *ast);
-static void typecheck_assign_expr(node *ast);
-static void typecheck_if_stmt(node *ast);
-static void typecheck_literal(node *ast);
-static void typecheck_return_stmt(node *ast);
-static void typecheck_nil(node *ast);
-static void typecheck_struct_decl(node *ast);
-static void typecheck_member_decl(node *ast);
-static void typecheck_struct_access(node *ast);
-static void typecheck_label_decl(node *ast);
-static void typecheck_goto_stmt(node *ast);
-static void typecheck_array_init_expr(node *ast);
-static void typecheck_array_access_expr(node *ast);
-static void typecheck_while_stmt(node *ast);
-static void typecheck_empty_expr(node *ast);
-static void typecheck_neg_expr(node *ast);
-static void typecheck_not_expr(node *ast);
-static bool match_types(node *a, node *b, type_t *type_a, type_t *type_b);
-
-// TODO: Improve
-static void type_error(const char *str, node *n) {
-    printf("Type Error: %s\n", str);
+static void do_typecheck(typechecker_t *tc, node *ast);
+static void typecheck_program(typechecker_t *tc, node *ast);
+static void typecheck_block_stmt(typechecker_t *tc, node *ast);
+static void typecheck_var_decl(typechecker_t *tc, node *ast);
+static void typecheck_func_decl(typechecker_t *tc, node *ast);
+static void typecheck_call_expr(typechecker_t *tc, node *ast);
+static void typecheck_formal(typechecker_t *tc, node *ast);
+static void typecheck_ident(typechecker_t *tc, node *ast);
+static void typecheck_binop_expr(typechecker_t *tc, node *ast);
+static void typecheck_assign_expr(typechecker_t *tc, node *ast);
+static void typecheck_if_stmt(typechecker_t *tc, node *ast);
+static void typecheck_literal(typechecker_t *tc, node *ast);
+static void typecheck_return_stmt(typechecker_t *tc, node *ast);
+static void typecheck_nil(typechecker_t *tc, node *ast);
+static void typecheck_struct_decl(typechecker_t *tc, node *ast);
+static void typecheck_member_decl(typechecker_t *tc, node *ast);
+static void typecheck_struct_access(typechecker_t *tc, node *ast);
+static void typecheck_label_decl(typechecker_t *tc, node *ast);
+static void typecheck_goto_stmt(typechecker_t *tc, node *ast);
+static void typecheck_array_init_expr(typechecker_t *tc, node *ast);
+static void typecheck_array_access_expr(typechecker_t *tc, node *ast);
+static void typecheck_while_stmt(typechecker_t *tc, node *ast);
+static void typecheck_empty_expr(typechecker_t *tc, node *ast);
+static void typecheck_neg_expr(typechecker_t *tc, node *ast);
+static void typecheck_not_expr(typechecker_t *tc, node *ast);
+static bool match_types(typechecker_t *tc, node *a, node *b, const type_t **type_a,
+                        const type_t **type_b);
+
+// Reports a type error at n. The check goes on afterwards, unless there are too many errors.
+static void type_error(typechecker_t *tc, const char *str, node *n) {
+    diag_printf("Type Error: %s\n", str);
     print_node(n, 0);
-    exit(TYPE_ERROR);
+    error_count(&tc->num_errors, TYPE_ERROR);
+}
+
+// Whether an error has been reported already about an expression of this type. Such expressions
+// match any type, so that one mistake does not set off a run of others.
+static bool is_error_type(type_id_t type) { return type == typetab_primitive(D_UNKNOWN); }
+
+// Id of a declared type: the struct type struct_type if is_struct is set, otherwise data_type type,
+// with num_dimensions if it is an array
+static type_id_t declared_type(typechecker_t *tc, data_type type, const char *struct_type,
+                               bool is_struct, bool is_array, int num_dimensions) {
+    type_id_t retval = is_struct ? typetab_struct(tc->types, struct_type) : typetab_primitive(type);
+
+    if (is_array) {
+        retval = typetab_array(tc->types, retval, num_dimensions);
+    }
+
+    return retval;
+}
+
+// Id of a formal argument's declared type, which the formal is annotated with
+static type_id_t formal_type(typechecker_t *tc, node *formal) {
+    if (TYPE_NONE == formal->type_id) {
+        const formal_t *f = &formal->data.formal;
+
+        formal->type_id = declared_type(tc, f->type, f->struct_type, f->is_struct, f->is_array,
+                                        f->num_dimensions);
+    }
+
+    return formal->type_id;
+}
+
+// Id of the signature of a function returning result and taking the formal arguments in formals
+static type_id_t function_type(typechecker_t *tc, type_id_t result, vector *formals) {
+    const int num_params = vector_length(formals);
+    type_id_t params[num_params + 1];
+
+    for (int idx = 0; idx < num_params; idx++) {
+        params[idx] = formal_type(tc, vector_get(formals, idx));
+    }
+
+    return typetab_function(tc->types, result, params, num_params);
+}
+
+// Writes the name of the type with the given id, for an error message, into buf, which holds
+// MAX_TYPE_NAME bytes
+static const char *type_name(typechecker_t *tc, type_id_t id, char *buf) {
+    return typetab_name(tc->types, id, buf, MAX_TYPE_NAME);
 }
 
 // Creates bindings for each builtin function and adds them to the global scope
-static void make_builtins(void) {
+static void make_builtins(typechecker_t *tc) {
     for (unsigned int idx = 0; idx < N_BUILTINS; idx++) {
         binding_t *builtin_binding = mk_binding(SYMBOL_TYPE_FUNCTION);
         if (NULL != builtin_binding) {
             // Populate binding data
-            snprintf(builtin_binding->name, MAX_LITERAL, builtins[idx]);
+            builtin_binding->name = strtab_intern(tc->names, builtins[idx], strlen(builtins[idx]));
 
             builtin_binding->data.function_type.return_type    = D_VOID;
             builtin_binding->data.function_type.is_array_type  = false;
@@ -81,220 +122,201 @@ static void make_builtins(void) {
             builtin_binding->data.function_type.num_dimensions = 0;
             builtin_binding->data.function_type.num_args       = 1;
 
-            node *formal = mk_node(N_FORMAL);
+            // Allocated from the program's arena, which outlives the scopes
+            node *formal = mk_node(tc->names->arena, N_FORMAL);
             if (NULL != formal) {
-                snprintf(formal->data.formal.name, MAX_LITERAL, "input");
-                formal->data.formal.type           = builtin_types[idx];
+                formal->data.formal.name = strtab_intern(tc->names, "input", strlen("input"));
+                formal->data.formal.type = builtin_types[idx];
                 formal->data.formal.is_array       = false;
                 formal->data.formal.is_struct      = false;
                 formal->data.formal.num_dimensions = 0;
             }
 
-            builtin_binding->data.function_type.formals = mk_vector();
+            builtin_binding->data.function_type.formals = mk_vector(tc->names->arena);
             vector_add(builtin_binding->data.function_type.formals, formal);
 
-            symtab_insert(symbol_table, builtin_binding);
+            builtin_binding->data.function_type.type_id = function_type(
+                tc, typetab_primitive(D_VOID), builtin_binding->data.function_type.formals);
+
+            symtab_insert(tc->symbol_table, builtin_binding);
         }
     }
 }
 
-// Optional name argument to assist in typechecking return statements against function return type
-// Kind of hacky
-static void enter_new_scope(char *name) {
-    symtab_t *new_scope = symtab_new();
-    if (NULL == new_scope) {
-        log_error("Unable to create symbol table for new scope");
-    }
-
-    if (NULL != name) {
-        snprintf(new_scope->name, MAX_LITERAL, name);
+// Dumps every open scope, which is only worth doing when following the typechecker step by step
+static void trace_symbol_table(typechecker_t *tc) {
+    if (trace_enabled(TRACE_SYMTAB, TRACE_VERBOSE)) {
+        print_symbol_table(tc->symbol_table);
     }
-
-    // Increment scope level
-    new_scope->level = curr_scope->level + 1;
-
-    // Link up to the current scope
-    new_scope->prev = curr_scope;
-
-    // Make the new scope a 'leaf'
-    new_scope->next = NULL;
-
-    // Link down to the new scope
-    curr_scope->next = new_scope;
-
-    debug("Entering level %d from level %d", new_scope->level, curr_scope->level);
-
-    // The new scope becomes the current scope
-    curr_scope = new_scope;
-
-    print_symbol_table(symbol_table);
 }
 
-// Return to the parent scope
-static void leave_curr_scope(void) {
-    symtab_t *old_scope = curr_scope;
-
-    // Ensure this is a leaf scope
-    if (NULL != curr_scope->next) {
-        log_error(
-            "Current scope (level=%d) is not a leaf node. Unable to leave a non-terminal scope",
-            curr_scope->level);
-    }
-
-    curr_scope       = curr_scope->prev;
-    curr_scope->next = NULL;
+// Optional name argument to assist in typechecking return statements against function return type
+// Kind of hacky
+static void enter_new_scope(typechecker_t *tc, const char *name) {
+    symtab_enter(tc->symbol_table, name);
 
-    debug("Leaving scope %d and returning to scope %d", old_scope->level, curr_scope->level);
+    trace_symbol_table(tc);
+}
 
-    ht_free(&old_scope->table);
+// Return to the parent scope, dropping everything declared within the current one
+static void leave_curr_scope(typechecker_t *tc) {
+    symtab_leave(tc->symbol_table);
 
-    print_symbol_table(symbol_table);
+    trace_symbol_table(tc);
 }
 
-void typecheck(node *ast) {
+void typecheck(typechecker_t *tc, node *ast) {
     if (ast != NULL) {
-
         // Pass 1: Build symbol table
-        symbol_table = symtab_new();
+        tc->symbol_table = symtab_new();
 
-        if (symbol_table == NULL) {
+        if (tc->symbol_table == NULL) {
             log_error("Unable to allocate symbol table within typechecker");
         }
 
-        debug("Allocated symbol table for global scope (scope=%d)", symbol_table->level);
-        curr_scope = symbol_table;
+        debug(TRACE_TYPECHECK, "Allocated symbol table for global scope (scope=%d)",
+              symtab_scope(tc->symbol_table)->level);
+        tc->names = ast->data.program.names;
 
-        make_builtins();
+        tc->types      = typetab_new(tc->names->arena);
+        tc->num_errors = 0;
+        make_builtins(tc);
 
-        do_typecheck(ast);
+        do_typecheck(tc, ast);
+
+        if (tc->num_errors > 0) {
+            if (tc->num_errors > 1) {
+                diag_printf("%u type errors\n", tc->num_errors);
+            }
+            error_exit(TYPE_ERROR);
+        }
     }
 }
 
-static void do_typecheck(node *ast) {
+static void do_typecheck(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     switch (ast->type) {
         case N_PROGRAM:
-            typecheck_program(ast);
+            typecheck_program(tc, ast);
             break;
         case N_BLOCK_STMT:
-            typecheck_block_stmt(ast);
+            typecheck_block_stmt(tc, ast);
             break;
         case N_VAR_DECL:
-            typecheck_var_decl(ast);
+            typecheck_var_decl(tc, ast);
             break;
         case N_FUNC_DECL:
-            typecheck_func_decl(ast);
+            typecheck_func_decl(tc, ast);
             break;
         case N_CALL_EXPR:
-            typecheck_call_expr(ast);
+            typecheck_call_expr(tc, ast);
             break;
         case N_FORMAL:
-            typecheck_formal(ast);
+            typecheck_formal(tc, ast);
             break;
         case N_IDENT:
-            typecheck_ident(ast);
+            typecheck_ident(tc, ast);
             break;
         case N_BINOP_EXPR:
-            typecheck_binop_expr(ast);
+            typecheck_binop_expr(tc, ast);
             break;
         case N_ASSIGN_EXPR:
-            typecheck_assign_expr(ast);
+            typecheck_assign_expr(tc, ast);
             break;
         case N_IF_STMT:
-            typecheck_if_stmt(ast);
+            typecheck_if_stmt(tc, ast);
             break;
         case N_INTEGER_LITERAL:
         case N_FLOAT_LITERAL:
         case N_STRING_LITERAL:
         case N_BOOL_LITERAL:
-            typecheck_literal(ast);
+            typecheck_literal(tc, ast);
             break;
         case N_RETURN_STMT:
-            typecheck_return_stmt(ast);
+            typecheck_return_stmt(tc, ast);
             break;
         case N_NIL:
-            typecheck_nil(ast);
+            typecheck_nil(tc, ast);
             break;
         case N_STRUCT_DECL:
-            typecheck_struct_decl(ast);
+            typecheck_struct_decl(tc, ast);
             break;
         case N_MEMBER_DECL:
-            typecheck_member_decl(ast);
+            typecheck_member_decl(tc, ast);
             break;
         case N_STRUCT_ACCESS_EXPR:
-            typecheck_struct_access(ast);
+            typecheck_struct_access(tc, ast);
             break;
         case N_LABEL_DECL:
-            typecheck_label_decl(ast);
+            typecheck_label_decl(tc, ast);
             break;
         case N_GOTO_STMT:
-            typecheck_goto_stmt(ast);
+            typecheck_goto_stmt(tc, ast);
             break;
         case N_ARRAY_INIT_EXPR:
-            typecheck_array_init_expr(ast);
+            typecheck_array_init_expr(tc, ast);
             break;
         case N_ARRAY_ACCESS_EXPR:
-            typecheck_array_access_expr(ast);
+            typecheck_array_access_expr(tc, ast);
             break;
         case N_WHILE_STMT:
-            typecheck_while_stmt(ast);
+            typecheck_while_stmt(tc, ast);
             break;
         case N_EMPTY_EXPR:
-            typecheck_empty_expr(ast);
+            typecheck_empty_expr(tc, ast);
             break;
         case N_NEG_EXPR:
-            typecheck_neg_expr(ast);
+            typecheck_neg_expr(tc, ast);
             break;
         case N_NOT_EXPR:
-            typecheck_not_expr(ast);
+            typecheck_not_expr(tc, ast);
             break;
         default:
-            type_error("Unknown node type", ast);
+            type_error(tc, "Unknown node type", ast);
             break;
     }
 }
 
-static bool is_numerical_type(type_t type) {
-    return (type.datatype == D_FLOAT || type.datatype == D_INTEGER);
+static bool is_numerical_type(type_id_t type) {
+    return (type == typetab_primitive(D_FLOAT) || type == typetab_primitive(D_INTEGER));
 }
 
-// Use for leaf nodes
-static type_t get_type(node *n) {
+// Resolves the type of expression n and annotates n with it, or returns the annotation if it has
+// already been resolved. Operators are typechecked on the way, since that is what resolves them.
+static type_id_t get_type(typechecker_t *tc, node *n) {
     if (NULL == n) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
-    debug("Calling get_type() on node type %d", n->type);
+    if (TYPE_NONE != n->type_id) {
+        return n->type_id;
+    }
+
+    trace(TRACE_TYPECHECK, TRACE_VERBOSE, "Calling get_type() on node type %d", n->type);
+
+    if ((N_BINOP_EXPR == n->type) || (N_NEG_EXPR == n->type) || (N_NOT_EXPR == n->type)) {
+        do_typecheck(tc, n);
+        return n->type_id;
+    }
 
-    type_t type = {
-        .datatype = D_UNKNOWN, .is_array = false, .is_function = false, .struct_type = ""};
+    type_id_t type = typetab_primitive(D_UNKNOWN);
 
     switch (n->type) {
         case N_IDENT:
             // Get identifier type from the symbol table
-            binding_t *ident_binding = symtab_lookup(curr_scope, n->data.identifier.name, false);
+            binding_t *ident_binding =
+                symtab_lookup(tc->symbol_table, n->data.identifier.name, false);
             if (NULL != ident_binding) {
                 switch (ident_binding->symbol_type) {
                     case SYMBOL_TYPE_FUNCTION:
-                        type.datatype    = ident_binding->data.function_type.return_type;
-                        type.is_function = true;
-                        snprintf(type.struct_type, MAX_LITERAL,
-                                 ident_binding->data.function_type.struct_type);
+                        type = ident_binding->data.function_type.type_id;
                         break;
                     case SYMBOL_TYPE_VARIABLE:
-                        type.datatype = ident_binding->data.variable_type.type;
-                        type.is_array = ident_binding->data.variable_type.is_array_type;
-                        snprintf(type.struct_type, MAX_LITERAL,
-                                 ident_binding->data.variable_type.struct_type);
-                        break;
                     case SYMBOL_TYPE_FORMAL:
-                        type.datatype = ident_binding->data.variable_type.type;
-                        type.is_array = ident_binding->data.variable_type.is_array_type;
-                        snprintf(type.struct_type, MAX_LITERAL,
-                                 ident_binding->data.variable_type.struct_type);
+                        type = ident_binding->data.variable_type.type_id;
                         break;
                     case SYMBOL_TYPE_STRUCTURE:
                         log_error("SYMBOL_TYPE_STRUCTURE not implemented yet: %s",
@@ -312,109 +334,56 @@ static type_t get_type(node *n) {
                 char err_msg[MAX_ERROR_LEN] = {0};
                 snprintf(err_msg, MAX_ERROR_LEN, "Unknown identifier '%s'",
                          n->data.identifier.name);
-                type_error(err_msg, n);
+                type_error(tc, err_msg, n);
             }
             break;
         case N_FORMAL:
-            binding_t *formal_binding = symtab_lookup(curr_scope, n->data.formal.name, false);
+            binding_t *formal_binding = symtab_lookup(tc->symbol_table, n->data.formal.name, false);
             if (NULL != formal_binding) {
-                type.datatype = formal_binding->data.variable_type.type;
-                type.is_array = formal_binding->data.variable_type.is_array_type;
+                type = formal_binding->data.variable_type.type_id;
             }
             break;
         case N_INTEGER_LITERAL:
-            type.datatype = n->data.integer_literal.type;
+            type = typetab_primitive(n->data.integer_literal.type);
             break;
         case N_FLOAT_LITERAL:
-            type.datatype = n->data.float_literal.type;
+            type = typetab_primitive(n->data.float_literal.type);
             break;
         case N_STRING_LITERAL:
-            type.datatype = n->data.string_literal.type;
+            type = typetab_primitive(n->data.string_literal.type);
             break;
         case N_BOOL_LITERAL:
-            type.datatype = n->data.bool_literal.type;
+            type = typetab_primitive(n->data.bool_literal.type);
             break;
         case N_NIL:
-            type.datatype = D_NIL;
-            break;
-        case N_BINOP_EXPR:
-            // Visit the LHS in case this is nested
-            do_typecheck(n->data.bin_op_expr.lhs);
-            type_t lhs = get_type(n->data.bin_op_expr.lhs);
-
-            // Visit the LHS in case this is nested
-            do_typecheck(n->data.bin_op_expr.rhs);
-            type_t rhs = get_type(n->data.bin_op_expr.rhs);
-
-            switch (n->data.bin_op_expr.operator) {
-                case T_PLUS:
-                case T_MINUS:
-                case T_MUL:
-                case T_DIV:
-                case T_MOD:
-                    if (is_numerical_type(lhs) || is_numerical_type(rhs)) {
-                        if (lhs.datatype == D_FLOAT || rhs.datatype == D_FLOAT) {
-                            type.datatype = D_FLOAT;
-                        } else {
-                            type.datatype = D_INTEGER;
-                        }
-                    }
-                    break;
-                case T_LT:
-                case T_GT:
-                case T_EQ:
-                case T_LE:
-                case T_GE:
-                case T_NE:
-                case T_AND:
-                case T_OR:
-                case T_BANG:
-                    type.datatype = D_BOOLEAN;
-                    break;
-                default:
-                    print_node(n, 0);
-                    log_error("Unsupported operator type %d", n->data.bin_op_expr.operator);
-            }
+            type = typetab_primitive(D_NIL);
             break;
         case N_CALL_EXPR:
-            binding_t *call_binding = symtab_lookup(curr_scope, n->data.call_expr.func_name, false);
-            if (NULL != call_binding) {
-                type.datatype    = call_binding->data.function_type.return_type;
-                type.is_function = true;
-                type.is_array    = call_binding->data.function_type.is_array_type;
-                snprintf(type.struct_type, MAX_LITERAL,
-                         call_binding->data.function_type.struct_type);
+            binding_t *call_binding =
+                symtab_lookup(tc->symbol_table, n->data.call_expr.func_name, false);
+            if ((NULL != call_binding) && (SYMBOL_TYPE_FUNCTION == call_binding->symbol_type)) {
+                // A call is of the type its function returns
+                type = typetab_get(tc->types, call_binding->data.function_type.type_id)->base;
             }
             break;
-        case N_NEG_EXPR:
-            do_typecheck(n);
-            type = get_type(n->data.neg_expr.expr);
-            break;
-        case N_NOT_EXPR:
-            do_typecheck(n);
-            type = get_type(n->data.not_expr.expr);
-            break;
         case N_STRUCT_ACCESS_EXPR:
             binding_t *variable_binding =
-                symtab_lookup(curr_scope, n->data.struct_access.name, false);
+                symtab_lookup(tc->symbol_table, n->data.struct_access.name, false);
             if (NULL != variable_binding) {
                 // Now, find the structure declaration
                 binding_t *struct_binding = symtab_lookup(
-                    curr_scope, variable_binding->data.variable_type.struct_type, false);
+                    tc->symbol_table, variable_binding->data.variable_type.struct_type, false);
                 if (NULL != struct_binding) {
                     // Get the member
-                    vecnode *vn = struct_binding->data.structure_type.members->head;
-                    while (NULL != vn) {
-                        node *mn = (node *)vn->data;
-                        if (NULL != mn) {
-                            if (0 == strcmp(n->data.struct_access.member_name,
-                                            mn->data.member_decl.name)) {
-                                // We found a member with that name
-                                type.datatype = mn->data.member_decl.type;
-                                break;
-                            }
-
-                            vn = vn->next;
+                    vector *members = struct_binding->data.structure_type.members;
+                    for (int idx = 0; idx < vector_length(members); idx++) {
+                        node *mn = (node *)vector_get(members, idx);
+
+                        // Both names are interned
+                        if (n->data.struct_access.member_name == mn->data.member_decl.name) {
+                            // We found a member with that name
+                            type = typetab_primitive(mn->data.member_decl.type);
+                            break;
                         }
                     }
                 }
@@ -425,10 +394,15 @@ static type_t get_type(node *n) {
             log_error("Type %d not implemented yet", n->type);
     }
 
-    return type;
+    n->type_id = type;
+
+    return n->type_id;
 }
 
-static bool match_types(node *a, node *b, type_t *type_a, type_t *type_b) {
+// Resolves the types of a and b, which are left in type_a and type_b, and returns whether they
+// match
+static bool match_types(typechecker_t *tc, node *a, node *b, const type_t **type_a,
+                        const type_t **type_b) {
     bool result = false;
 
     if (NULL == a) {
@@ -439,80 +413,80 @@ static bool match_types(node *a, node *b, type_t *type_a, type_t *type_b) {
         log_error("Unable to access node B for type matching");
     }
 
-    debug("Node A is of node type %d", a->type);
-    debug("Node B is of node type %d", b->type);
+    trace(TRACE_TYPECHECK, TRACE_VERBOSE, "Node A is of node type %d", a->type);
+    trace(TRACE_TYPECHECK, TRACE_VERBOSE, "Node B is of node type %d", b->type);
 
-    type_t a_type = get_type(a);
-    type_t b_type = get_type(b);
+    const type_id_t a_id = get_type(tc, a);
+    const type_id_t b_id = get_type(tc, b);
 
-    // TODO become more clever with structs, arrays, boolean expressions, etc.
-    result = (a_type.datatype == b_type.datatype);
+    *type_a = typetab_get(tc->types, a_id);
+    *type_b = typetab_get(tc->types, b_id);
 
-    *type_a = a_type;
-    *type_b = b_type;
+    // Types are interned, so structs, arrays and functions match only when they are the same type
+    result = (a_id == b_id);
 
     return result;
 }
 
-static void typecheck_program(node *ast) {
-    printf("Typechecking program\n");
+static void typecheck_program(typechecker_t *tc, node *ast) {
+    diag_printf("Typechecking program\n");
     if (ast != NULL) {
         // Typecheck children
-        if (ast->data.program.statements->head != NULL) {
-            vecnode *vn = ast->data.program.statements->head;
-            while (vn != NULL) {
-                node *n = vn->data;
-
-                if (NULL != n) {
-                    do_typecheck(n);
-                    vn = vn->next;
-                }
-            }
+        vector *statements = ast->data.program.statements;
+        for (int idx = 0; idx < vector_length(statements); idx++) {
+            do_typecheck(tc, vector_get(statements, idx));
         }
     }
 }
 
-static void typecheck_block_stmt(node *ast) {
+static void typecheck_block_stmt(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
-    vecnode *vn = ast->data.block_stmt.statements->head;
-    while (NULL != vn) {
-        node *n = vn->data;
-        do_typecheck(n);
-
-        vn = vn->next;
+    vector *statements = ast->data.block_stmt.statements;
+    for (int idx = 0; idx < vector_length(statements); idx++) {
+        do_typecheck(tc, vector_get(statements, idx));
     }
 }
 
-static void typecheck_var_decl(node *ast) {
+static void typecheck_var_decl(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Check if binding already exists within current scope
-    binding_t *existing_binding = symtab_lookup(curr_scope, ast->data.var_decl.name, false);
+    binding_t *existing_binding = symtab_lookup(tc->symbol_table, ast->data.var_decl.name, false);
     if (NULL != existing_binding) {
         char err_msg[MAX_ERROR_LEN] = {0};
         snprintf(err_msg, MAX_ERROR_LEN, "Redefinition of '%s'", existing_binding->name);
-        type_error(err_msg, ast);
+        type_error(tc, err_msg, ast);
     }
 
+    const type_id_t var_type =
+        declared_type(tc, ast->data.var_decl.type, ast->data.var_decl.struct_type,
+                      ast->data.var_decl.is_struct, ast->data.var_decl.is_array,
+                      ast->data.var_decl.num_dimensions);
+
     // Check the RHS of the initialization
     if (NULL != ast->data.var_decl.value) {
-        type_t init_type = get_type(ast->data.var_decl.value);
-        if ((init_type.datatype != D_NIL) && (ast->data.var_decl.type != init_type.datatype)) {
-            char err_msg[MAX_ERROR_LEN] = {0};
+        do_typecheck(tc, ast->data.var_decl.value);
+
+        const type_id_t init_type = get_type(tc, ast->data.var_decl.value);
+        if ((init_type != typetab_primitive(D_NIL)) && (init_type != var_type) &&
+            !is_error_type(init_type)) {
+            char err_msg[MAX_ERROR_LEN]  = {0};
+            char expected[MAX_TYPE_NAME] = {0};
+            char got[MAX_TYPE_NAME]      = {0};
             snprintf(
                 err_msg, MAX_ERROR_LEN,
                 "Type mismatch between variable type and initialization value. Expected '%s'. Got "
                 "'%s'.",
-                type_to_str(ast->data.var_decl.type), type_to_str(init_type.datatype));
-            type_error(err_msg, ast);
+                type_name(tc, var_type, expected), type_name(tc, init_type, got));
+            type_error(tc, err_msg, ast);
         }
     } else {
-        debug("VarDecl of '%s' right-hand side is empty", ast->data.var_decl.name);
+        debug(TRACE_TYPECHECK, "VarDecl of '%s' right-hand side is empty", ast->data.var_decl.name);
     }
 
     // Create new binding
@@ -522,32 +496,31 @@ static void typecheck_var_decl(node *ast) {
     }
 
     // Populate binding data
-    snprintf(new_binding->name, MAX_LITERAL, ast->data.var_decl.name);
-    snprintf(new_binding->data.variable_type.struct_type, MAX_LITERAL,
-             ast->data.var_decl.struct_type);
-
+    new_binding->name                              = ast->data.var_decl.name;
+    new_binding->data.variable_type.type_id        = var_type;
+    new_binding->data.variable_type.struct_type    = ast->data.var_decl.struct_type;
     new_binding->data.variable_type.type           = ast->data.var_decl.type;
     new_binding->data.variable_type.is_array_type  = ast->data.var_decl.is_array;
     new_binding->data.variable_type.is_struct_type = ast->data.var_decl.is_struct;
     new_binding->data.variable_type.num_dimensions = ast->data.var_decl.num_dimensions;
 
     // Insert binding into symbol table
-    symtab_insert(curr_scope, new_binding);
-    print_symbol_table(symbol_table);
+    symtab_insert(tc->symbol_table, new_binding);
+    trace_symbol_table(tc);
 }
 
-static void typecheck_func_decl(node *ast) {
+static void typecheck_func_decl(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Check if the function name is already defined. We do not support overloading, for now...
-    binding_t *ident_binding = symtab_lookup(curr_scope, ast->data.function_decl.name, false);
+    binding_t *ident_binding = symtab_lookup(tc->symbol_table, ast->data.function_decl.name, false);
     if (NULL != ident_binding) {
         char err_msg[MAX_ERROR_LEN] = {0};
         snprintf(err_msg, MAX_ERROR_LEN, "Redefinition of '%s'. Function is previously declared",
                  ast->data.function_decl.name);
-        type_error(err_msg, ast);
+        type_error(tc, err_msg, ast);
     }
 
     // Create new binding and add it to the current scope
@@ -557,10 +530,8 @@ static void typecheck_func_decl(node *ast) {
     }
 
     // Populate binding data
-    snprintf(new_binding->name, MAX_LITERAL, ast->data.function_decl.name);
-    snprintf(new_binding->data.function_type.struct_type, MAX_LITERAL,
-             ast->data.function_decl.struct_type);
-
+    new_binding->name                              = ast->data.function_decl.name;
+    new_binding->data.function_type.struct_type    = ast->data.function_decl.struct_type;
     new_binding->data.function_type.return_type    = ast->data.function_decl.type;
     new_binding->data.function_type.is_array_type  = ast->data.function_decl.is_array;
     new_binding->data.function_type.is_struct_type = ast->data.function_decl.is_struct;
@@ -568,40 +539,44 @@ static void typecheck_func_decl(node *ast) {
     new_binding->data.function_type.num_args       = vector_length(ast->data.function_decl.formals);
     new_binding->data.function_type.formals        = ast->data.function_decl.formals;
 
+    const type_id_t result =
+        declared_type(tc, ast->data.function_decl.type, ast->data.function_decl.struct_type,
+                      ast->data.function_decl.is_struct, ast->data.function_decl.is_array,
+                      ast->data.function_decl.num_dimensions);
+    new_binding->data.function_type.type_id =
+        function_type(tc, result, ast->data.function_decl.formals);
+
     // Insert binding into symbol table
-    symtab_insert(curr_scope, new_binding);
-    print_symbol_table(symbol_table);
+    symtab_insert(tc->symbol_table, new_binding);
+    trace_symbol_table(tc);
 
     // Now, create a new scope and enter the function body
-    enter_new_scope(new_binding->name);
+    enter_new_scope(tc, new_binding->name);
 
     if (new_binding->data.function_type.num_args > 0) {
         // Add the formals to the new scope
-        vecnode *vn = ast->data.function_decl.formals->head;
-        while (NULL != vn) {
-            node *n = vn->data;
-
-            do_typecheck(n);
-
-            vn = vn->next;
+        vector *formals = ast->data.function_decl.formals;
+        for (int idx = 0; idx < vector_length(formals); idx++) {
+            do_typecheck(tc, vector_get(formals, idx));
         }
     }
 
     // Check the body
-    do_typecheck(ast->data.function_decl.body);
+    do_typecheck(tc, ast->data.function_decl.body);
 
     // Leave scope
-    leave_curr_scope();
+    leave_curr_scope(tc);
 }
 
-static void typecheck_call_expr(node *ast) {
+static void typecheck_call_expr(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Get identifier type from the symbol table
-    binding_t *call_expr_binding = symtab_lookup(curr_scope, ast->data.call_expr.func_name, false);
-    if (NULL != call_expr_binding) {
+    binding_t *call_expr_binding =
+        symtab_lookup(tc->symbol_table, ast->data.call_expr.func_name, false);
+    if ((NULL != call_expr_binding) && (SYMBOL_TYPE_FUNCTION == call_expr_binding->symbol_type)) {
 
         // Check the lengths of the argument lists
         if (vector_length(ast->data.call_expr.args) !=
@@ -613,63 +588,42 @@ static void typecheck_call_expr(node *ast) {
                      ast->data.call_expr.func_name, call_expr_binding->name,
                      call_expr_binding->data.function_type.num_args,
                      vector_length(ast->data.call_expr.args));
-            type_error(err_msg, ast);
+            type_error(tc, err_msg, ast);
+
+            // The arguments cannot be matched up with the signature, but are checked on their own
+            vector *args = ast->data.call_expr.args;
+            for (int position = 0; position < vector_length(args); position++) {
+                do_typecheck(tc, vector_get(args, position));
+            }
+            return;
         }
 
         if (vector_length(ast->data.call_expr.args) > 0) {
-            vecnode *binding_arg_node         = call_expr_binding->data.function_type.formals->head;
-            unsigned int binding_arg_position = 0;
-
-            while (NULL != binding_arg_node) {
-                node *binding_arg = binding_arg_node->data;
-
-                if (NULL != binding_arg) {
-                    // Function is already defined, and lengths of argument lists match.
-                    vecnode *call_arg_node         = ast->data.call_expr.args->head;
-                    unsigned int call_arg_position = 0;
-
-                    while (NULL != call_arg_node) {
-                        node *call_arg = call_arg_node->data;
-
-                        if (NULL != call_arg) {
-                            // Compare each argument, position by position
-                            if (binding_arg_position == call_arg_position) {
-                                // Visit argument
-                                do_typecheck(call_arg);
-
-                                // We don't need to call get_type() because we already have the
-                                // binding.
-                                type_t binding_arg_type = {
-                                    .datatype    = binding_arg->data.formal.type,
-                                    .is_array    = binding_arg->data.formal.is_array,
-                                    .is_function = false,
-                                };
-                                snprintf(binding_arg_type.struct_type, MAX_LITERAL,
-                                         binding_arg->data.formal.struct_type);
-
-                                type_t call_arg_type = get_type(call_arg);
-
-                                if (binding_arg_type.datatype != call_arg_type.datatype) {
-                                    char err_msg[MAX_ERROR_LEN] = {0};
-                                    snprintf(
-                                        err_msg, MAX_ERROR_LEN,
-                                        "Type mismatch. Argument in position %d does not match "
-                                        "types with the function declaration of '%s'. Expected "
-                                        "'%s'. Got '%s'.",
-                                        call_arg_position, call_expr_binding->name,
-                                        type_to_str(binding_arg_type.datatype),
-                                        type_to_str(call_arg_type.datatype));
-                                    type_error(err_msg, call_arg);
-                                }
-                            }
-
-                            call_arg_position++;
-                            call_arg_node = call_arg_node->next;
-                        }
-                    }
-
-                    binding_arg_position++;
-                    binding_arg_node = binding_arg_node->next;
+            const type_t *signature =
+                typetab_get(tc->types, call_expr_binding->data.function_type.type_id);
+            vector *args = ast->data.call_expr.args;
+
+            // Function is already defined, and lengths of argument lists match. Compare each
+            // argument, position by position, against the types in the function's signature.
+            for (int position = 0; position < vector_length(args); position++) {
+                node *call_arg = vector_get(args, position);
+
+                // Visit argument
+                do_typecheck(tc, call_arg);
+
+                const type_id_t param_id    = signature->params[position];
+                const type_id_t call_arg_id = get_type(tc, call_arg);
+
+                if ((param_id != call_arg_id) && !is_error_type(call_arg_id)) {
+                    char err_msg[MAX_ERROR_LEN]  = {0};
+                    char expected[MAX_TYPE_NAME] = {0};
+                    char got[MAX_TYPE_NAME]      = {0};
+                    snprintf(err_msg, MAX_ERROR_LEN,
+                             "Type mismatch. Argument in position %d does not match types with the "
+                             "function declaration of '%s'. Expected '%s'. Got '%s'.",
+                             position, call_expr_binding->name,
+                             type_name(tc, param_id, expected), type_name(tc, call_arg_id, got));
+                    type_error(tc, err_msg, call_arg);
                 }
             }
         }
@@ -678,17 +632,17 @@ static void typecheck_call_expr(node *ast) {
         char err_msg[MAX_ERROR_LEN] = {0};
         snprintf(err_msg, MAX_ERROR_LEN, "Implicit declaration of function '%s'",
                  ast->data.call_expr.func_name);
-        type_error(err_msg, ast);
+        type_error(tc, err_msg, ast);
     }
 }
 
-static void typecheck_formal(node *ast) {
+static void typecheck_formal(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Check if we've already seen this formal within the current scope
-    binding_t *formal_binding = symtab_lookup(curr_scope, ast->data.formal.name, true);
+    binding_t *formal_binding = symtab_lookup(tc->symbol_table, ast->data.formal.name, true);
     if (NULL != formal_binding) {
         // Is the existing binding a formal?
         if (formal_binding->symbol_type == SYMBOL_TYPE_FORMAL) {
@@ -696,7 +650,7 @@ static void typecheck_formal(node *ast) {
             snprintf(err_msg, MAX_ERROR_LEN,
                      "Redefinition of '%s'. Function formal argument is previously declared",
                      ast->data.formal.name);
-            type_error(err_msg, ast);
+            type_error(tc, err_msg, ast);
         } else {
             print_binding(formal_binding);
         }
@@ -708,50 +662,56 @@ static void typecheck_formal(node *ast) {
         }
 
         // Populate binding data
-        snprintf(new_binding->name, MAX_LITERAL, ast->data.formal.name);
-        snprintf(new_binding->data.variable_type.struct_type, MAX_LITERAL,
-                 ast->data.formal.struct_type);
-
+        new_binding->name                              = ast->data.formal.name;
+        new_binding->data.variable_type.type_id        = formal_type(tc, ast);
+        new_binding->data.variable_type.struct_type    = ast->data.formal.struct_type;
         new_binding->data.variable_type.type           = ast->data.formal.type;
         new_binding->data.variable_type.is_array_type  = ast->data.formal.is_array;
         new_binding->data.variable_type.is_struct_type = ast->data.formal.is_struct;
         new_binding->data.variable_type.num_dimensions = ast->data.formal.num_dimensions;
 
         // Insert binding into symbol table
-        symtab_insert(curr_scope, new_binding);
-        print_symbol_table(symbol_table);
+        symtab_insert(tc->symbol_table, new_binding);
+        trace_symbol_table(tc);
     }
 }
 
-static void typecheck_ident(node *ast) {
+static void typecheck_ident(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Check if the identifier is within the symbol table
-    binding_t *ident_binding = symtab_lookup(curr_scope, ast->data.identifier.name, false);
+    binding_t *ident_binding = symtab_lookup(tc->symbol_table, ast->data.identifier.name, false);
     if (NULL == ident_binding) {
         char err_msg[MAX_ERROR_LEN] = {0};
         snprintf(err_msg, MAX_ERROR_LEN, "Undeclared identifier '%s'", ast->data.identifier.name);
-        type_error(err_msg, ast);
+        type_error(tc, err_msg, ast);
+
+        ast->type_id = typetab_primitive(D_UNKNOWN);
     }
 }
 
-static void typecheck_binop_expr(node *ast) {
+static void typecheck_binop_expr(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Visit LHS
-    do_typecheck(ast->data.bin_op_expr.lhs);
+    do_typecheck(tc, ast->data.bin_op_expr.lhs);
 
     // Visit RHS
-    do_typecheck(ast->data.bin_op_expr.rhs);
+    do_typecheck(tc, ast->data.bin_op_expr.rhs);
 
-    type_t lhs = get_type(ast->data.bin_op_expr.lhs);
-    type_t rhs = get_type(ast->data.bin_op_expr.rhs);
+    const type_t *lhs = NULL;
+    const type_t *rhs = NULL;
+    const bool match =
+        match_types(tc, ast->data.bin_op_expr.lhs, ast->data.bin_op_expr.rhs, &lhs, &rhs);
 
-    print_symbol_table(symbol_table);
+    trace_symbol_table(tc);
+
+    // Whichever side is in error has been reported already
+    const bool in_error = is_error_type(lhs->id) || is_error_type(rhs->id);
 
     switch (ast->data.bin_op_expr.operator) {
         case T_PLUS:
@@ -759,17 +719,25 @@ static void typecheck_binop_expr(node *ast) {
         case T_MUL:
         case T_DIV:
         case T_MOD:
-            if (!is_numerical_type(lhs) || !is_numerical_type(rhs)) {
+            if ((!is_numerical_type(lhs->id) || !is_numerical_type(rhs->id)) && !in_error) {
                 // If either datatype is not a number
-                debug("got here");
+                debug(TRACE_TYPECHECK, "got here");
 
                 // And the operator is arithmetic, raise an error
-                char err_msg[MAX_ERROR_LEN] = {0};
+                char err_msg[MAX_ERROR_LEN]  = {0};
+                char lhs_name[MAX_TYPE_NAME] = {0};
+                char rhs_name[MAX_TYPE_NAME] = {0};
                 snprintf(err_msg, MAX_ERROR_LEN,
                          "Type mismatch. Both data types must be numeric in order to perform "
                          "arithmetic operations. Left-hand side is '%s'. Right hand side is '%s'.",
-                         type_to_str(lhs.datatype), type_to_str(rhs.datatype));
-                type_error(err_msg, ast);
+                         type_name(tc, lhs->id, lhs_name), type_name(tc, rhs->id, rhs_name));
+                type_error(tc, err_msg, ast);
+            }
+
+            if ((lhs->datatype == D_FLOAT) || (rhs->datatype == D_FLOAT)) {
+                ast->type_id = typetab_primitive(D_FLOAT);
+            } else {
+                ast->type_id = typetab_primitive(D_INTEGER);
             }
             break;
         case T_LT:
@@ -781,75 +749,85 @@ static void typecheck_binop_expr(node *ast) {
         case T_AND:
         case T_OR:
         case T_BANG:
-            if (!match_types(ast->data.bin_op_expr.lhs, ast->data.bin_op_expr.rhs, &lhs, &rhs)) {
-                char err_msg[MAX_ERROR_LEN] = {0};
+            if (!match && !in_error) {
+                char err_msg[MAX_ERROR_LEN]  = {0};
+                char lhs_name[MAX_TYPE_NAME] = {0};
+                char rhs_name[MAX_TYPE_NAME] = {0};
                 snprintf(err_msg, MAX_ERROR_LEN,
                          "Type mismatch. Left-hand side is '%s'. Right hand side is '%s'.",
-                         type_to_str(lhs.datatype), type_to_str(rhs.datatype));
-                type_error(err_msg, ast);
+                         type_name(tc, lhs->id, lhs_name), type_name(tc, rhs->id, rhs_name));
+                type_error(tc, err_msg, ast);
             }
 
+            ast->type_id = typetab_primitive(D_BOOLEAN);
             break;
         default:
-            type_error("Unsupported operator for binary expression. Expected arithmetic or logical "
+            type_error(tc,
+                       "Unsupported operator for binary expression. Expected arithmetic or logical "
                        "operators",
                        ast);
+            ast->type_id = typetab_primitive(D_UNKNOWN);
     }
 }
 
-static void typecheck_assign_expr(node *ast) {
+static void typecheck_assign_expr(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Visit LHS
-    do_typecheck(ast->data.assign_expr.lhs);
+    do_typecheck(tc, ast->data.assign_expr.lhs);
 
     // Visit RHS
-    do_typecheck(ast->data.assign_expr.rhs);
+    do_typecheck(tc, ast->data.assign_expr.rhs);
 
-    type_t lhs_type = {0};
-    type_t rhs_type = {0};
+    const type_t *lhs_type = NULL;
+    const type_t *rhs_type = NULL;
 
     // Check if LHS type and RHS type match
-    if (!match_types(ast->data.assign_expr.lhs, ast->data.assign_expr.rhs, &lhs_type, &rhs_type)) {
-        char err_msg[MAX_ERROR_LEN] = {0};
+    if (!match_types(tc, ast->data.assign_expr.lhs, ast->data.assign_expr.rhs, &lhs_type,
+                     &rhs_type) &&
+        !is_error_type(lhs_type->id) && !is_error_type(rhs_type->id)) {
+        char err_msg[MAX_ERROR_LEN]  = {0};
+        char expected[MAX_TYPE_NAME] = {0};
+        char got[MAX_TYPE_NAME]      = {0};
         snprintf(err_msg, MAX_ERROR_LEN, "Type mismatch. Expected '%s'. Got '%s'.",
-                 type_to_str(lhs_type.datatype), type_to_str(rhs_type.datatype));
-        type_error(err_msg, ast);
+                 type_name(tc, lhs_type->id, expected), type_name(tc, rhs_type->id, got));
+        type_error(tc, err_msg, ast);
     }
 }
 
-static void typecheck_if_stmt(node *ast) {
+static void typecheck_if_stmt(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Visit test
-    do_typecheck(ast->data.if_stmt.test);
+    do_typecheck(tc, ast->data.if_stmt.test);
 
     // Pass down the scope name, if it exists. If it does exist, we are within a function.
     // Otherwise, we are within the global scope.
-    char *scope_name = (strlen(curr_scope->name) > 0) ? curr_scope->name : NULL;
+    const scope_t *scope   = symtab_scope(tc->symbol_table);
+    const char *scope_name = (scope->name != strtab_empty) ? scope->name : NULL;
 
-    enter_new_scope(scope_name);
+    enter_new_scope(tc, scope_name);
 
     // Visit body
-    do_typecheck(ast->data.if_stmt.body);
+    do_typecheck(tc, ast->data.if_stmt.body);
 
-    leave_curr_scope();
+    leave_curr_scope(tc);
 
     // Visit else statement, if it exists
     if (NULL != ast->data.if_stmt.else_stmt) {
-        enter_new_scope(scope_name);
+        enter_new_scope(tc, scope_name);
 
-        do_typecheck(ast->data.if_stmt.else_stmt);
+        do_typecheck(tc, ast->data.if_stmt.else_stmt);
 
-        leave_curr_scope();
+        leave_curr_scope(tc);
     }
 }
 
-static void typecheck_literal(node *ast) {
+static void typecheck_literal(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
@@ -857,43 +835,49 @@ static void typecheck_literal(node *ast) {
     // Nothing to do
 }
 
-static void typecheck_return_stmt(node *ast) {
+static void typecheck_return_stmt(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Since function definitions are contained within the parent scope, check the parent scope for
     // our function's return type
-    if (NULL == curr_scope->prev) {
-        // If the parent scope is NULL, this means we are already in the global scope,
+    const scope_t *scope = symtab_scope(tc->symbol_table);
+    if (0 == scope->level) {
+        // If there is no parent scope, this means we are already in the global scope,
         // so we are likely a stray return outside of any function
-        type_error("'return' found outside of a function body.", ast);
+        type_error(tc, "'return' found outside of a function body.", ast);
+        return;
     }
 
-    binding_t *func_binding = symtab_lookup(curr_scope->prev, curr_scope->name, false);
+    binding_t *func_binding = symtab_lookup_enclosing(tc->symbol_table, scope->name);
     if (NULL == func_binding) {
         // This means we are in a return statement for a function that does not exist.
-        log_error("Undefined function '%s'. This should not happen.", curr_scope->name);
+        log_error("Undefined function '%s'. This should not happen.", scope->name);
     }
 
     if (NULL != ast->data.return_stmt.expr) {
         // Visit the expression
-        do_typecheck(ast->data.return_stmt.expr);
+        do_typecheck(tc, ast->data.return_stmt.expr);
 
         // Get its type
-        type_t return_expr_type = get_type(ast->data.return_stmt.expr);
+        const type_id_t return_expr_type = get_type(tc, ast->data.return_stmt.expr);
+        const type_t *signature =
+            typetab_get(tc->types, func_binding->data.function_type.type_id);
 
         // Compare against the function return type
-        debug("Return expr type is %d", return_expr_type.datatype);
+        debug(TRACE_TYPECHECK, "Return expr type is %u", return_expr_type);
 
-        if (return_expr_type.datatype != func_binding->data.function_type.return_type) {
-            char err_msg[MAX_ERROR_LEN] = {0};
+        if ((return_expr_type != signature->base) && !is_error_type(return_expr_type)) {
+            char err_msg[MAX_ERROR_LEN]  = {0};
+            char expected[MAX_TYPE_NAME] = {0};
+            char got[MAX_TYPE_NAME]      = {0};
             snprintf(err_msg, MAX_ERROR_LEN,
                      "Type mismatch between '%s' return type and return statement. Expected '%s'. "
                      "Got '%s'.",
-                     func_binding->name, type_to_str(func_binding->data.function_type.return_type),
-                     type_to_str(return_expr_type.datatype));
-            type_error(err_msg, ast);
+                     func_binding->name, type_name(tc, signature->base, expected),
+                     type_name(tc, return_expr_type, got));
+            type_error(tc, err_msg, ast);
         }
     } else {
         // This is an empty return statement. Instead of returning a value, we are leaving the
@@ -904,12 +888,12 @@ static void typecheck_return_stmt(node *ast) {
                      "Empty return statements are not permitted within non-void functions. "
                      "Function name = '%s'",
                      func_binding->name);
-            type_error(err_msg, ast);
+            type_error(tc, err_msg, ast);
         }
     }
 }
 
-static void typecheck_nil(node *ast) {
+static void typecheck_nil(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
@@ -920,18 +904,18 @@ static void typecheck_nil(node *ast) {
     // This might be removed in the future.
 }
 
-static void typecheck_struct_decl(node *ast) {
+static void typecheck_struct_decl(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Check if the struct is already defined.
-    binding_t *struct_binding = symtab_lookup(curr_scope, ast->data.struct_decl.name, false);
+    binding_t *struct_binding = symtab_lookup(tc->symbol_table, ast->data.struct_decl.name, false);
     if (NULL != struct_binding) {
         char err_msg[MAX_ERROR_LEN] = {0};
         snprintf(err_msg, MAX_ERROR_LEN, "Redefinition of '%s'. Structure is previously declared",
                  ast->data.struct_decl.name);
-        type_error(err_msg, ast);
+        type_error(tc, err_msg, ast);
     }
 
     // Create new binding and add it to the current scope
@@ -940,40 +924,36 @@ static void typecheck_struct_decl(node *ast) {
         log_error("%s(): Unable to create new binding_t", __FUNCTION__);
     }
 
-    snprintf(new_binding->data.structure_type.struct_type, MAX_LITERAL, ast->data.struct_decl.name);
-    snprintf(new_binding->name, MAX_LITERAL, ast->data.struct_decl.name);
+    new_binding->data.structure_type.struct_type = ast->data.struct_decl.name;
+    new_binding->name                            = ast->data.struct_decl.name;
     new_binding->data.structure_type.num_members = vector_length(ast->data.struct_decl.members);
     new_binding->data.structure_type.members     = ast->data.struct_decl.members;
     new_binding->data.structure_type.type        = D_STRUCT;
 
-    symtab_insert(curr_scope, new_binding);
+    symtab_insert(tc->symbol_table, new_binding);
 
     // Now, create a new scope and enter the function body. The new scope is named after the struct
     // type so that we can make sure there aren't duplicate members within the declaration.
-    enter_new_scope(new_binding->data.structure_type.struct_type);
+    enter_new_scope(tc, new_binding->data.structure_type.struct_type);
 
     if (new_binding->data.structure_type.num_members > 0) {
         // Add the formals to the new scope
-        vecnode *vn = ast->data.struct_decl.members->head;
-        while (NULL != vn) {
-            node *n = vn->data;
-
-            do_typecheck(n);
-
-            vn = vn->next;
+        vector *members = ast->data.struct_decl.members;
+        for (int idx = 0; idx < vector_length(members); idx++) {
+            do_typecheck(tc, vector_get(members, idx));
         }
     }
 
-    leave_curr_scope();
+    leave_curr_scope(tc);
 }
 
-static void typecheck_member_decl(node *ast) {
+static void typecheck_member_decl(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Check if we've already seen this formal within the current scope
-    binding_t *member_binding = symtab_lookup(curr_scope, ast->data.member_decl.name, true);
+    binding_t *member_binding = symtab_lookup(tc->symbol_table, ast->data.member_decl.name, true);
     if (NULL != member_binding) {
         // Is the existing binding a member?
         if (member_binding->symbol_type == SYMBOL_TYPE_MEMBER) {
@@ -981,7 +961,7 @@ static void typecheck_member_decl(node *ast) {
             snprintf(err_msg, MAX_ERROR_LEN,
                      "Redefinition of '%s'. Structure member is previously declared",
                      ast->data.member_decl.name);
-            type_error(err_msg, ast);
+            type_error(tc, err_msg, ast);
         } else {
             print_binding(member_binding);
         }
@@ -994,17 +974,17 @@ static void typecheck_member_decl(node *ast) {
 
         // Get the structure binding using the scope name (which should be the name of the structure
         // decl)
-        binding_t *struct_binding = symtab_lookup(curr_scope, curr_scope->name, false);
+        const char *struct_name   = symtab_scope(tc->symbol_table)->name;
+        binding_t *struct_binding = symtab_lookup(tc->symbol_table, struct_name, false);
         if (NULL != struct_binding) {
             // Populate binding data
-            snprintf(new_binding->name, MAX_LITERAL, ast->data.member_decl.name);
-            snprintf(new_binding->data.member_type.parent_struct, MAX_LITERAL,
-                     struct_binding->name);
-            new_binding->data.member_type.type = ast->data.member_decl.type;
+            new_binding->name                           = ast->data.member_decl.name;
+            new_binding->data.member_type.parent_struct = struct_binding->name;
+            new_binding->data.member_type.type          = ast->data.member_decl.type;
 
             // Insert binding into symbol table
-            symtab_insert(curr_scope, new_binding);
-            print_symbol_table(symbol_table);
+            symtab_insert(tc->symbol_table, new_binding);
+            trace_symbol_table(tc);
         } else {
             log_error("%s(): Cannot access parent structure binding for member '%s'. This means a "
                       "structure member has been declared outside of a structure.",
@@ -1013,33 +993,31 @@ static void typecheck_member_decl(node *ast) {
     }
 }
 
-static void typecheck_struct_access(node *ast) {
+static void typecheck_struct_access(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Does the variable exist
-    binding_t *variable_binding = symtab_lookup(curr_scope, ast->data.struct_access.name, false);
+    binding_t *variable_binding =
+        symtab_lookup(tc->symbol_table, ast->data.struct_access.name, false);
     if (NULL != variable_binding) {
         // Now, find the structure declaration
-        binding_t *struct_binding =
-            symtab_lookup(curr_scope, variable_binding->data.variable_type.struct_type, false);
+        binding_t *struct_binding = symtab_lookup(
+            tc->symbol_table, variable_binding->data.variable_type.struct_type, false);
         if (NULL != struct_binding) {
             // Does the member exit for this structure
             bool found_member = false;
-            vecnode *vn       = struct_binding->data.structure_type.members->head;
-
-            while (NULL != vn) {
-                node *mn = (node *)vn->data;
-                if (NULL != mn) {
-                    if (0 ==
-                        strcmp(ast->data.struct_access.member_name, mn->data.member_decl.name)) {
-                        // We found a member with that name
-                        found_member = true;
-                        break;
-                    }
+            vector *members   = struct_binding->data.structure_type.members;
 
-                    vn = vn->next;
+            for (int idx = 0; idx < vector_length(members); idx++) {
+                node *mn = (node *)vector_get(members, idx);
+
+                // Both names are interned
+                if (ast->data.struct_access.member_name == mn->data.member_decl.name) {
+                    // We found a member with that name
+                    found_member = true;
+                    break;
                 }
             }
 
@@ -1050,41 +1028,60 @@ static void typecheck_struct_access(node *ast) {
                          "structure '%s'",
                          ast->data.struct_access.member_name, ast->data.struct_access.name,
                          struct_binding->data.structure_type.struct_type);
-                type_error(err_msg, ast);
+                type_error(tc, err_msg, ast);
             }
+        } else {
+            char err_msg[MAX_ERROR_LEN] = {0};
+            snprintf(err_msg, MAX_ERROR_LEN, "Access error. '%s' is not a structure",
+                     ast->data.struct_access.name);
+            type_error(tc, err_msg, ast);
         }
+    } else {
+        char err_msg[MAX_ERROR_LEN] = {0};
+        snprintf(err_msg, MAX_ERROR_LEN, "Undeclared identifier '%s'",
+                 ast->data.struct_access.name);
+        type_error(tc, err_msg, ast);
     }
 }
 
-static void typecheck_label_decl(node *ast) { assert(false && "Not yet implemented"); }
+static void typecheck_label_decl(typechecker_t *tc, node *ast) {
+    log_error("%s(): Not yet implemented", __FUNCTION__);
+}
 
-static void typecheck_goto_stmt(node *ast) { assert(false && "Not yet implemented"); }
+static void typecheck_goto_stmt(typechecker_t *tc, node *ast) {
+    log_error("%s(): Not yet implemented", __FUNCTION__);
+}
 
-static void typecheck_array_init_expr(node *ast) { assert(false && "Not yet implemented"); }
+static void typecheck_array_init_expr(typechecker_t *tc, node *ast) {
+    log_error("%s(): Not yet implemented", __FUNCTION__);
+}
 
-static void typecheck_array_access_expr(node *ast) { assert(false && "Not yet implemented"); }
+static void typecheck_array_access_expr(typechecker_t *tc, node *ast) {
+    log_error("%s(): Not yet implemented", __FUNCTION__);
+}
 
-static void typecheck_while_stmt(node *ast) {
+static void typecheck_while_stmt(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
     // Visit test
-    do_typecheck(ast->data.while_stmt.test);
+    do_typecheck(tc, ast->data.while_stmt.test);
 
     // Pass down the scope name, if it exists. If it does exist, we are within a function.
     // Otherwise, we are within the global scope.
-    char *scope_name = (strlen(curr_scope->name) > 0) ? curr_scope->name : NULL;
+    const scope_t *scope   = symtab_scope(tc->symbol_table);
+    const char *scope_name = (scope->name != strtab_empty) ? scope->name : NULL;
 
-    enter_new_scope(scope_name);
+    enter_new_scope(tc, scope_name);
 
     // Visit body
-    do_typecheck(ast->data.while_stmt.body);
+    do_typecheck(tc, ast->data.while_stmt.body);
 
-    leave_curr_scope();
+    leave_curr_scope(tc);
 }
 
-static void typecheck_empty_expr(node *ast) {
+static void typecheck_empty_expr(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
@@ -1092,18 +1089,22 @@ static void typecheck_empty_expr(node *ast) {
     // Nothing to check
 }
 
-static void typecheck_neg_expr(node *ast) {
+static void typecheck_neg_expr(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
-    do_typecheck(ast->data.neg_expr.expr);
+    do_typecheck(tc, ast->data.neg_expr.expr);
+
+    ast->type_id = get_type(tc, ast->data.neg_expr.expr);
 }
 
-static void typecheck_not_expr(node *ast) {
+static void typecheck_not_expr(typechecker_t *tc, node *ast) {
     if (NULL == ast) {
         log_error("%s(): Unable to access node for typechecking", __FUNCTION__);
     }
 
-    do_typecheck(ast->data.not_expr.expr);
+    do_typecheck(tc, ast->data.not_expr.expr);
+
+    ast->type_id = get_type(tc, ast->data.not_expr.expr);
 }
@@ -8,9 +8,33 @@
 #define TYPECHECKER_H
 
 #include "ast.h"
+#include "symtab.h"
 #include "token.h"
+#include "typetab.h"
+
+/* Typechecker Context
+ *
+ *  The scopes of the program being checked. Each typechecker_t is independent of any other, so
+ *  several programs may be checked at once on different threads.
+ *
+ *  Every expression is annotated with the id of its type the first time that type is resolved, so
+ *  asking again is a read of the node rather than another walk of the subtree and lookup of its
+ *  names. Variables and functions are bound to the ids of their types too, and since types are
+ *  interned, two types match exactly when their ids do.
+ *
+ *  A type error is reported and the check goes on. An expression whose type could not be resolved
+ *  is of type UNKNOWN, which raises no further errors, so each mistake is reported once. */
+typedef struct typechecker_s {
+    symtab_t *symbol_table;  // Every open scope, from the global one in
+    strtab_t *names;         // The program's string table, which names in the scopes come from
+    typetab_t *types;        // The program's type table, in the same arena as its names
+    unsigned int num_errors; // Type errors reported so far
+} typechecker_t;
 
 // Prototypes
-void typecheck(node *ast);
+
+// Checks the program ast using tc, which is reset first. If the program has any type errors, they
+// are all reported and the compile ends with TYPE_ERROR.
+void typecheck(typechecker_t *tc, node *ast);
 
 #endif // TYPECHECKER_H
@@ -0,0 +1,236 @@
+/**
+ * Type Table Module
+ * File: typetab.c
+ * Author: Liam M. Murphy
+ */
+
+#include "typetab.h"
+
+#include "strtab.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TYPETAB_INITIAL_CAPACITY 64
+
+// FNV-1a, as used by the string table
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+
+static type_t none_type = {.kind = TYPE_KIND_PRIMITIVE, .id = TYPE_NONE, .datatype = D_UNKNOWN};
+
+// Mixes the four bytes of word into hash
+static uint32_t hash_word(uint32_t hash, uint32_t word) {
+    for (int i = 0; i < 4; i++) {
+        hash ^= (word >> (i * 8)) & 0xff;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+// Hashes everything that tells key and its params apart from other types
+static uint32_t type_hash(const type_t *key, const type_id_t *params) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    hash = hash_word(hash, key->kind);
+    hash = hash_word(hash, key->datatype);
+    hash = hash_word(hash, strtab_id(key->struct_type));
+    hash = hash_word(hash, key->base);
+    hash = hash_word(hash, key->num_dimensions);
+    hash = hash_word(hash, key->num_params);
+    for (unsigned int idx = 0; idx < key->num_params; idx++) {
+        hash = hash_word(hash, params[idx]);
+    }
+
+    return hash;
+}
+
+static bool type_equal(const type_t *type, const type_t *key, const type_id_t *params) {
+    // Struct names are interned, so they are compared by pointer
+    return (type->kind == key->kind) && (type->datatype == key->datatype) &&
+           (type->struct_type == key->struct_type) && (type->base == key->base) &&
+           (type->num_dimensions == key->num_dimensions) && (type->num_params == key->num_params) &&
+           ((key->num_params == 0) ||
+            (memcmp(type->params, params, key->num_params * sizeof(type_id_t)) == 0));
+}
+
+// Doubles the number of slots, and the room for types with them. The old arrays stay in the arena
+// until it is freed; they add up to less than the new ones.
+static void typetab_grow(typetab_t *tab) {
+    const unsigned int new_capacity = tab->capacity * 2;
+    type_id_t *new_slots = (type_id_t *)arena_alloc(tab->arena, new_capacity * sizeof(type_id_t));
+    type_t **new_types =
+        (type_t **)arena_alloc(tab->arena, (new_capacity / 2 + 1) * sizeof(type_t *));
+
+    memcpy(new_types, tab->types, tab->count * sizeof(type_t *));
+
+    for (unsigned int idx = 0; idx < tab->capacity; idx++) {
+        const type_id_t id = tab->slots[idx];
+
+        if (id != TYPE_NONE) {
+            unsigned int slot = tab->types[id]->hash & (new_capacity - 1);
+            while (new_slots[slot] != TYPE_NONE) {
+                slot = (slot + 1) & (new_capacity - 1);
+            }
+
+            new_slots[slot] = id;
+        }
+    }
+
+    tab->slots    = new_slots;
+    tab->types    = new_types;
+    tab->capacity = new_capacity;
+}
+
+// Returns the id of the type described by key and params, adding it if there is none yet
+static type_id_t typetab_intern(typetab_t *tab, const type_t *key, const type_id_t *params) {
+    const uint32_t hash = type_hash(key, params);
+    unsigned int slot   = hash & (tab->capacity - 1);
+
+    // Linear probing
+    while (tab->slots[slot] != TYPE_NONE) {
+        const type_t *type = tab->types[tab->slots[slot]];
+
+        if (type->hash == hash && type_equal(type, key, params)) {
+            return type->id;
+        }
+
+        slot = (slot + 1) & (tab->capacity - 1);
+    }
+
+    const size_t params_size = key->num_params * sizeof(type_id_t);
+    type_t *type             = (type_t *)arena_alloc(tab->arena, sizeof(*type) + params_size);
+
+    *type      = *key;
+    type->id   = tab->count;
+    type->hash = hash;
+    if (params_size > 0) {
+        memcpy(type->params, params, params_size);
+    }
+
+    tab->slots[slot]         = type->id;
+    tab->types[tab->count++] = type;
+
+    // Keep at least half of the slots empty, so probe sequences stay short
+    if (tab->count * 2 > tab->capacity) {
+        typetab_grow(tab);
+    }
+
+    return type->id;
+}
+
+typetab_t *typetab_new(arena_t *arena) {
+    typetab_t *retval = (typetab_t *)arena_alloc(arena, sizeof(typetab_t));
+
+    retval->arena    = arena;
+    retval->capacity = TYPETAB_INITIAL_CAPACITY;
+    retval->count    = 1;
+
+    retval->slots = (type_id_t *)arena_alloc(arena, TYPETAB_INITIAL_CAPACITY * sizeof(type_id_t));
+
+    // At most half of the slots are ever used, so types is grown along with them
+    retval->types =
+        (type_t **)arena_alloc(arena, (TYPETAB_INITIAL_CAPACITY / 2 + 1) * sizeof(type_t *));
+    retval->types[TYPE_NONE] = &none_type;
+
+    // Each data_type goes in first, in order, so that its id is 1 + d
+    for (data_type d = D_INTEGER; d <= D_UNKNOWN; d++) {
+        const type_t key = {
+            .kind = TYPE_KIND_PRIMITIVE, .datatype = d, .struct_type = strtab_empty};
+        typetab_intern(retval, &key, NULL);
+    }
+
+    return retval;
+}
+
+type_id_t typetab_struct(typetab_t *tab, const char *name) {
+    const type_t key = {.kind = TYPE_KIND_STRUCT, .datatype = D_STRUCT, .struct_type = name};
+
+    return typetab_intern(tab, &key, NULL);
+}
+
+type_id_t typetab_array(typetab_t *tab, type_id_t element, unsigned int num_dimensions) {
+    const type_t *element_type = typetab_get(tab, element);
+
+    if (num_dimensions == 0) {
+        return element;
+    }
+
+    // An array of arrays is an array of their elements, with the dimensions of both
+    if (element_type->kind == TYPE_KIND_ARRAY) {
+        num_dimensions += element_type->num_dimensions;
+        element_type = typetab_get(tab, element_type->base);
+    }
+
+    const type_t key = {.kind           = TYPE_KIND_ARRAY,
+                        .datatype       = element_type->datatype,
+                        .struct_type    = strtab_empty,
+                        .base           = element_type->id,
+                        .num_dimensions = num_dimensions};
+
+    return typetab_intern(tab, &key, NULL);
+}
+
+type_id_t typetab_function(typetab_t *tab, type_id_t result, const type_id_t *params,
+                           unsigned int num_params) {
+    const type_t key = {.kind        = TYPE_KIND_FUNCTION,
+                        .datatype    = typetab_get(tab, result)->datatype,
+                        .struct_type = strtab_empty,
+                        .base        = result,
+                        .num_params  = num_params};
+
+    return typetab_intern(tab, &key, params);
+}
+
+// Appends str to the len bytes at buf, of which used are taken, and returns how many are taken
+// after it. What does not fit is cut off.
+static size_t append_str(char *buf, size_t len, size_t used, const char *str) {
+    const size_t n = (size_t)snprintf(buf + used, len - used, "%s", str);
+
+    return (used + n < len) ? used + n : len - 1;
+}
+
+// Appends the name of the type with the given id, as append_str() does
+static size_t append_name(const typetab_t *tab, type_id_t id, char *buf, size_t len, size_t used) {
+    const type_t *type = typetab_get(tab, id);
+
+    switch (type->kind) {
+        case TYPE_KIND_STRUCT:
+            used = append_str(buf, len, used, "STRUCT ");
+            used = append_str(buf, len, used, type->struct_type);
+            break;
+        case TYPE_KIND_ARRAY:
+            used = append_name(tab, type->base, buf, len, used);
+            for (unsigned int dim = 0; dim < type->num_dimensions; dim++) {
+                used = append_str(buf, len, used, "[]");
+            }
+            break;
+        case TYPE_KIND_FUNCTION:
+            used = append_str(buf, len, used, "FUNCTION(");
+            for (unsigned int idx = 0; idx < type->num_params; idx++) {
+                if (idx > 0) {
+                    used = append_str(buf, len, used, ", ");
+                }
+                used = append_name(tab, type->params[idx], buf, len, used);
+            }
+            used = append_str(buf, len, used, ") -> ");
+            used = append_name(tab, type->base, buf, len, used);
+            break;
+        case TYPE_KIND_PRIMITIVE:
+        default:
+            used = append_str(buf, len, used, type_to_str(type->datatype));
+            break;
+    }
+
+    return used;
+}
+
+const char *typetab_name(const typetab_t *tab, type_id_t id, char *buf, size_t len) {
+    if (len > 0) {
+        buf[0] = '\0';
+        append_name(tab, id, buf, len, 0);
+    }
+
+    return buf;
+}
@@ -0,0 +1,81 @@
+/**
+ * Type Table Public Definitions
+ * File: typetab.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef TYPETAB_H
+#define TYPETAB_H
+
+#include "arena.h"
+#include "ast.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Room for the name of any type that fits in an error message
+#define MAX_TYPE_NAME 256
+
+typedef enum type_kind_e {
+    TYPE_KIND_PRIMITIVE = 0,
+    TYPE_KIND_STRUCT    = 1,
+    TYPE_KIND_ARRAY     = 2,
+    TYPE_KIND_FUNCTION  = 3
+} type_kind_t;
+
+// A type, as it is interned. Types are never changed once they are in the table.
+typedef struct type_s {
+    type_kind_t kind;
+    type_id_t id;
+    uint32_t hash;
+    data_type datatype;          // Of the type's values: an array's elements, a function's result
+    const char *struct_type;     // Interned. The name of a struct type, otherwise strtab_empty.
+    type_id_t base;              // The element type of an array, or the result of a function
+    unsigned int num_dimensions; // Of an array
+    unsigned int num_params;     // Of a function
+    type_id_t params[];          // Of a function, in order
+} type_t;
+
+/* Type Table
+ *
+ *  Holds the types of one program. Each distinct type, whether a data_type, a struct, an array of
+ *  some number of dimensions or a function signature, is stored once, in the program's arena, and
+ *  has a small integer id. Interning it again returns the same id, so two types are equal exactly
+ *  when their ids are.
+ *
+ *  Arrays of arrays are folded into one array of the elements, so an int[][] is the same type
+ *  however it was built. Each data_type d is in the table from the start, with id 1 + d. */
+typedef struct typetab_s {
+    arena_t *arena;        // Where the types and the table itself live
+    type_id_t *slots;      // Open addressing, TYPE_NONE where empty
+    type_t **types;        // Indexed by id. Id 0 is TYPE_NONE.
+    unsigned int capacity; // Number of slots, always a power of two
+    unsigned int count;    // Number of types, TYPE_NONE included
+} typetab_t;
+
+// Allocate a new type table within arena
+typetab_t *typetab_new(arena_t *arena);
+
+// Id of the type of data_type d, which is always in the table
+static inline type_id_t typetab_primitive(data_type d) { return (type_id_t)(1 + d); }
+
+// Id of the struct type named name, which is interned
+type_id_t typetab_struct(typetab_t *tab, const char *name);
+
+// Id of the array of num_dimensions dimensions of element. An array of no dimensions is element.
+type_id_t typetab_array(typetab_t *tab, type_id_t element, unsigned int num_dimensions);
+
+// Id of the function taking num_params arguments of the types in params and returning result
+type_id_t typetab_function(typetab_t *tab, type_id_t result, const type_id_t *params,
+                           unsigned int num_params);
+
+// Returns the type with the given id, which must have come from tab
+static inline const type_t *typetab_get(const typetab_t *tab, type_id_t id) {
+    return tab->types[id];
+}
+
+// Writes the name of the type with the given id into the len bytes at buf, such as INTEGER,
+// STRUCT person, FLOAT[][] or FUNCTION(STRING) -> VOID. Returns buf.
+const char *typetab_name(const typetab_t *tab, type_id_t id, char *buf, size_t len);
+
+#endif // TYPETAB_H
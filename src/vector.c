@@ -13,40 +13,62 @@
 #include <stdlib.h>
 #include <string.h>
 
-vector *mk_vector() {
+#define VECTOR_INITIAL_CAPACITY 4
+
+vector *mk_vector(arena_t *arena) {
     vector *retval = NULL;
 
-    retval = (vector *)calloc(1, sizeof(vector));
+    if (arena != NULL) {
+        retval = (vector *)arena_alloc(arena, sizeof(vector));
+    } else {
+        retval = (vector *)calloc(1, sizeof(vector));
+    }
 
     if (retval == NULL) {
         log_error("Unable to allocate new vector");
         return retval;
     }
 
-    retval->head  = NULL;
-    retval->tail  = NULL;
-    retval->count = 0;
+    retval->items    = NULL;
+    retval->count    = 0;
+    retval->capacity = 0;
+    retval->arena    = arena;
 
     return retval;
 }
 
-void vector_free(vector **vec) {
-    if (vec != NULL) {
-        if (vector_length(*vec) > 0) {
-            vecnode *curr = (*vec)->head;
+// Doubles the capacity of vec, or gives it its first items
+static void vector_grow(vector *vec) {
+    const int new_capacity = (vec->capacity > 0) ? vec->capacity * 2 : VECTOR_INITIAL_CAPACITY;
+    void **new_items       = NULL;
+
+    if (vec->arena != NULL) {
+        new_items = (void **)arena_alloc(vec->arena, new_capacity * sizeof(void *));
+        if (vec->count > 0) {
+            memcpy(new_items, vec->items, vec->count * sizeof(void *));
+        }
+    } else {
+        new_items = (void **)realloc(vec->items, new_capacity * sizeof(void *));
+    }
 
-            while (curr != NULL) {
-                vecnode *next = curr->next;
+    if (new_items == NULL) {
+        log_error("Unable to grow vector to %d elements", new_capacity);
+    }
 
-                if (curr->data != NULL) {
-                    free(curr->data);
-                }
+    vec->items    = new_items;
+    vec->capacity = new_capacity;
+}
 
-                free(curr);
-                curr = next;
-            }
+void vector_free(vector **vec) {
+    if (vec != NULL && *vec != NULL && (*vec)->arena != NULL) {
+        (*vec)->count = 0;
+        *vec          = NULL;
+    } else if (vec != NULL && *vec != NULL) {
+        for (int idx = 0; idx < (*vec)->count; idx++) {
+            free((*vec)->items[idx]);
         }
 
+        free((*vec)->items);
         free(*vec);
         *vec = NULL;
     }
@@ -55,23 +77,11 @@ void vector_free(vector **vec) {
 void vector_add(vector *vec, void *data) {
     if (vec != NULL) {
         if (data != NULL) {
-            vecnode *node = calloc(1, sizeof(vecnode));
-
-            node->data = data;
-            node->next = NULL;
-
-            if (vec->head == NULL) {
-                vec->head = node;
-                vec->tail = node;
-            } else {
-                vec->tail->next = node;
-                vec->tail       = node;
+            if (vec->count == vec->capacity) {
+                vector_grow(vec);
             }
 
-            vec->count++;
-
-            // debug("added new vector element");
-
+            vec->items[vec->count++] = data;
         } else {
             log_error("Cannot add NULL data to vector");
         }
@@ -83,19 +93,12 @@ void vector_add(vector *vec, void *data) {
 void vector_prepend(vector *vec, void *data) {
     if (vec != NULL) {
         if (data != NULL) {
-            vecnode *node = calloc(1, sizeof(vecnode));
-            node->data    = data;
-
-            if (vec->head == NULL) {
-                vec->head = node;
-                vec->tail = node;
-            } else {
-                vecnode *old_head = vec->head;
-
-                node->next = old_head;
-                vec->head  = node;
+            if (vec->count == vec->capacity) {
+                vector_grow(vec);
             }
 
+            memmove(&vec->items[1], &vec->items[0], vec->count * sizeof(void *));
+            vec->items[0] = data;
             vec->count++;
         } else {
             log_error("Cannot add NULL data to vector");
@@ -105,91 +108,45 @@ void vector_prepend(vector *vec, void *data) {
     }
 }
 
-/*
- * Removes the tail of the vector. Data pointed to within the node must be freed
- * from within the caller.
- */
 void vector_pop(vector *vec) {
     if (vec != NULL) {
-        if (vector_length(vec) == 0) {
+        if (vec->count == 0) {
             log_error("Cannot pop from empty vector");
-        } else if (vector_length(vec) == 1) {
-            if (vec->head != NULL) {
-                free(vec->head);
-                vec->head = NULL;
-                vec->count--;
-            }
-        } else if (vector_length(vec) > 1) {
-            vecnode *curr = vec->head;
-
-            // Find the element before the tail
-            while (curr != NULL) {
-                if (curr->next->next == NULL) {
-                    break;
-                }
-
-                curr = curr->next;
-            }
-
-            // Sanity check that we are the penultimate node
-            if (curr != NULL && curr->next != NULL && curr->next->next == NULL) {
-                free(curr->next->next);
-
-                curr->next = NULL;
-                vec->tail  = curr;
-                vec->count--;
-            } else {
-                log_error("Cannot free a NULL vector tail");
-            }
         }
+
+        vec->count--;
     }
 }
 
-/* Pop the head from a vector and return a pointer to it */
-vecnode *vector_pop_head(vector *vec) {
-    vecnode *retval = NULL;
+void *vector_pop_head(vector *vec) {
+    void *retval = NULL;
 
     if (vec != NULL) {
-        if (vector_length(vec) == 0) {
+        if (vec->count == 0) {
             // log_error("Cannot pop from empty vector");
-            printf("Cannot pop from empty stack\n");
-        } else if (vector_length(vec) == 1) {
-            if (vec->head != NULL) {
-                retval    = vec->head;
-                vec->head = NULL;
-                vec->count--;
-            }
-        } else if (vector_length(vec) > 1) {
-            // Save a pointer to the current head
-            vecnode *curr_head = vec->head;
-            retval             = vec->head;
-
-            // Reassign the head pointer to the next node
-            if (curr_head->next != NULL) {
-                vec->head = curr_head->next;
-                vec->count--;
-            } else {
-                log_error("Cannot assign new head node to a NULL element");
-            }
+            diag_printf("Cannot pop from empty stack\n");
+        } else {
+            retval = vec->items[0];
+
+            vec->count--;
+            memmove(&vec->items[0], &vec->items[1], vec->count * sizeof(void *));
         }
     }
 
     return retval;
 }
 
-vecnode *vector_top(vector *vec) {
-    vecnode *retval = NULL;
+void *vector_top(vector *vec) {
+    void *retval = NULL;
 
-    if (vec != NULL) {
-        if (vec->head != NULL) {
-            retval = vec->head;
-        }
+    if (vec != NULL && vec->count > 0) {
+        retval = vec->items[0];
     }
 
     return retval;
 }
 
-int vector_length(vector *vec) {
+int vector_length(const vector *vec) {
     int retval = 0;
 
     if (vec != NULL) {
@@ -198,32 +155,3 @@ int vector_length(vector *vec) {
 
     return retval;
 }
-
-vecnode *get_nth_node(vector *vec, const int n) {
-    vecnode *retval = NULL;
-
-    if (vec != NULL) {
-        const int length = vector_length(vec);
-        if (n > length) {
-            log_error("Cannot get node %d from a vector with length %d", n, length);
-        } else {
-            vecnode *vn = vec->head;
-            int index   = 1;
-            while (index < n) {
-                if (vn != NULL) {
-                    if (n == 1) {
-                        retval = vec->head;
-                        break;
-                    }
-
-                    vn = vn->next;
-                    index++;
-                }
-            }
-
-            retval = vn;
-        }
-    }
-
-    return retval;
-}
\ No newline at end of file
@@ -7,53 +7,46 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
-#define MAX_LINE 4096
-
-typedef struct vecnode {
-    void *data;
-    struct vecnode *next;
-} vecnode;
+#include "arena.h"
 
+/* Vector
+ *
+ *  Growable, contiguous array of pointers. Adding to the end is amortized O(1), and elements are
+ *  indexed directly, in the order they were added. The array doubles when it is full; in an arena
+ *  the old array stays behind until the arena is freed, which at most doubles what it uses. */
 typedef struct vector {
-    vecnode *head;
-    vecnode *tail;
+    void **items;
     int count;
+    int capacity;
+    arena_t *arena; // Where the vector and its items live, or NULL for the heap
 } vector;
 
-// Allocate a new vector
-vector *mk_vector(void);
+// Allocate a new vector from arena, or from the heap if arena is NULL
+vector *mk_vector(arena_t *arena);
 
-// Free a vector
+// Free a vector. The data of a heap vector's elements is freed along with it. An arena vector is
+// only emptied, since its memory goes back when the arena is freed.
 void vector_free(vector **vec);
 
 // Add an element to the end of a vector
 void vector_add(vector *vec, void *data);
 
-// Add an element to the head of a vector
+// Add an element to the head of a vector. O(n), since every element moves up one.
 void vector_prepend(vector *vec, void *data);
 
-// Remove the tail element from a vector
+// Remove the tail element from a vector. Its data is freed by the caller.
 void vector_pop(vector *vec);
 
-// Remove the head element from a vector and return it
-vecnode *vector_pop_head(vector *vec);
+// Remove the head element from a vector and return it, or NULL if the vector is empty. O(n).
+void *vector_pop_head(vector *vec);
 
-// Return a pointer to the vecnode at vec->head
-vecnode *vector_top(vector *vec);
+// Return the head element of a vector, or NULL if it is empty
+void *vector_top(vector *vec);
 
 // Get length of vector
-int vector_length(vector *vec);
+int vector_length(const vector *vec);
 
-// Get the nth node from a vector
-vecnode *get_nth_node(vector *vec, const int n);
+// Get the element at index idx, counting from 0, which must be less than the vector's length
+static inline void *vector_get(const vector *vec, int idx) { return vec->items[idx]; }
 
-/* Line Map (vector)
- *
- *  The idea here is to maintain a list of strings for each line in the
- *  input program. This will be used to display more effective error
- *  messages in the front-half of the compiler. */
-typedef struct line_s {
-    char text[MAX_LINE];
-} line_t;
-
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,14 @@
+/**
+ * LBASIC Version
+ * File: version.h
+ * Author: Liam M. Murphy
+ */
+
+#ifndef VERSION_H
+#define VERSION_H
+
+// Anything cached by one version of the compiler is ignored by every other
+#define LBASIC_VERSION "0.2"
+#define LBASIC_RELEASE_DATE "September 2023"
+
+#endif // VERSION_H
@@ -0,0 +1,88 @@
+# Writes a corpus of large, well-typed LBASIC programs for benchmarking and profile-guided builds
+# Usage: python3 test/gencorpus.py <directory> [programs] [functions per program]
+import os
+import random
+import sys
+
+
+def function(out, rng, idx):
+    out.append(f"func compute_{idx}(int n, float scale, string label) -> int")
+    out.append("then")
+    out.append("    struct point then")
+    out.append("        int x;")
+    out.append("        int y;")
+    out.append("    end")
+    out.append("")
+    out.append("    struct point p;")
+    out.append("    int total := 0;")
+    out.append("    float acc := 0.5;")
+    out.append("    bool done := false;")
+    out.append("")
+    out.append("    p.x := n * 2;")
+    out.append("    p.y := p.x - 1;")
+    out.append("")
+    out.append("    while (n > 0 and done == false) then")
+    out.append(f"        int step := ((n * {rng.randint(2, 9)}) + (total * 3)) - {rng.randint(1, 99)};")
+    out.append("        acc := acc * scale + 1.25;")
+    out.append("")
+    out.append(f"        if ((step < {rng.randint(10, 500)}) or (step >= p.x)) then")
+    out.append("            total := total + step;")
+    out.append("        else then")
+    out.append("            if (total != step) then")
+    out.append("                string msg := \"branch\";")
+    out.append("                total := total - 1;")
+    out.append("            end")
+    out.append("        end")
+    out.append("")
+    out.append("        n := n - 1;")
+    out.append(f"        done := (total > {rng.randint(1000, 100000)});")
+    out.append("    end")
+    out.append("")
+    if idx > 0:
+        callee = rng.randrange(idx)
+        out.append("    if (total < 0) then")
+        out.append(f"        total := compute_{callee}(total + n, scale, label);")
+        out.append("    end")
+        out.append("")
+    out.append("    return total + p.y;")
+    out.append("end")
+    out.append("")
+
+
+def program(rng, functions):
+    out = ["' Generated by test/gencorpus.py", ""]
+    out.append("int calls := 0;")
+    out.append("string name := \"corpus\";")
+    out.append("")
+
+    for idx in range(functions):
+        function(out, rng, idx)
+
+    for idx in range(functions):
+        out.append(f"calls := calls + compute_{idx}({rng.randint(1, 50)}, 1.5, name);")
+    out.append("printint(calls);")
+    out.append("")
+
+    return "\n".join(out)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(f"Usage: {sys.argv[0]} <directory> [programs] [functions per program]")
+        sys.exit(1)
+
+    directory = sys.argv[1]
+    programs = int(sys.argv[2]) if len(sys.argv) > 2 else 64
+    functions = int(sys.argv[3]) if len(sys.argv) > 3 else 200
+
+    # A fixed seed keeps the corpus, and so the profiles and timings, the same from run to run
+    rng = random.Random(1)
+    os.makedirs(directory, exist_ok=True)
+
+    for idx in range(programs):
+        with open(os.path.join(directory, f"corpus_{idx:03}.lb"), "w") as f:
+            f.write(program(rng, functions))
+
+
+if __name__ == "__main__":
+    main()